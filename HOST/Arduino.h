@@ -0,0 +1,156 @@
+/*  Arduino stand-in for Linux host build
+ *
+ *  Only what the sketch headers use: types, bit macros, time, String and Serial.
+ *  String allocates like the Arduino one (malloc/realloc), so allocations and heap high-water mark can be counted.
+*/
+
+#ifndef HOST_ARDUINO_H
+#define HOST_ARDUINO_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <ctype.h>
+
+typedef uint8_t byte;
+typedef bool boolean;
+
+#define HIGH 1
+#define LOW 0
+#define INPUT 0
+#define OUTPUT 1
+#define INPUT_PULLUP 2
+#define DEC 10
+#define HEX 16
+
+#define bit(b) (1UL << (b))
+#define bitRead(value, bit) (((value) >> (bit)) & 0x01)
+#define bitSet(value, bit) ((value) |= (1UL << (bit)))
+#define bitClear(value, bit) ((value) &= ~(1UL << (bit)))
+#define bitWrite(value, bit, bitvalue) ((bitvalue) ? bitSet(value, bit) : bitClear(value, bit))
+inline uint16_t word(uint8_t h, uint8_t l) {return ((uint16_t)h << 8) | l;}
+#define lowByte(w) ((uint8_t) ((w) & 0xff))
+#define highByte(w) ((uint8_t) ((w) >> 8))
+
+#define PROGMEM
+#define F(x) (x)
+typedef char __FlashStringHelper; // F() strings are plain strings here
+#define pgm_read_byte(p) (*(const uint8_t *)(p))
+#define pgm_read_word(p) (*(const uint16_t *)(p))
+
+// -------------------------------------------------------- Time and pins
+unsigned long millis();
+unsigned long micros();
+void delay(unsigned long ms);
+void delayMicroseconds(unsigned int us);
+
+// Virtual time (chipsim): millis()/micros() run from Host_Time_us instead of the host clock,
+// each reading of the time costs Host_Read_us, delay() and I2C transfers (Wire.h) move time on
+extern bool Host_Virtual;
+extern unsigned long long Host_Time_us;
+extern unsigned int Host_Read_us;
+inline void Host_Advance(unsigned long us) {Host_Time_us += us;}
+
+inline void pinMode(uint8_t, uint8_t) {}
+inline void digitalWrite(uint8_t, uint8_t) {}
+inline int digitalRead(uint8_t) {return HIGH;}
+
+// -------------------------------------------------------- Heap counters
+extern unsigned long Host_Allocs;    // malloc/realloc/new calls
+extern unsigned long Host_Heap;      // bytes in use
+extern unsigned long Host_Heap_Peak; // high-water mark of Host_Heap
+void *Host_Realloc(void *Ptr, size_t Size);
+void Host_Free(void *Ptr);
+
+// -------------------------------------------------------- String
+class String
+{
+  public:
+    String(const char *Text = "") {Init(); Copy(Text, strlen(Text));}
+    String(const String &Other) {Init(); Copy(Other.Buf, Other.Len);}
+    explicit String(char Symbol) {Init(); Copy(&Symbol, 1);}
+    String(int Value, uint8_t Base = DEC) {Init(); Number(Value, Base);}
+    String(unsigned int Value, uint8_t Base = DEC) {Init(); Number(Value, Base);}
+    String(long Value, uint8_t Base = DEC) {Init(); Number(Value, Base);}
+    String(unsigned long Value, uint8_t Base = DEC) {Init(); Number(Value, Base);}
+    explicit String(uint8_t Value, uint8_t Base = DEC) {Init(); Number(Value, Base);}
+    ~String() {Host_Free(Buf);}
+
+    String &operator = (const String &Other) {if (this != &Other) {Copy(Other.Buf, Other.Len);} return *this;}
+    String &operator = (const char *Text) {Copy(Text, strlen(Text)); return *this;}
+    String &operator += (const String &Other) {Concat(Other.Buf, Other.Len); return *this;}
+    String &operator += (const char *Text) {Concat(Text, strlen(Text)); return *this;}
+    String &operator += (char Symbol) {Concat(&Symbol, 1); return *this;}
+    bool operator == (const String &Other) const {return Len == Other.Len && memcmp(Buf, Other.Buf, Len) == 0;}
+    bool operator == (const char *Text) const {return strcmp(c_str(), Text) == 0;}
+    bool operator != (const String &Other) const {return !(*this == Other);}
+    char operator [] (unsigned int Pos) const {return charAt(Pos);}
+
+    unsigned int length() const {return Len;}
+    const char *c_str() const {return Buf ? Buf : "";}
+    char charAt(unsigned int Pos) const {return Pos < Len ? Buf[Pos] : 0;}
+    long toInt() const {return atol(c_str());}
+    void toUpperCase() {for (unsigned int i = 0; i < Len; i++) {Buf[i] = toupper(Buf[i]);}}
+    void trim();
+    void toCharArray(char *Out, unsigned int Size) const;
+    String substring(unsigned int From) const {return substring(From, Len);}
+    String substring(unsigned int From, unsigned int To) const;
+
+  private:
+    char *Buf;
+    unsigned int Len;
+    unsigned int Cap;
+    void Init() {Buf = NULL; Len = 0; Cap = 0;}
+    void Reserve(unsigned int Size);
+    void Copy(const char *Text, unsigned int Size);
+    void Concat(const char *Text, unsigned int Size);
+    void Number(unsigned long Value, uint8_t Base);
+    void Number(long Value, uint8_t Base);
+    void Number(int Value, uint8_t Base) {Number((long)Value, Base);}
+    void Number(unsigned int Value, uint8_t Base) {Number((unsigned long)Value, Base);}
+    void Number(uint8_t Value, uint8_t Base) {Number((unsigned long)Value, Base);}
+};
+
+String operator + (const String &Left, const String &Right);
+String operator + (const String &Left, const char *Right);
+String operator + (const char *Left, const String &Right);
+String operator + (const String &Left, char Right);
+
+// -------------------------------------------------------- Serial (stdout, input from Feed)
+class HardwareSerial
+{
+  public:
+    void begin(unsigned long) {}
+    void setTimeout(unsigned long) {}
+    int available() {return In_Len - In_Pos;}
+    int read() {return In_Pos < In_Len ? In[In_Pos++] : -1;}
+    void Feed(const void *Data, size_t Size); // bytes for available()/read(), bytes over Rx_Size are lost
+    size_t Rx_Size = sizeof(In);  // receive buffer, 64 = AVR core
+    unsigned long Overruns = 0;   // bytes lost by full receive buffer
+    int availableForWrite() {return 64;}
+    bool Mute = false; // drop output (long runs with monitor ON)
+    size_t write(uint8_t Symbol) {return Mute || fputc(Symbol, stdout) != EOF ? 1 : 0;}
+    size_t write(const uint8_t *Data, size_t Size) {return Mute ? Size : fwrite(Data, 1, Size, stdout);}
+    void print(const String &Text) {print(Text.c_str());}
+    void print(const char *Text) {if (!Mute) {fputs(Text, stdout);}}
+    void print(char Symbol) {if (!Mute) {fputc(Symbol, stdout);}}
+    void print(long Value, int Base = DEC) {if (!Mute) {printf(Base == HEX ? "%lX" : "%ld", Value);}}
+    void print(unsigned long Value, int Base = DEC) {if (!Mute) {printf(Base == HEX ? "%lX" : "%lu", Value);}}
+    void print(int Value, int Base = DEC) {print((long)Value, Base);}
+    void print(unsigned int Value, int Base = DEC) {print((unsigned long)Value, Base);}
+    void print(uint8_t Value, int Base = DEC) {print((unsigned long)Value, Base);}
+    void println() {print('\n');}
+    template <class T> void println(const T &Value) {print(Value); println();}
+    template <class T> void println(const T &Value, int Base) {print(Value, Base); println();}
+
+  private:
+    uint8_t In[4096];
+    size_t In_Len = 0;
+    size_t In_Pos = 0;
+};
+
+extern HardwareSerial Serial;
+
+#endif
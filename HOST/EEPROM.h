@@ -0,0 +1,32 @@
+/*  EEPROM stand-in for Linux host build
+ *
+ *  RAM array erased to 0xFF like a new chip; counts cell writes to check wear of config saves.
+*/
+
+#ifndef HOST_EEPROM_H
+#define HOST_EEPROM_H
+
+#include "Arduino.h"
+
+#define HOST_EEPROM_SIZE 1024 // ATmega328P
+
+class EEPROMClass
+{
+  public:
+    uint32_t Writes;       // cell writes since start
+
+    EEPROMClass() {Writes = 0; memset(Cells, 0xFF, sizeof(Cells));}
+    uint8_t read(int Address) {return Cells[Address % HOST_EEPROM_SIZE];}
+    void write(int Address, uint8_t Value) {Cells[Address % HOST_EEPROM_SIZE] = Value; Writes++;}
+    void update(int Address, uint8_t Value) {if (read(Address) != Value) {write(Address, Value);}}
+    uint16_t length() {return HOST_EEPROM_SIZE;}
+    template <typename T> T &get(int Address, T &Value) {uint8_t *p = (uint8_t *)&Value; for (size_t i = 0; i < sizeof(T); i++) {p[i] = read(Address + i);} return Value;}
+    template <typename T> const T &put(int Address, const T &Value) {const uint8_t *p = (const uint8_t *)&Value; for (size_t i = 0; i < sizeof(T); i++) {update(Address + i, p[i]);} return Value;}
+
+  private:
+    uint8_t Cells[HOST_EEPROM_SIZE];
+};
+
+static EEPROMClass EEPROM;
+
+#endif
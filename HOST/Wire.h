@@ -0,0 +1,66 @@
+/*  Wire stand-in for Linux host build
+ *
+ *  Records every I2C write (byte count, FNV-1a hash and the last bytes) and answers
+ *  like an idle SI4713: CTS set, RDS FIFO empty.
+ *  With devices attached (Attach(), f.e. chip model of chipsim.h) transfers go to the device with
+ *  the same address, other addresses are NACKed; in virtual time each transfer takes its bus time.
+*/
+
+#ifndef HOST_WIRE_H
+#define HOST_WIRE_H
+
+#include "Arduino.h"
+
+#define HOST_WIRE_LOG 256 // last written bytes kept for inspection
+#define HOST_FIFO_SIZE 54 // FIFO size reported by TX_RDS_BUFF answer
+
+class HostDevice // I2C slave for TwoWire::Attach()
+{
+  public:
+    virtual uint8_t Write(const uint8_t *Data, uint8_t Len) = 0; // return endTransmission() code, 0 = ACK
+    virtual uint8_t Read(uint8_t *Data, uint8_t Len) = 0;        // return bytes
+    uint8_t Address = 0;
+    HostDevice *Next = NULL;
+};
+
+class TwoWire
+{
+  public:
+    uint32_t Written;      // bytes written since Reset()
+    uint32_t Transfers;    // write transactions since Reset()
+    uint32_t Hash;         // FNV-1a of all written bytes
+    uint8_t Log[HOST_WIRE_LOG]; // ring of last written bytes
+    FILE *Trace;           // if set, each transaction is printed as hex line
+
+    TwoWire() {Trace = NULL; Reset();}
+    void Reset() {Written = 0; Transfers = 0; Hash = 2166136261UL; Count = 0; RxLen = 0; RxPos = 0;}
+
+    void begin() {}
+    void setClock(uint32_t Hz) {Clock = Hz;}
+    void Attach(HostDevice &Device) {Device.Next = Devices; Devices = &Device;}
+    void beginTransmission(uint8_t Address) {Target = Address; Count = 0;}
+    size_t write(uint8_t Data);
+    size_t write(const uint8_t *Data, size_t Size) {for (size_t i = 0; i < Size; i++) {write(Data[i]);} return Size;}
+    uint8_t endTransmission(bool Stop = true);
+    uint8_t requestFrom(uint8_t Address, uint8_t Size);
+    uint8_t requestFrom(int Address, int Size) {return requestFrom((uint8_t)Address, (uint8_t)Size);}
+    int available() {return RxLen - RxPos;}
+    int read() {return RxPos < RxLen ? Rx[RxPos++] : -1;}
+
+  private:
+    HostDevice *Find(uint8_t Address);
+    void Transfer(uint8_t Bytes); // bus time in virtual time
+
+    HostDevice *Devices = NULL;
+    uint32_t Clock = 100000; // SCL, Hz
+    uint8_t Target = 0;
+    uint8_t Count;         // bytes in current transaction
+    uint8_t Tx[32];        // current transaction
+    uint8_t Rx[32];
+    uint8_t RxLen;
+    uint8_t RxPos;
+};
+
+extern TwoWire Wire;
+
+#endif
@@ -0,0 +1,265 @@
+/*  Encoder benchmark for Linux host build
+ *
+ *  Runs group encoders against recording Wire stand-in and prints for each message type:
+ *  ns per group, groups per second, heap allocations per message, I2C bytes per message
+ *  and hash of all written I2C bytes (same hash = same bytes on the bus).
+ *
+ *  Usage: ./bench [messages per type]   (default 20000)
+ *         ./bench -t                    print I2C transactions of one message of each type
+ *         ./bench -m [-e file]          monitor trace of test messages (tracedec makes input for rdsmod, loopback test),
+ *                                       -e: sent pages to file, line "address text" (rdsdec -c compares decoded pages),
+ *                                       exit code 1 when trace records were dropped
+ *         ./bench -s [pages]            paging soak through queue and sequencer with monitor ON (default 100000):
+ *                                       no heap allocation and flat heap high-water mark after warm-up, no dropped
+ *                                       trace records, else exit code 1
+*/
+
+#include <time.h>
+#include "Arduino.h"
+#include "Wire.h"
+#include "si4713.h"
+#include "paging.h"
+#include "sweep.h"
+#include "clock.h"
+#include "radiotext.h"
+#include "sequencer.h"
+
+SI4713 TX;
+
+#define BENCH_PI 0x6277
+#define BENCH_PTY 8
+#define BENCH_ADDRESS 100466UL
+
+static const char *Text_DIG10 = "0123456789";
+static const char *Text_DIG18 = "012345678901234567";
+static const char *Text_ALPHA = "PAGING LAB RDS ENCODER. ALPHA MESSAGE UP TO 80 SYMBOLS: 0123456789 ABCDEFGHIJKLMN";
+
+static unsigned long long Now_ns()
+{
+struct timespec Now;
+clock_gettime(CLOCK_MONOTONIC, &Now);
+return (unsigned long long)Now.tv_sec * 1000000000ULL + Now.tv_nsec;
+}
+
+// -------------------------------------------------------- Message types
+// Each runner sends message number i and returns groups sent
+typedef uint8_t (*type_Runner)(uint32_t i);
+
+static uint8_t Run_1A(uint32_t i)
+{
+TX.RDS_1A_PIN(BENCH_PI, 0, 0, BENCH_PTY, 6, 0xE4, (uint16_t)i, 0);
+return 1;
+}
+
+static uint8_t Run_4A(uint32_t i)
+{
+TX.RDS_4A_TIME(BENCH_PI, 0, 0, BENCH_PTY, 2024, 11, 16, (i / 60) % 24, i % 60, 0, 2, 0, 0);
+return 1;
+}
+
+static uint8_t Run_2A(uint32_t i)
+{
+TX.RDS_2A_RT(BENCH_PI, 0, 0, BENCH_PTY, i & 1, Text_ALPHA + 16, 0); // 64 symbols = 16 groups
+return 16;
+}
+
+static uint8_t Run_7A(uint32_t i, byte Type, const char *Text, bool Repeat)
+// new address for each message (encoded and sent) or the same encoded message again (repeat from paging queue)
+{
+static type_7A_Page Page;
+uint16_t Group[4];
+
+if (!Repeat) {TX.RDS_7A_PAGING(BENCH_PI, 0, 0, BENCH_PTY, 0, Type, BENCH_ADDRESS + i, Text, 0); return TX.RDS_7A_GROUPS(Type, strlen(Text));}
+
+if (Page.Groups == 0) {SI4713::RDS_7A_COMPILE(Page, Type, BENCH_ADDRESS, Text);}
+for (uint8_t g = 0; g < Page.Groups; g++)
+{
+  SI4713::RDS_7A_GROUP(Group, Page, g, BENCH_PI, 0, 0, BENCH_PTY, 0);
+  TX.RDS_SEND_GROUP(Group, 0);
+}
+return Page.Groups;
+}
+
+static uint8_t Run_TONE(uint32_t i) {return Run_7A(i, 0, "", false);}
+static uint8_t Run_DIG10(uint32_t i) {return Run_7A(i, 1, Text_DIG10, false);}
+static uint8_t Run_DIG18(uint32_t i) {return Run_7A(i, 2, Text_DIG18, false);}
+static uint8_t Run_ALPHA16(uint32_t i) {static const char Text[17] = "PAGING LAB RDS E"; return Run_7A(i, 3, Text, false);}
+static uint8_t Run_ALPHA80(uint32_t i) {return Run_7A(i, 3, Text_ALPHA, false);}
+static uint8_t Run_ALPHA80R(uint32_t i) {return Run_7A(i, 3, Text_ALPHA, true);}
+
+typedef struct
+{
+  const char *Name;
+  type_Runner Run;
+} type_Bench;
+
+static const type_Bench Benches[] =
+{
+  {"1A",          Run_1A},
+  {"4A",          Run_4A},
+  {"2A-64",       Run_2A},
+  {"TONE",        Run_TONE},
+  {"DIG10",       Run_DIG10},
+  {"DIG18",       Run_DIG18},
+  {"ALPHA-16",    Run_ALPHA16},
+  {"ALPHA-80",    Run_ALPHA80},
+  {"ALPHA-80 rep", Run_ALPHA80R},
+};
+
+// -------------------------------------------------------- Loopback messages
+static void MonitorLog(FILE *Expected)
+// Same groups as on air: 1A before each message, then 4A and 2A (twice); Expected = file for sent pages or NULL
+{
+static const struct {byte Type; uint32_t Address; const char *Text;} Messages[] =
+{
+  {TONE,  100466, ""},
+  {DIG10, 100466, Text_DIG10},
+  {DIG18, 234567, Text_DIG18},
+  {DIG10, 234567, "12:34"},
+  {ALPHA, 100466, "Hello"},
+  {ALPHA, 123456, Text_ALPHA},
+  {VARNUM, 234567, "0123456789012345678901234567890123456789"}, // 40 digits = 6 groups
+  {FUNC,  100466, "0123456789ABCDEF"},
+};
+for (uint8_t i = 0; i < sizeof(Messages) / sizeof(Messages[0]); i++)
+  {
+  TX.RDS_1A_PIN(BENCH_PI, 0, 0, BENCH_PTY, 6, 0xE4, 0, 1);
+  type_7A_Page Page;
+  uint16_t Group[4];
+  SI4713::RDS_7A_COMPILE(Page, Messages[i].Type, Messages[i].Address, Messages[i].Text);
+  if (Expected) {fprintf(Expected, "%06lu %.*s\n", (unsigned long)Messages[i].Address, PAGE_TEXT_LEN, Messages[i].Text);} // longer text is cut
+  for (uint8_t g = 0; g < Page.Groups; g++) // group by group as from the queue, trace ring is smaller than message
+    {
+    SI4713::RDS_7A_GROUP(Group, Page, g, BENCH_PI, 0, 0, BENCH_PTY, i & 1);
+    TX.RDS_SEND_GROUP(Group, 1, i + 1, (g == Page.Groups - 1) ? TRACE_LAST : 0);
+    Trace.Flush();
+    }
+  }
+TX.RDS_4A_TIME(BENCH_PI, 0, 0, BENCH_PTY, 2024, 11, 16, 13, 30, 0, 2, 0, 1);
+Trace.Flush();
+TX.RDS_2A_RT(BENCH_PI, 0, 0, BENCH_PTY, 0, "Paging LAB", 1);
+Trace.Flush();
+TX.RDS_2A_RT(BENCH_PI, 0, 0, BENCH_PTY, 0, "Paging LAB", 1); // decoder prints text when next cycle starts
+Trace.Flush();
+}
+
+// -------------------------------------------------------- Paging soak
+static int Soak(uint32_t Pages_Total)
+// Firmware path of loop(): queue -> sequencer -> TX with monitor log, slots run as fast as the host can
+{
+static Config Cfg;
+static PagingQueue Pages;
+static GroupSequencer Sequencer;
+static TimeService Clock;
+static CountrySweep Sweep; // not started, paging only
+static const char *Texts[] = {"", Text_DIG10, Text_DIG18, Text_ALPHA};
+Cfg.cfg_Monitor = ON;
+Cfg.cfg_1A_Rpc = 0x04; // battery saving OFF: slots are not waited for in real time
+Serial.Mute = true;
+Clock.Begin(Cfg);
+Sequencer.Begin();
+
+uint32_t Warm_Up = Pages_Total / 100 + 10;
+uint32_t Submitted = 0;
+uint32_t Groups = 0;
+unsigned long Allocs = 0, Peak = 0;
+bool Warm = false;
+unsigned long long Start = Now_ns();
+
+while (Submitted < Pages_Total + Warm_Up || Pages.Count())
+  {
+  if (Submitted == Warm_Up && !Warm) // counters after first messages
+    {
+    Warm = true;
+    Allocs = Host_Allocs;
+    Peak = Host_Heap_Peak;
+    }
+  if (Submitted < Pages_Total + Warm_Up && Pages.Count() < PAGE_QUEUE_SIZE)
+    {
+    byte Type = Submitted % 4;
+    Pages.Submit(BENCH_ADDRESS + Submitted % 1000, Type, Texts[Type]);
+    Submitted++;
+    }
+  Groups += Sequencer.Run(TX, Cfg, Pages, Clock, Sweep);
+  Trace.Drain();
+  Clock.Run(TX, Cfg);
+  }
+TX.Flush();
+
+unsigned long long Time = Now_ns() - Start;
+Serial.Mute = false;
+Allocs = Host_Allocs - Allocs;
+printf("Soak: %lu pages, %lu groups, %.1f ns/group, allocs after warm-up %lu, heap peak %lu -> %lu bytes, trace dropped %u\n",
+       (unsigned long)Pages_Total, (unsigned long)Groups, (double)Time / Groups, Allocs, Peak, Host_Heap_Peak, Trace.Dropped);
+return (Allocs || Host_Heap_Peak != Peak || TX.Errors || Trace.Dropped) ? 1 : 0;
+}
+
+// -------------------------------------------------------- Main
+int main(int argc, char **argv)
+{
+uint32_t Messages = 20000;
+bool I2C_Trace = false;
+bool Monitor = false;
+bool Soak_Test = false;
+const char *Expected_Name = NULL;
+
+for (int a = 1; a < argc; a++)
+  {
+  if (strcmp(argv[a], "-t") == 0) {I2C_Trace = true; Messages = 1;}
+  else if (strcmp(argv[a], "-m") == 0) {Monitor = true;}
+  else if (strcmp(argv[a], "-e") == 0 && a + 1 < argc) {Expected_Name = argv[++a];}
+  else if (strcmp(argv[a], "-s") == 0) {Soak_Test = true; Messages = 100000;}
+  else {Messages = strtoul(argv[a], NULL, 10);}
+  }
+if (!Messages) {Messages = 1;}
+
+TX.Init(-1, 32768, 0x63);
+TX.Flush();
+
+if (Monitor)
+  {
+  FILE *Expected = Expected_Name ? fopen(Expected_Name, "w") : NULL;
+  if (Expected_Name && !Expected) {perror(Expected_Name); return 1;}
+  MonitorLog(Expected);
+  TX.Flush();
+  if (Expected) {fclose(Expected);}
+  return (TX.Errors || Trace.Dropped) ? 1 : 0;
+  }
+
+if (Soak_Test) {return Soak(Messages);}
+
+if (!I2C_Trace)
+  {
+  printf("%-13s %8s %10s %12s %11s %10s %9s\n", "Message", "Groups", "ns/group", "groups/s", "allocs/msg", "I2C B/msg", "I2C hash");
+  }
+
+for (uint8_t b = 0; b < sizeof(Benches) / sizeof(Benches[0]); b++)
+  {
+  Wire.Reset();
+  if (I2C_Trace) {printf("# %s\n", Benches[b].Name); Wire.Trace = stdout;}
+
+  unsigned long Allocs = Host_Allocs;
+  uint32_t Groups = 0;
+  unsigned long long Start = Now_ns();
+
+  for (uint32_t i = 0; i < Messages; i++)
+    {
+    Groups += Benches[b].Run(i);
+    }
+  TX.Flush();
+
+  unsigned long long Time = Now_ns() - Start;
+  Allocs = Host_Allocs - Allocs;
+  Wire.Trace = NULL;
+
+  if (!I2C_Trace)
+    {
+    printf("%-13s %8lu %10.1f %12.0f %11.2f %10.1f  %08lX\n", Benches[b].Name, (unsigned long)Groups,
+           (double)Time / Groups, Groups * 1e9 / Time, (double)Allocs / Messages,
+           (double)Wire.Written / Messages, (unsigned long)Wire.Hash);
+    }
+  }
+
+if (TX.Errors) {fprintf(stderr, "I2C errors: %u\n", TX.Errors); return 1;}
+return 0;
+}
@@ -0,0 +1,426 @@
+/*  chipsim - whole encoder firmware (SOURCE/RDS_DEMO.ino) against SI4713 chip model (chipsim.h) in virtual time
+ *
+ *  Pages go in as CMD_PAGES frames on the serial port at fixed rate, each to its own pager address.
+ *  Aired 7A groups are decoded (rds_decode.h) and matched with submitted pages, so latency is from the frame
+ *  to the end of the last group on air. Time runs only in the simulation: 10 minutes of air take a few seconds.
+ *  Output: throughput (pages, groups by type, PS share), latency, chip counters (CTS polls, commands before CTS,
+ *          FIFO level, overflows, slots with empty FIFO) and counters of the firmware (stats.h).
+ *
+ *  Built with TX_COUNT 2 (chipsim-simulcast, chipsim-spread) a second chip model is on TX2_ADDRESS. Simulcast: its
+ *  groups (0A besides) must be the same as those of the first chip; spread: its pages are decoded too, it must air
+ *  some of them and own 1A/4A.
+ *
+ *  Port mode (-p): no own pages, serial port of the firmware is stdin/stdout (pty of HOST/gateway, socat),
+ *  input comes at 57600 baud of virtual time and virtual time is paced to the host clock (x speed).
+ *  Chip counters go to stderr at end of input.
+ *
+ *  Usage: ./chipsim [-d seconds] [-r pages/min] [-t type] [-l length] [-u n] [-x seconds] [-g pagers] [-b rpc] [-s loop_us] [-a file|-] [-v]
+ *         ./chipsim -p speed [-b rpc] [-s loop_us] [-a file]
+ *         -d air time with new pages (default 600), then queue is drained (max 120 s); pages refused by full queue are lost
+ *         -r pages per minute (default 60), -t message type 0..5 (default 3 = ALPHA), -l text length (default 40)
+ *         -u each n-th page is an urgent tone page (PAGE_URGENT), its latency is shown apart
+ *         -x radio text changes each n seconds (CMD_RT): counter at its end, each 4th time a new text
+ *         -g pages go to this many pagers in turn, each page is repeated twice, urgent pages are alpha too; text starts
+ *            with page number. Pager takes message with A/B flag of its last one for a repeat, a page which comes
+ *            after a later page of its pager or again after it was received counts as reordered
+ *         -b RPC of 1A (default from Config, 4 = battery saving OFF)
+ *         -s time of one loop() besides time readings and I2C, us (default 100)
+ *         -a aired groups "Air 7A: AAAA BBBB CCCC DDDD : time source" (input for rdsmod), -v serial output of firmware
+ *  Exit code 1 when a page is lost, broken or reordered, 1A/4A moved to other slot after MTBUFF, the chip got a command before CTS or the firmware counted chip errors.
+*/
+
+#include <time.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <termios.h>
+#include <unistd.h>
+#include "Arduino.h"
+#include "Wire.h"
+#include "chipsim.h"
+#include "rds_decode.h"
+
+class SI4713; // prototypes which Arduino IDE makes for the sketch
+void Start_TX(SI4713 &Chip, uint16_t Frequency);
+void Update_0A(SI4713 &Chip);
+void ShowStatus();
+void DoMenu(const char *Input);
+void DoFrame();
+uint16_t ParseFRQ(const char *Input);
+bool SetParam(byte Param, uint32_t Value);
+bool SetRadioText(const char *Text);
+void SubmitPages(uint8_t Cmd, const uint8_t *Data, uint8_t Len);
+void StartSweep(byte Type, const char *Text);
+void ShowSweep();
+void SubmitMessage(byte Type, const char *Text);
+
+#include "RDS_DEMO.ino"
+
+#define SIM_PAGES_MAX 65536   // pages of one run
+#define SIM_BASE_ADDRESS 200000UL // address of page n = base + n
+#define SIM_DRAIN_S 120       // max time to send waiting pages after the last one
+#define SIM_BAUD 57600        // serial input of port mode, bytes/s = baud / 10
+#define SIM_RX_BUFFER 64      // receive buffer of AVR core in port mode, bytes over it are lost (overruns)
+#define SIM_PAGERS_MAX 1000   // pagers of -g
+
+#define SIM_OFFSET_ERROR (2 * TIME_POLL_MS + 1) // max error of 4A start measured by firmware, ms
+
+static ChipModel Chip(0x63);
+static GroupDecoder Decoder;
+static long Real_Offset = 0;                         // last 4A of first chip on air minus minute start, ms
+static uint32_t Offset_Checked = 0;                  // Stats.Time_Offset.Count compared with Real_Offset
+static long Offset_Error = 0;                        // largest difference of Clock.Offset from Real_Offset, ms
+#if TX_COUNT > 1
+#define SIM_SEQ_MAX 65536     // groups of each chip kept for simulcast check
+static ChipModel Chip2(TX2_ADDRESS);
+static GroupDecoder Decoder2;                        // TX_SPREAD: pages of second chip
+static uint32_t Sequence[2][SIM_SEQ_MAX];            // CRC32 of each aired group besides 0A, by chip
+static uint32_t Sequence_Len[2] = {0, 0};
+static uint32_t Chip2_Pages = 0;                     // pages received from second chip
+#endif
+static unsigned long long Submitted[SIM_PAGES_MAX]; // us, 0 = not submitted or received
+static uint32_t Latency[SIM_PAGES_MAX];              // ms of received pages
+static uint32_t Urgent_Latency[SIM_PAGES_MAX];       // ms of received urgent pages
+static bool Urgent[SIM_PAGES_MAX];
+static bool Broken[SIM_PAGES_MAX];                  // seen incomplete on air, counts as broken until it comes again complete
+static uint32_t Pages_Sent = 0, Pages_Received = 0, Pages_Broken = 0, Pages_Interrupted = 0, Pages_Reordered = 0, Urgent_Received = 0;
+static uint32_t Pagers = 0;                          // -g: page n goes to pager n % Pagers, 0 = own pager for each page
+static uint8_t Pager_AB[SIM_PAGERS_MAX];             // A/B flag of last message taken by pager, 0xFF = none
+static uint32_t Pager_Next[SIM_PAGERS_MAX];          // last page received by pager + 1, 0 = none
+static unsigned long long Air_End = 0;               // end of group which is decoded now
+static unsigned long long First_Page = 0, Last_Page = 0; // first submit, last received page on air
+
+static unsigned long long Now_ns()
+{
+struct timespec Now;
+clock_gettime(CLOCK_MONOTONIC, &Now);
+return (unsigned long long)Now.tv_sec * 1000000000ULL + Now.tv_nsec;
+}
+
+// -------------------------------------------------------- Pages
+static uint8_t Page_Text(uint32_t n, byte Type, uint8_t Len, char *Text)
+// Text of page n, text for shared pager starts with page number, return length
+{
+static const char *Symbols[] = {"", "0123456789", "0123456789", "ABCDEFGHIJKLMNOPQRSTUVWXYZ 0123456789", "0123456789", "0123456789ABCDEF"};
+
+if (Type == TONE) {Len = 0;}
+if (Type == DIG10 && Len > 10) {Len = 10;}
+if (Type == DIG18 && Len > 18) {Len = 18;}
+for (uint8_t i = 0; i < Len; i++) {Text[i] = Symbols[Type][(n + i) % strlen(Symbols[Type])];}
+if (Pagers) {char Number[12]; snprintf(Number, sizeof(Number), "%05lu ", (unsigned long)n); memcpy(Text, Number, 6);}
+Text[Len] = 0;
+return Len;
+}
+
+static void Send_Page(uint32_t n, byte Type, uint8_t Len)
+// CMD_PAGES frame with one page: Tag, Address, Type, Len, Text
+{
+uint8_t Frame[PROTO_FRAME_MAX + 4];
+uint8_t *Data = Frame + 2;
+char Text[PAGE_TEXT_LEN + 1];
+
+Len = Page_Text(n, Type, Len, Text);
+Data[0] = CMD_PAGES;
+Put16(Data + 1, n);
+Put32(Data + 3, SIM_BASE_ADDRESS + (Pagers ? n % Pagers : n));
+Data[7] = Type | (Urgent[n] ? PAGE_URGENT : 0);
+Data[8] = Len;
+memcpy(Data + 9, Text, Len);
+
+Frame[0] = PROTO_SYNC;
+Frame[1] = 9 + Len;
+Put16(Frame + 2 + Frame[1], CRC16(Frame + 1, Frame[1] + 1));
+Serial.Feed(Frame, Frame[1] + 4);
+Submitted[n] = Host_Time_us;
+if (Pages_Sent == 0) {First_Page = Host_Time_us;}
+Pages_Sent++;
+}
+
+static void Send_Text(uint32_t n)
+// CMD_RT frame: the same text with new counter (one or two segments change), each 4th one a new text (A/B flag toggles)
+{
+static const char *Heads[] = {"Paging LAB news", "RDS encoder on air", "Pagers: call 555-0100", "Weather: sunny, 21 C"};
+uint8_t Frame[PROTO_FRAME_MAX + 4];
+uint8_t *Data = Frame + 2;
+char Text[CFG_RT_LEN + 1];
+
+snprintf(Text, sizeof(Text), "%s, update %05lu", Heads[(n / 4) % 4], (unsigned long)n);
+Data[0] = CMD_RT;
+memcpy(Data + 1, Text, strlen(Text));
+Frame[0] = PROTO_SYNC;
+Frame[1] = 1 + strlen(Text);
+Put16(Frame + 2 + Frame[1], CRC16(Frame + 1, Frame[1] + 1));
+Serial.Feed(Frame, Frame[1] + 4);
+}
+
+static void Page_Sink(const type_Rx_Page &Page, bool Complete, void *Arg)
+// Arg: 0 = first chip, else second chip
+{
+uint32_t n = Page.Address - SIM_BASE_ADDRESS;
+if (Pagers && Page.Address >= SIM_BASE_ADDRESS && n < Pagers) // shared pager: page number from text
+  {
+  uint32_t p = n;
+  if (Page.ABflag == Pager_AB[p] || Page.Len < 6) {return;} // repeat (pager ignores it) or too short to know the page
+  n = strtoul(Page.Text, NULL, 10);
+  if (Complete && n < Pages_Sent)
+    {
+    Pager_AB[p] = Page.ABflag;
+    if (Submitted[n] == 0 || n + 1 < Pager_Next[p]) {Pages_Reordered++;} // old page again or after later one
+    if (n + 1 > Pager_Next[p]) {Pager_Next[p] = n + 1;}
+    }
+  }
+if (Page.Address < SIM_BASE_ADDRESS || n >= Pages_Sent || Submitted[n] == 0) {return;} // test message or repeat
+if (!Complete)
+  {
+  if (!Broken[n]) {Broken[n] = true; Pages_Broken++;}
+  return;
+  }
+if (Broken[n]) {Broken[n] = false; Pages_Broken--; Pages_Interrupted++;} // urgent message went between, sent again
+Latency[Pages_Received++] = (Air_End - Submitted[n]) / 1000;
+#if TX_COUNT > 1
+if (Arg) {Chip2_Pages++;}
+#endif
+if (Urgent[n]) {Urgent_Latency[Urgent_Received++] = (Air_End - Submitted[n]) / 1000;}
+Submitted[n] = 0;
+Last_Page = Air_End;
+}
+
+static void Air_Sink(const uint16_t *Group, unsigned long long Time_us, void *Arg)
+// Arg: 0 = first chip, else second chip (TX_COUNT 2): its groups are kept for simulcast check, pages decoded in spread mode
+{
+Air_End = Time_us + SIM_SLOT_NUM / SIM_SLOT_DEN;
+#if TX_COUNT > 1
+uint8_t c = Arg ? 1 : 0;
+if ((Group[1] >> 12) != 0 && Sequence_Len[c] < SIM_SEQ_MAX) {Sequence[c][Sequence_Len[c]++] = CRC32(Group, 4 * sizeof(Group[0]));}
+if (c == 1)
+  {
+  if (Transmitters.Mode == TX_SPREAD) {Decoder2.Group(Group, 0x0F);}
+  return;
+  }
+#endif
+if ((Group[1] >> 11) == 0x08) // 4A: where it really starts, firmware measures it from FIFO answers
+  {
+  unsigned long T = (unsigned long)(Time_us / 1000);
+  Real_Offset = (Clock.Seconds(T) % 60) * 1000L + Clock.Millis(T);
+  if (Real_Offset >= 30000) {Real_Offset -= 60000;}
+  }
+Decoder.Group(Group, 0x0F);
+}
+
+static int Compare(const void *a, const void *b)
+{
+uint32_t x = *(const uint32_t *)a, y = *(const uint32_t *)b;
+return (x > y) - (x < y);
+}
+
+static void Print_Latency(FILE *Out, const char *Name, uint32_t *ms, uint32_t Count)
+{
+if (Count == 0) {return;}
+qsort(ms, Count, sizeof(ms[0]), Compare);
+unsigned long long Sum = 0;
+for (uint32_t i = 0; i < Count; i++) {Sum += ms[i];}
+fprintf(Out, "%s ms: min %lu, mean %llu, p50 %lu, p95 %lu, max %lu\n", Name, (unsigned long)ms[0], Sum / Count,
+        (unsigned long)ms[Count / 2], (unsigned long)ms[(Count * 95) / 100], (unsigned long)ms[Count - 1]);
+}
+
+// -------------------------------------------------------- Port mode
+static int Run_Port(uint32_t Speed, uint32_t Loop_us)
+// Firmware on stdin/stdout until end of input, virtual time runs Speed times faster than host clock
+{
+uint8_t In[256];
+size_t In_Len = 0, In_Pos = 0;
+unsigned long long Credit_us = 0;  // virtual time not yet paid with input bytes
+bool Open = true;
+struct termios Raw;
+
+Serial.Rx_Size = SIM_RX_BUFFER;
+
+if (isatty(0) && tcgetattr(0, &Raw) == 0) {cfmakeraw(&Raw); tcsetattr(0, TCSANOW, &Raw);} // binary frames, no echo
+fcntl(0, F_SETFL, fcntl(0, F_GETFL) | O_NONBLOCK);
+unsigned long long Start = Now_ns(), Virtual_Start = Host_Time_us;
+
+while (Open || In_Pos < In_Len)
+  {
+  if (Open && In_Pos == In_Len) // next input
+    {
+    ssize_t Got = read(0, In, sizeof(In));
+    if (Got > 0) {In_Len = Got; In_Pos = 0;}
+    else if (Got == 0 || errno != EAGAIN) {Open = false;} // EOF, EIO when other side of pty is closed
+    }
+  size_t Bytes = Credit_us * (SIM_BAUD / 10) / 1000000ULL;
+  if (Bytes > In_Len - In_Pos) {Bytes = In_Len - In_Pos;}
+  if (Bytes)
+    {
+    Serial.Feed(In + In_Pos, Bytes);
+    In_Pos += Bytes;
+    Credit_us -= Bytes * 1000000ULL / (SIM_BAUD / 10);
+    }
+
+  unsigned long long Before = Host_Time_us;
+  loop();
+  Host_Advance(Loop_us);
+  Chip.Run();
+#if TX_COUNT > 1
+  Chip2.Run();
+#endif
+  fflush(stdout);
+  if (In_Pos < In_Len) {Credit_us += Host_Time_us - Before;} else {Credit_us = 0;} // idle line saves no credit
+
+  long long Ahead_us = (long long)(Host_Time_us - Virtual_Start) / Speed - (long long)((Now_ns() - Start) / 1000);
+  if (Ahead_us > 1000) // wait for host clock, new input wakes up earlier
+    {
+    struct pollfd Wait = {0, POLLIN, 0};
+    poll(&Wait, (Open && In_Pos == In_Len) ? 1 : 0, Ahead_us / 1000);
+    }
+  }
+
+fprintf(stderr, "chipsim: %.1f s of air, chip: commands %lu, before CTS %lu, errors %lu, FIFO max %u, overflows %lu, empty FIFO slots %lu; serial overruns %lu\n",
+        Host_Time_us / 1e6, (unsigned long)Chip.Commands, (unsigned long)Chip.Violations, (unsigned long)Chip.Errors, Chip.FIFO_Max,
+        (unsigned long)Chip.Overflows, (unsigned long)Chip.Empty_Slots, Serial.Overruns);
+return (Chip.Violations || Transmitters.Errors() || Serial.Overruns) ? 1 : 0;
+}
+
+// -------------------------------------------------------- Main
+int main(int argc, char **argv)
+{
+uint32_t Duration = 600, Rate = 60, Loop_us = 100, Speed = 0, Urgent_Every = 0, Text_Every = 0;
+byte Type = ALPHA;
+uint8_t Len = 40;
+int Rpc = -1;
+const char *Air_Name = NULL;
+bool Verbose = false;
+
+for (int a = 1; a < argc; a++)
+  {
+  const char *Value = (a + 1 < argc) ? argv[a + 1] : "";
+  if (strcmp(argv[a], "-d") == 0) {Duration = strtoul(Value, NULL, 10); a++;}
+  else if (strcmp(argv[a], "-r") == 0) {Rate = strtoul(Value, NULL, 10); a++;}
+  else if (strcmp(argv[a], "-t") == 0) {Type = strtoul(Value, NULL, 10); a++;}
+  else if (strcmp(argv[a], "-l") == 0) {Len = strtoul(Value, NULL, 10); a++;}
+  else if (strcmp(argv[a], "-b") == 0) {Rpc = strtol(Value, NULL, 10); a++;}
+  else if (strcmp(argv[a], "-s") == 0) {Loop_us = strtoul(Value, NULL, 10); a++;}
+  else if (strcmp(argv[a], "-a") == 0) {Air_Name = Value; a++;}
+  else if (strcmp(argv[a], "-u") == 0) {Urgent_Every = strtoul(Value, NULL, 10); a++;}
+  else if (strcmp(argv[a], "-x") == 0) {Text_Every = strtoul(Value, NULL, 10); a++;}
+  else if (strcmp(argv[a], "-g") == 0) {Pagers = strtoul(Value, NULL, 10); a++;}
+  else if (strcmp(argv[a], "-p") == 0) {Speed = strtoul(Value, NULL, 10); a++;}
+  else if (strcmp(argv[a], "-v") == 0) {Verbose = true;}
+  else {fprintf(stderr, "Usage: %s [-d seconds] [-r pages/min] [-t type] [-l length] [-u n] [-x seconds] [-g pagers] [-b rpc] [-s loop_us] [-a file|-] [-v] | -p speed\n", argv[0]); return 2;}
+  }
+if (Type > FUNC || Len > PAGE_TEXT_LEN || Rate == 0) {fprintf(stderr, "type 0..5, length 0..%u, rate > 0\n", PAGE_TEXT_LEN); return 2;}
+if (Pagers > SIM_PAGERS_MAX || (Pagers && (Type != ALPHA || Len < 6))) {fprintf(stderr, "-g: pagers 1..%u, alpha pages of 6 symbols or more\n", SIM_PAGERS_MAX); return 2;}
+
+if (Speed && Air_Name && strcmp(Air_Name, "-") == 0) {fprintf(stderr, "stdout is serial port in port mode\n"); return 2;}
+if (Air_Name) {Chip.Air = strcmp(Air_Name, "-") == 0 ? stdout : fopen(Air_Name, "w");}
+if (Air_Name && !Chip.Air) {perror(Air_Name); return 1;}
+Chip.Sink = Air_Sink;
+Decoder.Quiet = true;
+Decoder.Page_Sink = Page_Sink;
+
+Host_Virtual = true;
+Wire.Attach(Chip);
+#if TX_COUNT > 1
+Chip2.Sink = Air_Sink;
+Chip2.Sink_Arg = &Chip2;
+Decoder2.Quiet = true;
+Decoder2.Page_Sink = Page_Sink;
+Decoder2.Page_Arg = &Decoder2;
+Wire.Attach(Chip2);
+#endif
+Serial.Mute = !Verbose && !Speed;
+unsigned long long Start = Now_ns();
+
+setup();
+Cfg_Base.cfg_Test_Message = OFF;
+if (Rpc >= 0) {Cfg_Base.cfg_1A_Rpc = Rpc;}
+if (Pagers) {type_Repeat Repeat = {2, 3000, 100}; Cfg_Base.cfg_7A_Repeat = Repeat;}
+memset(Pager_AB, 0xFF, sizeof(Pager_AB));
+if (Speed) {return Run_Port(Speed, Loop_us);}
+
+unsigned long long Interval = 60000000ULL / Rate, Next_Page = Host_Time_us, Next_Text = Host_Time_us;
+uint32_t Texts = 0;
+unsigned long long End = Host_Time_us + Duration * 1000000ULL;
+uint32_t Pages_Total = (uint32_t)((Duration * 1000000ULL + Interval - 1) / Interval);
+if (Pages_Total > SIM_PAGES_MAX) {Pages_Total = SIM_PAGES_MAX;}
+
+while (Host_Time_us < End + SIM_DRAIN_S * 1000000ULL)
+  {
+  if (Pages_Sent < Pages_Total && Host_Time_us >= Next_Page)
+    {
+    Urgent[Pages_Sent] = Urgent_Every && (Pages_Sent % Urgent_Every == Urgent_Every - 1);
+    Send_Page(Pages_Sent, (Urgent[Pages_Sent] && !Pagers) ? TONE : Type, Len);
+    Next_Page += Interval;
+    }
+  if (Text_Every && Host_Time_us < End && Host_Time_us >= Next_Text) {Send_Text(Texts++); Next_Text += Text_Every * 1000000ULL;}
+  if (Pages_Sent >= Pages_Total && Pages_Received + Pages_Broken >= Pages_Sent && Transmitters.Count() == 0) {break;}
+  if (Pages_Sent >= Pages_Total && Host_Time_us >= End && Transmitters.Count() == 0 && Host_Time_us > Last_Page + 2000000ULL) {break;} // refused pages
+  loop();
+  Host_Advance(Loop_us);
+  Chip.Run();
+#if TX_COUNT > 1
+  Chip2.Run();
+#endif
+  if (Stats.Time_Offset.Count != Offset_Checked)
+    {
+    Offset_Checked = Stats.Time_Offset.Count;
+    if (labs(Clock.Offset - Real_Offset) > Offset_Error) {Offset_Error = labs(Clock.Offset - Real_Offset);}
+    }
+  }
+Transmitters.Poll();
+Chip.Run();
+#if TX_COUNT > 1
+Chip2.Run();
+#endif
+
+unsigned long long Real = Now_ns() - Start;
+double Air_s = Host_Time_us / 1e6;
+Serial.Mute = false;
+if (Chip.Air && Chip.Air != stdout) {fclose(Chip.Air);}
+FILE *Out = (Chip.Air == stdout) ? stderr : stdout;
+
+fprintf(Out, "chipsim: %.1f s of air in %.2f s (x%.0f), loop %u us\n", Air_s, Real / 1e9, Air_s * 1e9 / Real, Loop_us);
+fprintf(Out, "groups: %lu (%.2f/s), 0A %lu, 1A %lu, 2A %lu, 4A %lu, 7A %lu; PS %.1f%%, FIFO %lu\n",
+        (unsigned long)(Chip.PS_Groups + Chip.FIFO_Groups), (Chip.PS_Groups + Chip.FIFO_Groups) / Air_s,
+        (unsigned long)Chip.Aired[0], (unsigned long)Chip.Aired[2], (unsigned long)Chip.Aired[4], (unsigned long)Chip.Aired[8],
+        (unsigned long)Chip.Aired[14], 100.0 * Chip.PS_Groups / (Chip.PS_Groups + Chip.FIFO_Groups + (Chip.PS_Groups + Chip.FIFO_Groups == 0)),
+        (unsigned long)Chip.FIFO_Groups);
+fprintf(Out, "pages: sent %lu, received %lu, broken %lu, lost %lu, interrupted %lu, reordered %lu, %.1f pages/min\n", (unsigned long)Pages_Sent,
+        (unsigned long)Pages_Received, (unsigned long)Pages_Broken, (unsigned long)(Pages_Sent - Pages_Received - Pages_Broken),
+        (unsigned long)Pages_Interrupted, (unsigned long)Pages_Reordered,
+        (Last_Page > First_Page) ? Pages_Received * 60e6 / (Last_Page - First_Page) : 0.0);
+Print_Latency(Out, "latency", Latency, Pages_Received);
+Print_Latency(Out, "urgent latency", Urgent_Latency, Urgent_Received);
+fprintf(Out, "chip: commands %lu, busy %.1f%%, status reads %lu (%lu without CTS), before CTS %lu, errors %lu, FIFO max %u, overflows %lu, clears %lu, sync moved %lu, empty FIFO slots %lu\n",
+        (unsigned long)Chip.Commands, Chip.Busy_us / (Air_s * 1e4), (unsigned long)Chip.Status_Reads, (unsigned long)Chip.Busy_Reads,
+        (unsigned long)Chip.Violations, (unsigned long)Chip.Errors, Chip.FIFO_Max, (unsigned long)Chip.Overflows, (unsigned long)Chip.Clears,
+        (unsigned long)Chip.Sync_Moved, (unsigned long)Chip.Empty_Slots);
+fprintf(Out, "firmware: i2c %lu, cts spins %lu, i2c max %lu us, chip errors %u, fifo underflows %u, overflows %u, sync missed %u, loop max %lu us, preemptions %u, reloaded %u\n",
+        (unsigned long)Stats.I2C_Commands, (unsigned long)Stats.CTS_Spins, (unsigned long)Stats.I2C_Time.Max, Transmitters.Errors(),
+        Transmitters.Underflows(), Transmitters.Overflows(), Transmitters.Missed(), (unsigned long)Stats.Loop_Time.Max,
+        Stats.Preemptions, Stats.Groups_Reloaded);
+fprintf(Out, "4A offset: measured %lu, last %d ms, max error %ld ms\n", (unsigned long)Offset_Checked, Clock.Offset, Offset_Error);
+
+bool Failed = (Pages_Received != Pages_Sent || Pages_Reordered || Chip.Sync_Moved || Chip.Violations || Transmitters.Errors() ||
+               Offset_Error > SIM_OFFSET_ERROR || (Chip.Aired[8] > 1 && Offset_Checked == 0));
+
+#if TX_COUNT > 1
+// Simulcast: second chip airs the same groups as the first one (0A of PS carousel besides), spread: it airs own 1A/4A and pages
+uint32_t Compared = (Sequence_Len[0] < Sequence_Len[1]) ? Sequence_Len[0] : Sequence_Len[1], Differ = 0;
+for (uint32_t i = 0; i < Compared; i++) {Differ += (Sequence[0][i] != Sequence[1][i]);}
+fprintf(Out, "chip 2: groups %lu, 1A %lu, 4A %lu, 7A %lu, FIFO %lu, before CTS %lu, errors %lu, sync moved %lu, empty FIFO slots %lu; ",
+        (unsigned long)(Chip2.PS_Groups + Chip2.FIFO_Groups), (unsigned long)Chip2.Aired[2], (unsigned long)Chip2.Aired[8],
+        (unsigned long)Chip2.Aired[14], (unsigned long)Chip2.FIFO_Groups, (unsigned long)Chip2.Violations, (unsigned long)Chip2.Errors,
+        (unsigned long)Chip2.Sync_Moved, (unsigned long)Chip2.Empty_Slots);
+uint32_t Counted = 0; // Stats.Groups: once for each group of first chip in simulcast, for both chips in spread
+for (uint8_t i = 0; i < 16; i++) {Counted += Stats.Groups[i];}
+if (Transmitters.Mode == TX_SIMULCAST) {fprintf(Out, "simulcast: groups compared %lu of %lu, differ %lu, counted %lu\n", (unsigned long)Compared, (unsigned long)Sequence_Len[0], (unsigned long)Differ, (unsigned long)Counted);}
+else {fprintf(Out, "spread: pages %lu of %lu\n", (unsigned long)Chip2_Pages, (unsigned long)Pages_Received);}
+
+Failed = Failed || Chip2.Sync_Moved || Chip2.Violations || Chip2.Aired[2] == 0 || Chip2.Aired[8] == 0;
+if (Transmitters.Mode == TX_SIMULCAST) {Failed = Failed || Differ || Compared + SIM_FIFO_MAX < Sequence_Len[0] ||
+                                               Counted < Chip.FIFO_Groups || Counted > Chip.FIFO_Groups + SIM_FIFO_MAX;} // all but the last FIFO
+else {Failed = Failed || Chip2_Pages == 0;}
+#endif
+
+return Failed ? 1 : 0;
+}
@@ -0,0 +1,360 @@
+/*  SI4713 chip model for Linux host build (I2C slave of Wire.h)
+ *
+ *  Cycle-approximate model of the commands this driver uses, in virtual time of host.cpp:
+ *  - POWER_UP 0x01, GET_REV 0x10, SET_PROPERTY 0x12, TX_TUNE_FREQ 0x30, TX_TUNE_POWER 0x31,
+ *    TX_ASQ_STATUS 0x34, TX_RDS_BUFF 0x35, TX_RDS_PS 0x36, GPIO_CTL 0x80, GPIO_SET 0x81; other commands answer with ERR
+ *  - CTS comes SIM_xxx_US after the command (approximate values, POWER_UP waits for the crystal);
+ *    a command written before CTS is counted as Violation and dropped
+ *  - RDS FIFO of TX_RDS_FIFO_SIZE groups (max SIM_FIFO_MAX), LDBUFF into full FIFO answers ERR (Overflows)
+ *  - air clock: one group each 104 bits at 1187.5 bit/s from RDS enable (TX_COMPONENT_ENABLE bit 2);
+ *    each slot sends FIFO group (block A = RDS_PI property at air time) or PS 0A group as TX_RDS_PS_MIX says,
+ *    PS carousel from TX_RDS_PS_MESSAGE_COUNT and TX_RDS_PS_REPEAT_COUNT
+ *  - FIFOMT flag when last FIFO group went to air, cleared by INTACK after the answer
+ *  - MTBUFF keeps slots of 1A/4A groups which were in FIFO: when they go to air in another slot after the FIFO is
+ *    written again (or not at all), Sync_Moved counts them
+ *  Aired groups go to Air (lines "Air 7A: AAAA BBBB CCCC DDDD : time source", input for rdsmod) and to Sink.
+*/
+
+#ifndef HOST_CHIPSIM_H
+#define HOST_CHIPSIM_H
+
+#include "Arduino.h"
+#include "Wire.h"
+
+#define SIM_FIFO_MAX 54        // FIFO size of the chip
+#define SIM_PROPERTIES 48      // properties kept by the model
+#define SIM_SLOT_NUM 1664000ULL // one group = 104 / 1187.5 s = 1664000 / 19 us
+#define SIM_SLOT_DEN 19
+
+#define SIM_POWER_UP_US 110000 // CTS times, us
+#define SIM_TUNE_US     300    // TX_TUNE_FREQ/POWER: CTS, STC comes SIM_STC_US later
+#define SIM_STC_US      20000
+#define SIM_PROPERTY_US 300
+#define SIM_RDS_US      300    // TX_RDS_BUFF, TX_RDS_PS
+#define SIM_CMD_US      300    // other commands
+
+#define SIM_CTS   0x80 // status bits
+#define SIM_ERR   0x40
+#define SIM_RDSINT 0x04
+#define SIM_STCINT 0x01
+
+#define SIM_FIFOMT 0x01 // TX_RDS_BUFF flags
+
+typedef void (*type_Air_Sink)(const uint16_t *Group, unsigned long long Time_us, void *Arg);
+
+class ChipModel : public HostDevice
+{
+  public:
+    ChipModel(uint8_t Address = 0x63) {this->Address = Address; Reset();}
+    void Reset();                                            // Chip after RST
+    void Run();                                              // Send groups of air slots up to now
+    uint8_t Write(const uint8_t *Data, uint8_t Len);
+    uint8_t Read(uint8_t *Data, uint8_t Len);
+    uint16_t Property(uint16_t Number);                     // Value of property (0 = not set)
+
+    FILE *Air = NULL;                                        // timeline of aired groups
+    type_Air_Sink Sink = NULL;                               // called for each aired group
+    void *Sink_Arg = NULL;
+
+    // Counters
+    uint32_t Commands;        // accepted commands
+    uint32_t Violations;      // commands written before CTS
+    uint32_t Errors;          // commands answered with ERR (not overflow)
+    uint32_t Overflows;       // LDBUFF into full FIFO
+    uint32_t Clears;          // MTBUFF of FIFO with groups in it
+    uint32_t Sync_Moved;      // 1A/4A from cleared FIFO which went to air in other slot than before MTBUFF
+    uint32_t Empty_Slots;     // FIFO was empty in slot (PS group went instead)
+    uint32_t Status_Reads;    // reads of status byte
+    uint32_t Busy_Reads;      // status reads without CTS
+    unsigned long long Busy_us; // time without CTS
+    uint32_t Aired[32];       // groups by type * 2 + version
+    uint32_t PS_Groups;       // 0A groups from PS carousel
+    uint32_t FIFO_Groups;     // groups from FIFO
+    uint8_t FIFO_Max;         // highest FIFO level
+
+  private:
+    void Command(const uint8_t *Data, uint8_t Len);
+    void Set_Property(uint16_t Number, uint16_t Value);
+    void Slot();                                             // one group goes to air
+    void PS_Group(uint16_t *Group);
+    void Sync_Check(const uint16_t *Group, bool From_FIFO); // 1A/4A slots kept at MTBUFF
+    unsigned long long Slot_Start(uint32_t Slot) {return Air_Start + (Slot * SIM_SLOT_NUM) / SIM_SLOT_DEN;}
+
+    bool Powered;
+    unsigned long long CTS_At;        // CTS is set at this time
+    unsigned long long STC_At;        // STCINT is set at this time, 0 = none
+    uint8_t Status;                   // ERR and interrupt bits
+    uint8_t Answer[16];               // answer of last command after status byte
+    uint16_t Number[SIM_PROPERTIES];
+    uint16_t Value[SIM_PROPERTIES];
+    uint8_t Properties;
+    uint16_t Fifo[SIM_FIFO_MAX][3];   // blocks B, C, D
+    uint8_t Fifo_Head;
+    uint8_t Fifo_Used;
+    uint8_t Flags;                    // FIFOMT
+    uint16_t Sync[SIM_FIFO_MAX][3];   // 1A/4A of cleared FIFO: blocks B, C, D
+    uint32_t Sync_Slot[SIM_FIFO_MAX]; // and their slots
+    uint8_t Sync_Head;
+    uint8_t Sync_Used;
+    char PS[24][4];                   // TX_RDS_PS slots
+    bool On_Air;
+    unsigned long long Air_Start;     // time of slot 0
+    uint32_t Next_Slot;
+    uint8_t Mix_Credit;               // PS share in 1/8 slots
+    uint8_t PS_Message;               // carousel: message, segment and repeat
+    uint8_t PS_Segment;
+    uint8_t PS_Repeat;
+};
+// =============================================== End Class ======================================
+
+void ChipModel::Reset()
+{
+Powered = false;
+CTS_At = 0;
+STC_At = 0;
+Status = 0;
+memset(Answer, 0, sizeof(Answer));
+Properties = 0;
+Fifo_Head = Fifo_Used = 0;
+Flags = 0;
+Sync_Head = Sync_Used = 0;
+memset(PS, ' ', sizeof(PS));
+On_Air = false;
+Air_Start = 0;
+Next_Slot = 0;
+Mix_Credit = 0;
+PS_Message = PS_Segment = PS_Repeat = 0;
+Set_Property(0x2C02, 0x0003); // reset defaults which change air output
+Set_Property(0x2C03, 0x1008);
+Set_Property(0x2C04, 0x0003);
+Set_Property(0x2C05, 0x0001);
+Set_Property(0x2C06, 0xE0E0);
+
+Commands = Violations = Errors = Overflows = Clears = Sync_Moved = Empty_Slots = Status_Reads = Busy_Reads = 0;
+Busy_us = 0;
+memset(Aired, 0, sizeof(Aired));
+PS_Groups = FIFO_Groups = 0;
+FIFO_Max = 0;
+}
+
+uint16_t ChipModel::Property(uint16_t Number)
+{
+for (uint8_t i = 0; i < Properties; i++) {if (this->Number[i] == Number) {return Value[i];}}
+return 0;
+}
+
+void ChipModel::Set_Property(uint16_t Number, uint16_t Value)
+{
+for (uint8_t i = 0; i < Properties; i++) {if (this->Number[i] == Number) {this->Value[i] = Value; return;}}
+if (Properties < SIM_PROPERTIES) {this->Number[Properties] = Number; this->Value[Properties] = Value; Properties++;}
+}
+
+// -------------------------------------------------------- I2C
+uint8_t ChipModel::Write(const uint8_t *Data, uint8_t Len)
+{
+Run();
+if (Len == 0) {return 0;}
+unsigned long long Now = Host_Time_us;
+if (Now < CTS_At) {Violations++; return 0;} // chip is busy: command is lost
+if (!Powered && Data[0] != 0x01) {Errors++; return 0;} // only POWER_UP after reset
+Commands++;
+Command(Data, Len);
+return 0;
+}
+
+uint8_t ChipModel::Read(uint8_t *Data, uint8_t Len)
+{
+Run();
+unsigned long long Now = Host_Time_us;
+bool CTS = Now >= CTS_At;
+if (STC_At && Now >= STC_At) {Status |= SIM_STCINT; STC_At = 0;}
+
+Status_Reads++;
+if (!CTS) {Busy_Reads++;}
+memset(Data, 0, Len);
+if (Len > 0) {Data[0] = (CTS ? SIM_CTS : 0) | Status;}
+if (CTS) {for (uint8_t i = 1; i < Len && i <= sizeof(Answer); i++) {Data[i] = Answer[i - 1];}}
+return Len;
+}
+
+void ChipModel::Command(const uint8_t *Data, uint8_t Len)
+{
+unsigned long long Now = Host_Time_us;
+uint32_t Time = SIM_CMD_US;
+
+Status &= ~SIM_ERR;
+memset(Answer, 0, sizeof(Answer));
+switch (Data[0])
+  {
+  case 0x01: // POWER_UP
+    Powered = true;
+    Time = SIM_POWER_UP_US;
+    break;
+
+  case 0x10: // GET_REV: PN, FW, patch, CMP, CHIPREV
+    Answer[0] = 13;
+    Answer[1] = '3'; Answer[2] = '0';
+    Answer[5] = '3'; Answer[6] = '0';
+    Answer[7] = 'C';
+    break;
+
+  case 0x12: // SET_PROPERTY: 0, number, value
+    if (Len < 6) {Status |= SIM_ERR; break;}
+    Set_Property(word(Data[2], Data[3]), word(Data[4], Data[5]));
+    if ((word(Data[2], Data[3]) == 0x2100) && bitRead(word(Data[4], Data[5]), 2) && !On_Air) // RDS is enabled: air clock starts
+      {
+      On_Air = true;
+      Air_Start = Now;
+      Next_Slot = 0;
+      }
+    if ((word(Data[2], Data[3]) == 0x2100) && !bitRead(word(Data[4], Data[5]), 2)) {On_Air = false;}
+    Time = SIM_PROPERTY_US;
+    break;
+
+  case 0x30: // TX_TUNE_FREQ
+  case 0x31: // TX_TUNE_POWER
+    Time = SIM_TUNE_US;
+    STC_At = Now + SIM_STC_US;
+    Status &= ~SIM_STCINT;
+    break;
+
+  case 0x34: // TX_ASQ_STATUS: flags, 0, 0, input level
+    Answer[3] = (uint8_t)-20;
+    break;
+
+  case 0x35: // TX_RDS_BUFF: flags, B, C, D -> flags, CBAVAIL, CBUSED, FIFOAVAIL, FIFOUSED
+    {
+    uint8_t Size = Property(0x2C07);
+    if (Size > SIM_FIFO_MAX) {Size = SIM_FIFO_MAX;}
+    if (bitRead(Data[1], 1) && bitRead(Data[1], 7)) // MTBUFF of FIFO
+      {
+      Clears += (Fifo_Used > 0);
+      Sync_Head = Sync_Used = 0;
+      for (uint8_t i = 0; i < Fifo_Used; i++) // group i would go to air in slot Next_Slot + i (PS mix 0)
+        {
+        const uint16_t *Group = Fifo[(Fifo_Head + i) % SIM_FIFO_MAX];
+        if ((Group[0] >> 11) != 2 && (Group[0] >> 11) != 8) {continue;}
+        memcpy(Sync[Sync_Used], Group, sizeof(Sync[0]));
+        Sync_Slot[Sync_Used++] = Next_Slot + i;
+        }
+      Fifo_Used = 0;
+      }
+    if (bitRead(Data[1], 2)) // LDBUFF
+      {
+      if (!bitRead(Data[1], 7) || Size == 0) {Status |= SIM_ERR; Errors++;} // circular buffer is not modeled
+      else if (Fifo_Used >= Size) {Status |= SIM_ERR; Overflows++;}
+      else
+        {
+        uint16_t *Group = Fifo[(Fifo_Head + Fifo_Used) % SIM_FIFO_MAX];
+        for (uint8_t i = 0; i < 3; i++) {Group[i] = (Len >= 8) ? word(Data[2 + i * 2], Data[3 + i * 2]) : 0;}
+        Fifo_Used++;
+        if (Fifo_Used > FIFO_Max) {FIFO_Max = Fifo_Used;}
+        }
+      }
+    Answer[0] = Flags;
+    Answer[3] = Size - Fifo_Used;
+    Answer[4] = Fifo_Used;
+    if (bitRead(Data[1], 0)) {Flags = 0;} // INTACK after the answer
+    Time = SIM_RDS_US;
+    break;
+    }
+
+  case 0x36: // TX_RDS_PS: PSID, 4 symbols
+    if (Len < 6 || Data[1] >= 24) {Status |= SIM_ERR; Errors++; break;}
+    memcpy(PS[Data[1]], Data + 2, 4);
+    Time = SIM_RDS_US;
+    break;
+
+  case 0x80: // GPIO_CTL
+  case 0x81: // GPIO_SET
+    break;
+
+  default:
+    Status |= SIM_ERR;
+    Errors++;
+    break;
+  }
+
+CTS_At = Now + Time;
+Busy_us += Time;
+}
+
+// -------------------------------------------------------- Air
+void ChipModel::Run()
+{
+while (On_Air && (Slot_Start(Next_Slot) <= Host_Time_us)) {Slot();}
+}
+
+void ChipModel::Slot()
+// group of slot Next_Slot goes to air
+{
+static const uint8_t Share[7] = {0, 1, 2, 4, 6, 7, 8}; // TX_RDS_PS_MIX in 1/8 slots
+uint8_t Mix = Property(0x2C02);
+if (Mix > 6) {Mix = 3;}
+uint16_t Group[4];
+bool From_PS = true;
+
+if (Fifo_Used > 0)
+  {
+  Mix_Credit += Share[Mix];
+  if ((Mix == 0) || (Mix_Credit < 8)) {From_PS = false;}
+  else {Mix_Credit -= 8;}
+  }
+else {Empty_Slots++;}
+
+Sync_Check(Fifo[Fifo_Head], !From_PS);
+if (From_PS) {PS_Group(Group); PS_Groups++;}
+else
+  {
+  memcpy(Group + 1, Fifo[Fifo_Head], sizeof(Fifo[0]));
+  Fifo_Head = (Fifo_Head + 1) % SIM_FIFO_MAX;
+  Fifo_Used--;
+  if (Fifo_Used == 0) {Flags |= SIM_FIFOMT;}
+  FIFO_Groups++;
+  }
+Group[0] = Property(0x2C01); // PI at air time
+
+unsigned long long Time = Slot_Start(Next_Slot);
+Aired[Group[1] >> 11]++;
+if (Air) {fprintf(Air, "Air %u%c: %04X %04X %04X %04X : %llu.%03llu %s\n", Group[1] >> 12, bitRead(Group[1], 11) ? 'B' : 'A',
+                  Group[0], Group[1], Group[2], Group[3], Time / 1000000ULL, (Time / 1000) % 1000, From_PS ? "PS" : "FIFO");}
+if (Sink) {Sink(Group, Time, Sink_Arg);}
+Next_Slot++;
+}
+
+void ChipModel::Sync_Check(const uint16_t *Group, bool From_FIFO)
+// Group = blocks B, C, D of FIFO group going to air in slot Next_Slot
+{
+while (Sync_Head < Sync_Used && Sync_Slot[Sync_Head] < Next_Slot) {Sync_Moved++; Sync_Head++;} // its slot is over
+if (Sync_Head == Sync_Used) {return;}
+bool Same = From_FIFO && (memcmp(Group, Sync[Sync_Head], sizeof(Sync[0])) == 0);
+if (Sync_Slot[Sync_Head] == Next_Slot) {Sync_Moved += !Same; Sync_Head++;}
+else if (Same) {Sync_Moved++; Sync_Head++;} // too early
+}
+
+void ChipModel::PS_Group(uint16_t *Group)
+// 0A: segment of PS carousel, TP/PTY/TA/MS and DI from TX_RDS_PS_MISC, AF from TX_RDS_PS_AF
+{
+uint16_t Misc = Property(0x2C03);
+uint8_t Count = Property(0x2C05);
+uint8_t Repeat = Property(0x2C04);
+if (Count == 0 || Count > 12) {Count = 1;}
+if (Repeat == 0) {Repeat = 1;}
+if (PS_Message >= Count) {PS_Message = 0;}
+
+uint8_t DI = bitRead(Misc, 15 - PS_Segment); // RDSD3 in segment 0
+Group[1] = (Misc & 0x07F8) | (DI << 2) | PS_Segment; // TP, PTY, TA, MS
+Group[2] = Property(0x2C06);
+const char *Text = PS[PS_Message * 2 + PS_Segment / 2] + (PS_Segment % 2) * 2;
+Group[3] = word(Text[0], Text[1]);
+
+PS_Segment++;
+if (PS_Segment < 4) {return;}
+PS_Segment = 0;
+PS_Repeat++;
+if (PS_Repeat < Repeat) {return;}
+PS_Repeat = 0;
+PS_Message = (PS_Message + 1) % Count;
+}
+
+#endif
@@ -0,0 +1,991 @@
+/*  gateway - paging gateway daemon: pages of local clients go to the encoder as CMD_PAGES frames (SOURCE/protocol.h)
+ *
+ *  Clients write text lines to a Unix stream socket (-u) or to a named pipe (-f):
+ *     PAGE address type text     type: TONE DIG10 DIG18 ALPHA VARNUM FUNC or 0..5, text up to 80 symbols
+ *                                type with "!" (ALPHA!) = urgent: goes before other pages and interrupts the message on air
+ *     STATS
+ *  Socket clients get a line for each step of the page (ref = number given by the gateway):
+ *     QUEUED ref | BUSY (gateway is full) | ERR reason
+ *     ACK ref id groups ms       page is in paging queue of the encoder, ms from PAGE line
+ *     AIR ref ms                 last group of the page went to the chip (-m, monitor trace of the encoder)
+ *     DONE ref                   (-m) end of page was not in the trace (records dropped by the encoder)
+ *     FAIL ref status            encoder refused the page (protocol.h status) or gave no reply GW_TRIES times
+ *  Pipe lines get no replies.
+ *
+ *  One epoll loop for everything, no threads. Pages wait in a pool of -q places taken at start, no allocation later.
+ *  Only one frame waits for reply at a time. Pages go in batches (as many as fit in one frame) when the encoder
+ *  has free places in its queue: CMD_STATUS gives them, each accepted page takes one, PROTO_FULL makes the page
+ *  wait again at the head. CMD_STATS is read each second, new FIFO overflows hold batches for GW_HOLD_MS.
+ *  A page without reply is sent again (the pager may get it twice), after GW_TRIES it fails.
+ *  Counters and latency (p50/p95/max of last GW_SAMPLES pages) go to stderr every -i seconds, on STATS and at exit.
+ *
+ *  Usage: ./gateway (-d tty | -e command) [-u socket] [-f fifo] [-q pages] [-m] [-i seconds] [-v]
+ *         -d serial port of the encoder (57600 8N1), -e command which is the encoder on a pty (./chipsim -p 50)
+ *         -m monitor ON in the encoder, pages are finished at AIR instead of ACK, -v text of encoder and page events
+ *         ./gateway -c socket [-n pages] [-r pages/s] [-t type] [-l length] [-w]
+ *         client for tests: sends -n pages (default 1000, all at once when -r is 0), waits for ACK (-w: AIR) of each,
+ *         prints latency and throughput, exit code 1 when a page failed
+*/
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdarg.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <signal.h>
+#include <strings.h>
+#include <termios.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/epoll.h>
+#include <sys/signalfd.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <sys/wait.h>
+
+#define FRAME_SYNC 0xA5    // protocol.h
+#define FRAME_MAX  96      // PROTO_FRAME_MAX, one frame fits in receive buffer and ring of encoder
+#define REPLY_MAX  64      // longest reply frame LEN which is taken as frame (PROTO_REPLY_MAX + CMD + STATUS, trace)
+#define CMD_PING   0x01
+#define CMD_STATUS 0x02
+#define CMD_SET    0x03
+#define CMD_STATS  0x04
+#define CMD_PAGES  0x10
+#define CMD_TRACE  0x20
+#define PROTO_NAK  0x7F
+#define PROTO_OK   0
+#define PROTO_FULL 5
+#define SET_MONITOR 12     // config.h
+#define PAGE_URGENT 0x80   // flag in type
+#define TEXT_MAX   80      // PAGE_TEXT_LEN
+#define ADDRESS_MAX 999999
+#define RECORD_LAST 0x01   // TRACE_LAST
+
+#define GW_CLIENTS  32     // socket clients at a time
+#define GW_LINE     128    // longest client line (PAGE, address, type, 80 symbols)
+#define GW_OUT      4096   // replies waiting for a slow client, client is closed when they don't fit
+#define GW_SAMPLES  4096   // latencies kept for percentiles
+#define GW_REPLY_MS 500    // wait for reply frame, then send again
+#define GW_TRIES    3      // frames without reply before the page fails
+#define GW_PING_MS  1000   // ping while encoder doesn't answer (reset after port open)
+#define GW_POLL_MS  20     // CMD_STATUS while pages wait for place in encoder
+#define GW_IDLE_MS  1000   // CMD_STATUS without waiting pages
+#define GW_STATS_MS 1000   // CMD_STATS (FIFO overflows)
+#define GW_HOLD_MS  1000   // no batches after new FIFO overflows
+
+#define PAGE_FREE    0     // page states
+#define PAGE_WAITING 1     // in send list
+#define PAGE_SENT    2     // in frame without reply
+#define PAGE_ENCODER 3     // accepted, waiting for AIR (-m)
+
+#define LINK_PING  0       // encoder states
+#define LINK_SETUP 1       // monitor ON
+#define LINK_READY 2
+
+typedef struct
+{
+  uint32_t Address;
+  uint8_t Type;
+  uint8_t Len;
+  char Text[TEXT_MAX];
+  uint8_t State;           // PAGE_xxx
+  uint8_t ID;              // paging queue ID in encoder
+  uint8_t Tries;           // frames sent without reply
+  int8_t Client;           // -1 = pipe or client is gone
+  uint32_t Client_Gen;     // Gen of client when page came
+  uint32_t Ref;
+  unsigned long long In_us;
+  int Next;                // send list or free list, -1 = end
+} type_Gw_Page;
+
+typedef struct
+{
+  int Fd;                  // -1 = free place
+  uint32_t Gen;            // new for each connection, pages of old one get no replies
+  char In[GW_LINE + 1];
+  size_t In_Len;
+  char Out[GW_OUT];
+  size_t Out_Len;
+  bool Out_Wait;           // EPOLLOUT is on
+} type_Client;
+
+typedef struct
+{
+  uint32_t Value[GW_SAMPLES];
+  uint32_t Count;          // all samples, last GW_SAMPLES are kept
+  unsigned long long Sum;
+} type_Latency;
+
+static const char *Type_Name[] = {"TONE", "DIG10", "DIG18", "ALPHA", "VARNUM", "FUNC"};
+
+static unsigned long long Now_us()
+{
+struct timespec Now;
+clock_gettime(CLOCK_MONOTONIC, &Now);
+return (unsigned long long)Now.tv_sec * 1000000ULL + Now.tv_nsec / 1000;
+}
+
+static uint16_t CRC16(const uint8_t *p, uint16_t Len)
+// CRC-16/CCITT, as CRC16() of SOURCE/tools.h
+{
+uint16_t CRC = 0xFFFF;
+for (uint16_t i = 0; i < Len; i++)
+  {
+  CRC ^= (uint16_t)p[i] << 8;
+  for (uint8_t b = 0; b < 8; b++) {CRC = (CRC & 0x8000) ? (CRC << 1) ^ 0x1021 : (CRC << 1);}
+  }
+return CRC;
+}
+
+static uint16_t Get16(const uint8_t *p) {return p[0] | (p[1] << 8);}
+static void Put16(uint8_t *p, uint16_t Value) {p[0] = Value; p[1] = Value >> 8;}
+static void Put32(uint8_t *p, uint32_t Value) {Put16(p, Value); Put16(p + 2, Value >> 16);}
+
+static int Compare(const void *a, const void *b)
+{
+uint32_t x = *(const uint32_t *)a, y = *(const uint32_t *)b;
+return (x > y) - (x < y);
+}
+
+static void Add_Latency(type_Latency &L, uint32_t ms)
+{
+L.Value[L.Count % GW_SAMPLES] = ms;
+L.Count++;
+L.Sum += ms;
+}
+
+static int Print_Latency(char *Out, size_t Size, const char *Name, const type_Latency &L)
+// "name ms mean M p50 A p95 B max C" over kept samples
+{
+static uint32_t Sorted[GW_SAMPLES];
+uint32_t n = L.Count < GW_SAMPLES ? L.Count : GW_SAMPLES;
+if (n == 0) {return snprintf(Out, Size, "%s ms -", Name);}
+memcpy(Sorted, L.Value, n * sizeof(Sorted[0]));
+qsort(Sorted, n, sizeof(Sorted[0]), Compare);
+return snprintf(Out, Size, "%s ms mean %llu p50 %lu p95 %lu max %lu", Name, L.Sum / L.Count, (unsigned long)Sorted[n / 2],
+                (unsigned long)Sorted[(n * 95) / 100], (unsigned long)Sorted[n - 1]);
+}
+
+// -------------------------------------------------------- State
+static bool Monitor = false, Verbose = false;
+static int Epoll = -1;
+static unsigned long long Now = 0;
+
+static type_Gw_Page *Page;               // pool of Pages_Max
+static uint32_t Pages_Max = 4096;
+static int Free_Head = -1;
+static int Send_Head = -1, Send_Tail = -1; // pages for next batch
+static int Urgent_Tail = -1;             // last urgent page in send list, -1 = none
+static uint32_t Next_Ref = 1;
+static int ID_Page[256];                 // page of encoder ID waiting for AIR, -1 = none
+
+static type_Client Client[GW_CLIENTS];
+static type_Client Pipe;                 // named pipe input, Fd only for reading
+static uint32_t Client_Gen = 0;
+
+static int Serial = -1;
+static uint8_t Tx[1024];                 // bytes for serial port
+static size_t Tx_Len = 0;
+static bool Tx_Wait = false;             // EPOLLOUT is on
+static uint8_t Rx[REPLY_MAX + 4];        // frame being received
+static size_t Rx_Len = 0;
+
+static uint8_t Link = LINK_PING;
+static uint8_t Silent = 0;               // timeouts since last reply
+static uint8_t Wait_Cmd = 0;             // reply which is waited for, 0 = none
+static unsigned long long Wait_Since = 0, Next_Ping = 0, Status_Due = 0, Stats_Due = 0, Hold_Until = 0;
+static int Batch[FRAME_MAX / 8];         // pages in CMD_PAGES frame
+static uint8_t Batch_Count = 0, Batch_Replies = 0;
+static int Back_Head = -1, Back_Tail = -1; // pages refused with PROTO_FULL, go back to head of send list
+static uint8_t Enc_Free = 0, Enc_Waiting = 0, Enc_Size = 0;
+static uint16_t Enc_Errors = 0, Enc_Overflows = 0, Enc_Underflows = 0, Enc_Dropped = 0, Enc_Bad = 0;
+static bool Enc_Stats = false;           // Enc_xxx counters are read
+
+static unsigned long Pages_In = 0, Acked = 0, Aired = 0, Untraced = 0, Failed = 0, Busy = 0, Resent = 0, Batches = 0,
+                     Timeouts = 0, Holds = 0, Slow_Clients = 0;
+static uint32_t Waiting = 0, Sent = 0, In_Encoder = 0;
+static type_Latency Ack_Latency, Air_Latency;
+
+// -------------------------------------------------------- Clients
+static void Watch(int Fd, uint32_t Kind, uint32_t Index, uint32_t Events, int Op)
+// epoll data: kind in high half, index in low half
+{
+struct epoll_event Event;
+Event.events = Events;
+Event.data.u64 = ((uint64_t)Kind << 32) | Index;
+epoll_ctl(Epoll, Op, Fd, &Event);
+}
+
+#define KIND_LISTEN 1
+#define KIND_CLIENT 2
+#define KIND_PIPE   3
+#define KIND_SERIAL 4
+#define KIND_SIGNAL 5
+
+static void Close_Client(int i)
+{
+close(Client[i].Fd);
+Client[i].Fd = -1;
+}
+
+static void Flush_Client(int i)
+{
+type_Client &C = Client[i];
+while (C.Out_Len)
+  {
+  ssize_t Done = send(C.Fd, C.Out, C.Out_Len, MSG_DONTWAIT | MSG_NOSIGNAL);
+  if (Done < 0 && errno == EINTR) {continue;}
+  if (Done < 0 && errno == EAGAIN)
+    {
+    if (!C.Out_Wait) {Watch(C.Fd, KIND_CLIENT, i, EPOLLIN | EPOLLOUT, EPOLL_CTL_MOD);}
+    C.Out_Wait = true;
+    return;
+    }
+  if (Done <= 0) {Close_Client(i); return;}
+  memmove(C.Out, C.Out + Done, C.Out_Len - Done);
+  C.Out_Len -= Done;
+  }
+if (C.Out_Wait) {Watch(C.Fd, KIND_CLIENT, i, EPOLLIN, EPOLL_CTL_MOD);}
+C.Out_Wait = false;
+}
+
+static void Reply(type_Client &C, const char *Format, ...)
+// line to socket client, client which doesn't read is closed
+{
+if (C.Fd < 0 || &C == &Pipe) {return;}
+char Line[512];
+va_list Args;
+va_start(Args, Format);
+int Len = vsnprintf(Line, sizeof(Line), Format, Args);
+va_end(Args);
+int i = &C - Client;
+if (Len < 0 || (size_t)Len >= sizeof(Line) || C.Out_Len + Len > GW_OUT) {Slow_Clients++; Close_Client(i); return;}
+bool Idle = (C.Out_Len == 0);
+memcpy(C.Out + C.Out_Len, Line, Len);
+C.Out_Len += Len;
+if (Idle) {Flush_Client(i);} // else EPOLLOUT is on
+}
+
+static type_Client *Owner(const type_Gw_Page &P)
+{
+if (P.Client < 0 || Client[P.Client].Fd < 0 || Client[P.Client].Gen != P.Client_Gen) {return NULL;}
+return &Client[P.Client];
+}
+
+// -------------------------------------------------------- Pages
+static void Append(int &Head, int &Tail, int n)
+{
+Page[n].Next = -1;
+if (Tail < 0) {Head = n;} else {Page[Tail].Next = n;}
+Tail = n;
+}
+
+static void Release(int n)
+{
+Page[n].State = PAGE_FREE;
+Page[n].Next = Free_Head;
+Free_Head = n;
+}
+
+static void Fail(int n, uint8_t Status)
+{
+type_Client *C = Owner(Page[n]);
+if (C) {Reply(*C, "FAIL %lu %u\n", (unsigned long)Page[n].Ref, Status);}
+if (Verbose) {fprintf(stderr, "page %lu failed, status %u\n", (unsigned long)Page[n].Ref, Status);}
+Failed++;
+Release(n);
+}
+
+static void Finish_Air(int n, bool Seen)
+// end of page on air (trace) or its encoder ID is used again without trace of it
+{
+type_Client *C = Owner(Page[n]);
+uint32_t ms = (Now - Page[n].In_us) / 1000;
+if (Seen) {Aired++; Add_Latency(Air_Latency, ms);} else {Untraced++;}
+if (C && Seen) {Reply(*C, "AIR %lu %lu\n", (unsigned long)Page[n].Ref, (unsigned long)ms);}
+if (C && !Seen) {Reply(*C, "DONE %lu\n", (unsigned long)Page[n].Ref);}
+ID_Page[Page[n].ID] = -1;
+In_Encoder--;
+Release(n);
+}
+
+static void Stats_Line(char *Out, size_t Size)
+{
+int Len = snprintf(Out, Size, "pages %lu, acked %lu, aired %lu, untraced %lu, failed %lu, busy %lu, resent %lu, batches %lu; "
+                   "waiting %lu, sent %lu, in encoder %lu; encoder queue %u/%u, fifo overflows %u, underflows %u, errors %u, "
+                   "trace dropped %u, bad frames %u, holds %lu; ",
+                   Pages_In, Acked, Aired, Untraced, Failed, Busy, Resent, Batches, (unsigned long)Waiting, (unsigned long)Sent,
+                   (unsigned long)In_Encoder, Enc_Waiting, Enc_Size, Enc_Overflows, Enc_Underflows, Enc_Errors, Enc_Dropped, Enc_Bad, Holds);
+Len += Print_Latency(Out + Len, Size - Len, "ack", Ack_Latency);
+Len += snprintf(Out + Len, Size - Len, "; ");
+Print_Latency(Out + Len, Size - Len, "air", Air_Latency);
+}
+
+static void Command(type_Client &C, char *Line)
+// PAGE address type text | STATS
+{
+char *Rest = Line;
+char *Word = strsep(&Rest, " ");
+
+if (strcasecmp(Word, "STATS") == 0)
+  {
+  char Out[600];
+  Stats_Line(Out, sizeof(Out));
+  Reply(C, "STATS %s\n", Out);
+  fprintf(stderr, "gateway: %s\n", Out);
+  return;
+  }
+if (strcasecmp(Word, "PAGE") != 0) {Reply(C, "ERR command\n"); return;}
+
+char *Address = strsep(&Rest, " ");
+char *Type = strsep(&Rest, " ");
+const char *Text = Rest ? Rest : "";
+char *End;
+if (!Address || !Type) {Reply(C, "ERR PAGE address type text\n"); return;}
+size_t Type_Len = strlen(Type);
+bool Urgent = Type_Len > 1 && Type[Type_Len - 1] == '!';
+if (Urgent) {Type[Type_Len - 1] = 0;}
+unsigned long Value = strtoul(Address, &End, 10);
+if (*Address == 0 || *End || Value > ADDRESS_MAX) {Reply(C, "ERR address\n"); return;}
+int Kind = -1;
+for (int t = 0; t < 6; t++) {if (strcasecmp(Type, Type_Name[t]) == 0 || (Type[0] == '0' + t && Type[1] == 0)) {Kind = t;}}
+if (Kind < 0) {Reply(C, "ERR type\n"); return;}
+if (strlen(Text) > TEXT_MAX) {Reply(C, "ERR text longer than %u\n", TEXT_MAX); return;}
+if (Free_Head < 0) {Busy++; Reply(C, "BUSY\n"); return;}
+
+int n = Free_Head;
+type_Gw_Page &P = Page[n];
+Free_Head = P.Next;
+P.Address = Value;
+P.Type = Kind | (Urgent ? PAGE_URGENT : 0);
+P.Len = strlen(Text);
+memcpy(P.Text, Text, P.Len);
+P.State = PAGE_WAITING;
+P.Tries = 0;
+P.Client = (&C == &Pipe) ? -1 : &C - Client;
+P.Client_Gen = C.Gen;
+P.Ref = Next_Ref++;
+P.In_us = Now;
+if (!Urgent) {Append(Send_Head, Send_Tail, n);}
+else // after urgent pages which wait already
+  {
+  P.Next = (Urgent_Tail < 0) ? Send_Head : Page[Urgent_Tail].Next;
+  if (Urgent_Tail < 0) {Send_Head = n;} else {Page[Urgent_Tail].Next = n;}
+  if (P.Next < 0) {Send_Tail = n;}
+  Urgent_Tail = n;
+  }
+Waiting++;
+Pages_In++;
+Reply(C, "QUEUED %lu\n", (unsigned long)P.Ref);
+}
+
+static bool Input(type_Client &C, int Fd)
+// read lines of client or pipe, false = end of input
+{
+char Buf[1024];
+ssize_t Got = read(Fd, Buf, sizeof(Buf));
+if (Got < 0) {return errno == EAGAIN || errno == EINTR;}
+if (Got == 0) {return false;}
+
+for (ssize_t i = 0; i < Got; i++)
+  {
+  char c = Buf[i];
+  if (c == '\r') {continue;}
+  if (c != '\n')
+    {
+    if (C.In_Len < GW_LINE) {C.In[C.In_Len] = c;}
+    C.In_Len++; // longer line is refused at its end
+    continue;
+    }
+  if (C.In_Len > GW_LINE) {Reply(C, "ERR line longer than %u\n", GW_LINE);}
+  else if (C.In_Len) {C.In[C.In_Len] = 0; Command(C, C.In);}
+  C.In_Len = 0;
+  if (&C != &Pipe && C.Fd < 0) {return false;} // closed by Reply()
+  }
+return true;
+}
+
+// -------------------------------------------------------- Serial port
+static void Serial_Flush()
+{
+while (Tx_Len)
+  {
+  ssize_t Done = write(Serial, Tx, Tx_Len);
+  if (Done < 0 && errno == EINTR) {continue;}
+  if (Done <= 0) {break;} // EAGAIN: EPOLLOUT, errors come with read
+  memmove(Tx, Tx + Done, Tx_Len - Done);
+  Tx_Len -= Done;
+  }
+if ((Tx_Len != 0) != Tx_Wait)
+  {
+  Tx_Wait = (Tx_Len != 0);
+  Watch(Serial, KIND_SERIAL, 0, Tx_Wait ? EPOLLIN | EPOLLOUT : EPOLLIN, EPOLL_CTL_MOD);
+  }
+}
+
+static void Send_Frame(const uint8_t *Data, uint8_t Len)
+// SYNC LEN CMD DATA CRC, reply of Data[0] is waited for
+{
+if (Tx_Len + Len + 4 > sizeof(Tx)) {return;} // port is stuck, timeout sends again
+uint8_t *p = Tx + Tx_Len;
+p[0] = FRAME_SYNC;
+p[1] = Len;
+memcpy(p + 2, Data, Len);
+Put16(p + 2 + Len, CRC16(p + 1, Len + 1));
+Tx_Len += Len + 4;
+Wait_Cmd = Data[0];
+Wait_Since = Now;
+Serial_Flush();
+}
+
+static void Send_Batch()
+// pages from head of send list while they fit in one frame and encoder has place
+{
+uint8_t Data[FRAME_MAX];
+uint8_t Len = 1;
+Data[0] = CMD_PAGES;
+Batch_Count = 0;
+Batch_Replies = 0;
+
+while (Send_Head >= 0 && Batch_Count < Enc_Free && Batch_Count < sizeof(Batch) / sizeof(Batch[0]) && Len + 8 + Page[Send_Head].Len <= FRAME_MAX)
+  {
+  int n = Send_Head;
+  type_Gw_Page &P = Page[n];
+  Send_Head = P.Next;
+  if (Send_Head < 0) {Send_Tail = -1;}
+  if (Urgent_Tail == n) {Urgent_Tail = -1;}
+  Put16(Data + Len, n); // Tag = place in pool
+  Put32(Data + Len + 2, P.Address);
+  Data[Len + 6] = P.Type;
+  Data[Len + 7] = P.Len;
+  memcpy(Data + Len + 8, P.Text, P.Len);
+  Len += 8 + P.Len;
+  if (P.Tries) {Resent++;}
+  P.Tries++;
+  P.State = PAGE_SENT;
+  Waiting--;
+  Sent++;
+  Batch[Batch_Count++] = n;
+  }
+Batches++;
+Send_Frame(Data, Len);
+}
+
+static void Batch_Done()
+// refused pages go back to head of send list in their order
+{
+if (Back_Head >= 0)
+  {
+  if (Urgent_Tail < 0) {for (int n = Back_Head; n >= 0; n = Page[n].Next) {if (Page[n].Type & PAGE_URGENT) {Urgent_Tail = n;}}}
+  Page[Back_Tail].Next = Send_Head;
+  if (Send_Head < 0) {Send_Tail = Back_Tail;}
+  Send_Head = Back_Head;
+  Back_Head = Back_Tail = -1;
+  }
+Batch_Count = 0;
+Wait_Cmd = 0;
+}
+
+static void Timeout()
+// no reply: pages of frame are sent again
+{
+Timeouts++;
+Silent++;
+if (Wait_Cmd == CMD_PAGES)
+  {
+  for (uint8_t i = 0; i < Batch_Count; i++)
+    {
+    int n = Batch[i];
+    if (Page[n].State != PAGE_SENT) {continue;}
+    Sent--;
+    if (Page[n].Tries >= GW_TRIES) {Fail(n, 0xFF); continue;}
+    Page[n].State = PAGE_WAITING;
+    Waiting++;
+    Append(Back_Head, Back_Tail, n);
+    }
+  Batch_Done();
+  }
+Wait_Cmd = 0;
+if (Silent >= GW_TRIES && Link != LINK_PING) // encoder is gone (reset), start again
+  {
+  fprintf(stderr, "gateway: no reply from encoder\n");
+  Link = LINK_PING;
+  }
+}
+
+static void Page_Reply(uint8_t Status, const uint8_t *Data, uint8_t Len)
+// Tag u16, ID u8, Groups u8, Saved u8
+{
+if (Len < 5) {return;}
+int n = Get16(Data);
+bool Found = false;
+for (uint8_t i = 0; i < Batch_Count; i++) {if (Batch[i] == n) {Found = true;}}
+if (!Found || Page[n].State != PAGE_SENT) {return;} // reply of old frame
+Batch_Replies++;
+Sent--;
+
+type_Gw_Page &P = Page[n];
+if (Status == PROTO_OK)
+  {
+  uint32_t ms = (Now - P.In_us) / 1000;
+  type_Client *C = Owner(P);
+  if (C) {Reply(*C, "ACK %lu %u %u %lu\n", (unsigned long)P.Ref, Data[2], Data[3], (unsigned long)ms);}
+  if (Verbose) {fprintf(stderr, "page %lu: ID %u, %u groups, %lu ms\n", (unsigned long)P.Ref, Data[2], Data[3], (unsigned long)ms);}
+  Acked++;
+  Add_Latency(Ack_Latency, ms);
+  if (Enc_Free) {Enc_Free--;}
+  if (!Monitor) {Release(n);}
+  else
+    {
+    if (ID_Page[Data[2]] >= 0) {Finish_Air(ID_Page[Data[2]], false);} // ID is used again, its trace was dropped
+    P.ID = Data[2];
+    P.State = PAGE_ENCODER;
+    ID_Page[P.ID] = n;
+    In_Encoder++;
+    }
+  }
+else if (Status == PROTO_FULL)
+  {
+  P.State = PAGE_WAITING;
+  P.Tries = 0;
+  Waiting++;
+  Append(Back_Head, Back_Tail, n);
+  Enc_Free = 0;
+  }
+else {Fail(n, Status);}
+
+if (Batch_Replies >= Batch_Count) {Batch_Done();}
+}
+
+static void Trace_Record(const uint8_t *Data)
+// Time u32, ID u8, Flags u8, Blocks A B C D: last 7A group of page
+{
+uint8_t ID = Data[4];
+uint16_t B = Get16(Data + 8);
+if ((B >> 11) != 14 || !(Data[5] & RECORD_LAST) || ID == 0 || ID_Page[ID] < 0) {return;} // 7A version A
+Finish_Air(ID_Page[ID], true);
+}
+
+static void Frame(const uint8_t *F)
+// LEN, CMD|0x80, STATUS, DATA
+{
+uint8_t Cmd = F[1] & 0x7F, Status = F[2], Len = F[0] - 2;
+const uint8_t *Data = F + 3;
+
+if (Cmd == CMD_TRACE) {if (Len >= 14) {Trace_Record(Data);} return;} // not a reply
+if (Cmd == PROTO_NAK) {if (Wait_Cmd) {Timeout();} return;}          // frame was broken on the way
+if (Cmd != Wait_Cmd) {return;}                                      // late reply
+Silent = 0;
+
+switch (Cmd)
+  {
+  case CMD_PING:
+    fprintf(stderr, "gateway: encoder answers, protocol %u\n", Len ? Data[0] : 0);
+    Link = Monitor ? LINK_SETUP : LINK_READY;
+    Status_Due = Stats_Due = Now;
+    Wait_Cmd = 0;
+    break;
+
+  case CMD_SET:
+    Link = LINK_READY;
+    Wait_Cmd = 0;
+    break;
+
+  case CMD_STATUS:
+    if (Len >= 12)
+      {
+      Enc_Waiting = Data[10];
+      Enc_Size = Data[11];
+      Enc_Free = (Enc_Size > Enc_Waiting) ? Enc_Size - Enc_Waiting : 0;
+      }
+    Wait_Cmd = 0;
+    break;
+
+  case CMD_STATS:
+    if (Status == PROTO_OK && Len >= 22)
+      {
+      uint16_t Overflows = Get16(Data + 10);
+      if (Enc_Stats && Overflows > Enc_Overflows) {Hold_Until = Now + GW_HOLD_MS * 1000ULL; Holds++;} // chip can't keep up
+      Enc_Errors = Get16(Data + 8);
+      Enc_Overflows = Overflows;
+      Enc_Underflows = Get16(Data + 12);
+      Enc_Dropped = Get16(Data + 16);
+      Enc_Bad = Get16(Data + 20);
+      Enc_Stats = true;
+      }
+    Wait_Cmd = 0;
+    break;
+
+  case CMD_PAGES:
+    Page_Reply(Status, Data, Len);
+    break;
+  }
+}
+
+static void Serial_Input(const uint8_t *Buf, size_t Got)
+// frames with right CRC, other bytes are text of encoder (menu, messages)
+{
+for (size_t i = 0; i < Got; i++)
+  {
+  Rx[Rx_Len++] = Buf[i];
+  while (Rx_Len)
+    {
+    bool Text = (Rx[0] != FRAME_SYNC) || (Rx_Len >= 2 && (Rx[1] < 2 || Rx[1] > REPLY_MAX));
+    if (!Text && (Rx_Len < 2 || Rx_Len < (size_t)Rx[1] + 4u)) {break;} // frame is not complete
+    if (!Text && CRC16(Rx + 1, Rx[1] + 1) == Get16(Rx + Rx[1] + 2))
+      {
+      Frame(Rx + 1);
+      Rx_Len = 0;
+      break;
+      }
+    if (Verbose) {fputc(Rx[0], stderr);} // SYNC was text
+    memmove(Rx, Rx + 1, --Rx_Len);
+    }
+  }
+}
+
+static void Link_Run()
+// next frame to encoder when no reply is waited for
+{
+if (Wait_Cmd && Now - Wait_Since < GW_REPLY_MS * 1000ULL) {return;}
+if (Wait_Cmd) {Timeout();}
+
+if (Link == LINK_PING)
+  {
+  if (Now < Next_Ping) {return;}
+  uint8_t Ping = CMD_PING;
+  Next_Ping = Now + GW_PING_MS * 1000ULL;
+  Send_Frame(&Ping, 1);
+  return;
+  }
+if (Link == LINK_SETUP)
+  {
+  uint8_t Set[6] = {CMD_SET, SET_MONITOR};
+  Put32(Set + 2, 1);
+  Send_Frame(Set, 6);
+  return;
+  }
+
+if (Now >= Stats_Due)
+  {
+  uint8_t Stats[2] = {CMD_STATS, 0};
+  Stats_Due = Now + GW_STATS_MS * 1000ULL;
+  Send_Frame(Stats, 2);
+  }
+else if (Send_Head >= 0 && Enc_Free && Now >= Hold_Until) {Send_Batch();}
+else if (Now >= Status_Due)
+  {
+  uint8_t Status = CMD_STATUS;
+  Status_Due = Now + (Send_Head >= 0 ? GW_POLL_MS : GW_IDLE_MS) * 1000ULL;
+  Send_Frame(&Status, 1);
+  }
+}
+
+static pid_t Open_Encoder(const char *Port, const char *Exec)
+// serial port of encoder, or command on a new pty; return child pid (0 = none, -1 = error)
+{
+struct termios Raw;
+pid_t Child = 0;
+
+if (Port)
+  {
+  if ((Serial = open(Port, O_RDWR | O_NOCTTY | O_NONBLOCK)) < 0) {perror(Port); return -1;}
+  if (tcgetattr(Serial, &Raw) == 0)
+    {
+    cfmakeraw(&Raw);
+    cfsetispeed(&Raw, B57600);
+    cfsetospeed(&Raw, B57600);
+    Raw.c_cflag |= CLOCAL | CREAD;
+    tcsetattr(Serial, TCSANOW, &Raw);
+    }
+  return 0;
+  }
+
+int Slave;
+if ((Serial = posix_openpt(O_RDWR | O_NOCTTY)) < 0 || grantpt(Serial) || unlockpt(Serial)) {perror("pty"); return -1;}
+if ((Slave = open(ptsname(Serial), O_RDWR | O_NOCTTY)) < 0) {perror("pty"); return -1;}
+if (tcgetattr(Slave, &Raw) == 0) {cfmakeraw(&Raw); tcsetattr(Slave, TCSANOW, &Raw);} // binary frames, no echo
+if ((Child = fork()) < 0) {perror("fork"); return -1;}
+if (Child == 0)
+  {
+  setsid(); // Ctrl-C goes to the gateway, encoder ends with the pty
+  dup2(Slave, 0);
+  dup2(Slave, 1);
+  close(Slave);
+  close(Serial);
+  execl("/bin/sh", "sh", "-c", Exec, (char *)NULL);
+  _exit(127);
+  }
+close(Slave);
+fcntl(Serial, F_SETFL, fcntl(Serial, F_GETFL) | O_NONBLOCK);
+return Child;
+}
+
+// -------------------------------------------------------- Daemon
+static int Run_Gateway(const char *Port, const char *Exec, const char *Socket_Name, const char *Pipe_Name, uint32_t Report_s)
+{
+int Listen = -1, Pipe_Keep = -1;
+struct epoll_event Events[32];
+sigset_t Signals;
+
+if (!(Page = (type_Gw_Page *)calloc(Pages_Max, sizeof(type_Gw_Page)))) {perror("pages"); return 1;}
+for (int n = Pages_Max - 1; n >= 0; n--) {Release(n);}
+for (int i = 0; i < 256; i++) {ID_Page[i] = -1;}
+for (int i = 0; i < GW_CLIENTS; i++) {Client[i].Fd = -1;}
+Pipe.Fd = -1;
+Epoll = epoll_create1(0);
+
+sigemptyset(&Signals);
+sigaddset(&Signals, SIGINT);
+sigaddset(&Signals, SIGTERM);
+sigprocmask(SIG_BLOCK, &Signals, NULL);
+signal(SIGPIPE, SIG_IGN);
+int Signal_Fd = signalfd(-1, &Signals, SFD_NONBLOCK);
+Watch(Signal_Fd, KIND_SIGNAL, 0, EPOLLIN, EPOLL_CTL_ADD);
+
+pid_t Child = Open_Encoder(Port, Exec);
+if (Child < 0) {return 1;}
+Watch(Serial, KIND_SERIAL, 0, EPOLLIN, EPOLL_CTL_ADD);
+
+if (Socket_Name)
+  {
+  struct sockaddr_un Addr;
+  memset(&Addr, 0, sizeof(Addr));
+  Addr.sun_family = AF_UNIX;
+  strncpy(Addr.sun_path, Socket_Name, sizeof(Addr.sun_path) - 1);
+  unlink(Socket_Name); // socket of last run
+  Listen = socket(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK, 0);
+  if (bind(Listen, (struct sockaddr *)&Addr, sizeof(Addr)) || listen(Listen, 16)) {perror(Socket_Name); return 1;}
+  Watch(Listen, KIND_LISTEN, 0, EPOLLIN, EPOLL_CTL_ADD);
+  }
+if (Pipe_Name)
+  {
+  if (mkfifo(Pipe_Name, 0660) && errno != EEXIST) {perror(Pipe_Name); return 1;}
+  if ((Pipe.Fd = open(Pipe_Name, O_RDONLY | O_NONBLOCK)) < 0) {perror(Pipe_Name); return 1;}
+  Pipe_Keep = open(Pipe_Name, O_WRONLY); // no EOF when writers close
+  Watch(Pipe.Fd, KIND_PIPE, 0, EPOLLIN, EPOLL_CTL_ADD);
+  }
+fprintf(stderr, "gateway: %u pages, encoder %s%s%s%s%s\n", Pages_Max, Port ? Port : Exec, Socket_Name ? ", socket " : "",
+        Socket_Name ? Socket_Name : "", Pipe_Name ? ", pipe " : "", Pipe_Name ? Pipe_Name : "");
+
+int Exit = 0;
+bool Running = true;
+unsigned long long Next_Report = Now_us() + Report_s * 1000000ULL;
+while (Running)
+  {
+  int Count = epoll_wait(Epoll, Events, 32, 10); // 10 ms: timeouts and polls of encoder
+  Now = Now_us();
+  for (int e = 0; e < Count; e++)
+    {
+    uint32_t Kind = Events[e].data.u64 >> 32, i = (uint32_t)Events[e].data.u64;
+    switch (Kind)
+      {
+      case KIND_LISTEN:
+        {
+        int Fd;
+        while ((Fd = accept4(Listen, NULL, NULL, SOCK_NONBLOCK)) >= 0)
+          {
+          int Free = -1;
+          for (int c = 0; c < GW_CLIENTS; c++) {if (Client[c].Fd < 0) {Free = c; break;}}
+          if (Free < 0) {const char *Full = "ERR too many clients\n"; send(Fd, Full, strlen(Full), MSG_NOSIGNAL); close(Fd); continue;}
+          type_Client &C = Client[Free];
+          C.Fd = Fd;
+          C.Gen = ++Client_Gen;
+          C.In_Len = C.Out_Len = 0;
+          C.Out_Wait = false;
+          Watch(Fd, KIND_CLIENT, Free, EPOLLIN, EPOLL_CTL_ADD);
+          }
+        break;
+        }
+
+      case KIND_CLIENT:
+        if (Client[i].Fd < 0) {break;}
+        if (Events[e].events & EPOLLOUT) {Flush_Client(i);}
+        if (Client[i].Fd >= 0 && (Events[e].events & (EPOLLIN | EPOLLHUP | EPOLLERR)) && !Input(Client[i], Client[i].Fd))
+          {Close_Client(i);}
+        break;
+
+      case KIND_PIPE:
+        Input(Pipe, Pipe.Fd);
+        break;
+
+      case KIND_SERIAL:
+        {
+        if (Events[e].events & EPOLLOUT) {Serial_Flush();}
+        if (!(Events[e].events & (EPOLLIN | EPOLLHUP | EPOLLERR))) {break;}
+        uint8_t Buf[1024];
+        ssize_t Got = read(Serial, Buf, sizeof(Buf));
+        if (Got > 0) {Serial_Input(Buf, Got);}
+        else if (Got == 0 || (errno != EAGAIN && errno != EINTR))
+          {
+          fprintf(stderr, "gateway: encoder port closed\n");
+          Running = false;
+          Exit = 1;
+          }
+        break;
+        }
+
+      case KIND_SIGNAL:
+        Running = false;
+        break;
+      }
+    }
+  Link_Run();
+
+  if (Report_s && Now >= Next_Report)
+    {
+    char Out[600];
+    Stats_Line(Out, sizeof(Out));
+    fprintf(stderr, "gateway: %s\n", Out);
+    Next_Report = Now + Report_s * 1000000ULL;
+    }
+  }
+
+char Out[600];
+Stats_Line(Out, sizeof(Out));
+fprintf(stderr, "gateway: %s\n", Out);
+for (int i = 0; i < GW_CLIENTS; i++) {if (Client[i].Fd >= 0) {Close_Client(i);}}
+if (Listen >= 0) {close(Listen); unlink(Socket_Name);}
+if (Pipe.Fd >= 0) {close(Pipe.Fd); close(Pipe_Keep);}
+close(Serial); // encoder of -e ends with EIO
+if (Child > 0)
+  {
+  int Status = 0;
+  waitpid(Child, &Status, 0);
+  if (!WIFEXITED(Status) || WEXITSTATUS(Status)) {fprintf(stderr, "gateway: encoder command failed\n"); Exit = 1;}
+  }
+free(Page);
+return Exit;
+}
+
+// -------------------------------------------------------- Test client
+static int Run_Client(const char *Socket_Name, uint32_t Pages, uint32_t Rate, int Type, uint8_t Len, bool Wait_Air)
+// Pages lines at Rate/s (0 = as fast as socket takes them), BUSY lines are sent again after 50 ms
+{
+static const char *Symbols[] = {"", "0123456789", "0123456789", "ABCDEFGHIJKLMNOPQRSTUVWXYZ 0123456789", "0123456789", "0123456789ABCDEF"};
+struct sockaddr_un Addr;
+memset(&Addr, 0, sizeof(Addr));
+Addr.sun_family = AF_UNIX;
+strncpy(Addr.sun_path, Socket_Name, sizeof(Addr.sun_path) - 1);
+int Fd = socket(AF_UNIX, SOCK_STREAM, 0);
+if (connect(Fd, (struct sockaddr *)&Addr, sizeof(Addr))) {perror(Socket_Name); return 1;}
+fcntl(Fd, F_SETFL, fcntl(Fd, F_GETFL) | O_NONBLOCK);
+
+uint32_t *Retry = (uint32_t *)calloc(Pages, sizeof(uint32_t)); // ring of page numbers to send again
+uint32_t *Line_Page = (uint32_t *)calloc(Pages, sizeof(uint32_t)); // page of each line waiting for first reply
+static type_Latency Ack, Air;
+uint32_t Next = 0, Retries = 0, Retry_Pos = 0, Lines = 0, Answered = 0, Queued = 0, Acks = 0, Airs = 0, Fails = 0, Busys = 0, Done = 0;
+char In[4096], Out[GW_LINE + 2];
+size_t In_Len = 0, Out_Len = 0, Out_Pos = 0;
+unsigned long long Start = Now_us(), Pause = 0, Last_Progress = Start;
+
+while ((Wait_Air ? Airs + Done : Acks) + Fails < Pages)
+  {
+  Now = Now_us();
+  if (Now - Last_Progress > 30000000ULL) {fprintf(stderr, "client: no progress for 30 s\n"); break;}
+  if (Out_Pos == Out_Len && Now >= Pause && (Retry_Pos < Retries || Next < Pages) && Lines - Answered < Pages &&
+      (Rate == 0 || Next * 1000000ULL / Rate <= Now - Start))
+    {
+    uint32_t n = (Retry_Pos < Retries) ? Retry[Retry_Pos++ % Pages] : Next++;
+    char Text[TEXT_MAX + 1];
+    uint8_t Text_Len = Type ? Len : 0;
+    for (uint8_t i = 0; i < Text_Len; i++) {Text[i] = Symbols[Type][(n + i) % strlen(Symbols[Type])];}
+    Text[Text_Len] = 0;
+    Out_Len = snprintf(Out, sizeof(Out), "PAGE %lu %s %s\n", 100000UL + n % 900000UL, Type_Name[Type], Text);
+    Out_Pos = 0;
+    Line_Page[Lines++ % Pages] = n;
+    }
+  if (Out_Pos < Out_Len)
+    {
+    ssize_t Done_Bytes = send(Fd, Out + Out_Pos, Out_Len - Out_Pos, MSG_NOSIGNAL);
+    if (Done_Bytes > 0) {Out_Pos += Done_Bytes;}
+    else if (errno != EAGAIN && errno != EINTR) {perror("send"); break;}
+    }
+
+  struct pollfd Wait = {Fd, POLLIN, 0};
+  poll(&Wait, 1, (Out_Pos < Out_Len || (Rate == 0 && Next < Pages && Now >= Pause)) ? 0 : 5);
+  ssize_t Got = read(Fd, In + In_Len, sizeof(In) - In_Len);
+  if (Got == 0) {fprintf(stderr, "client: gateway closed connection\n"); break;}
+  if (Got < 0) {continue;}
+  In_Len += Got;
+
+  char *Line = In, *End;
+  while ((End = (char *)memchr(Line, '\n', In + In_Len - Line)))
+    {
+    *End = 0;
+    unsigned long Ref, ms;
+    unsigned int ID, Groups;
+    Last_Progress = Now;
+    if (strncmp(Line, "QUEUED ", 7) == 0) {Queued++; Answered++;}
+    else if (strcmp(Line, "BUSY") == 0) {Busys++; Retry[Retries++ % Pages] = Line_Page[Answered++ % Pages]; Pause = Now + 50000;}
+    else if (strncmp(Line, "ERR ", 4) == 0) {fprintf(stderr, "client: %s\n", Line); Fails++; Answered++;}
+    else if (sscanf(Line, "ACK %lu %u %u %lu", &Ref, &ID, &Groups, &ms) == 4) {Acks++; Add_Latency(Ack, ms);}
+    else if (sscanf(Line, "AIR %lu %lu", &Ref, &ms) == 2) {Airs++; Add_Latency(Air, ms);}
+    else if (strncmp(Line, "DONE ", 5) == 0) {Done++;}
+    else if (strncmp(Line, "FAIL ", 5) == 0) {fprintf(stderr, "client: %s\n", Line); Fails++;}
+    Line = End + 1;
+    }
+  In_Len -= Line - In;
+  memmove(In, Line, In_Len);
+  }
+
+double Seconds = (Now_us() - Start) / 1e6;
+char Text[200];
+printf("client: pages %lu, queued %lu, acked %lu, aired %lu, untraced %lu, failed %lu, busy %lu, %.1f s, %.0f pages/min\n",
+       (unsigned long)Pages, (unsigned long)Queued, (unsigned long)Acks, (unsigned long)Airs, (unsigned long)Done,
+       (unsigned long)Fails, (unsigned long)Busys, Seconds, (Wait_Air ? Airs + Done : Acks) * 60 / Seconds);
+Print_Latency(Text, sizeof(Text), "ack", Ack);
+printf("client: %s\n", Text);
+if (Wait_Air) {Print_Latency(Text, sizeof(Text), "air", Air); printf("client: %s\n", Text);}
+close(Fd);
+free(Retry);
+free(Line_Page);
+return (Fails || (Wait_Air ? Airs + Done : Acks) < Pages) ? 1 : 0;
+}
+
+// -------------------------------------------------------- Main
+int main(int argc, char **argv)
+{
+const char *Port = NULL, *Exec = NULL, *Socket_Name = NULL, *Pipe_Name = NULL, *Connect = NULL;
+uint32_t Report_s = 10, Pages = 1000, Rate = 0;
+int Type = 3;
+uint8_t Len = 40;
+bool Wait_Air = false;
+
+for (int a = 1; a < argc; a++)
+  {
+  const char *Value = (a + 1 < argc) ? argv[a + 1] : "";
+  if (strcmp(argv[a], "-d") == 0) {Port = Value; a++;}
+  else if (strcmp(argv[a], "-e") == 0) {Exec = Value; a++;}
+  else if (strcmp(argv[a], "-u") == 0) {Socket_Name = Value; a++;}
+  else if (strcmp(argv[a], "-f") == 0) {Pipe_Name = Value; a++;}
+  else if (strcmp(argv[a], "-q") == 0) {Pages_Max = strtoul(Value, NULL, 10); a++;}
+  else if (strcmp(argv[a], "-i") == 0) {Report_s = strtoul(Value, NULL, 10); a++;}
+  else if (strcmp(argv[a], "-m") == 0) {Monitor = true;}
+  else if (strcmp(argv[a], "-v") == 0) {Verbose = true;}
+  else if (strcmp(argv[a], "-c") == 0) {Connect = Value; a++;}
+  else if (strcmp(argv[a], "-n") == 0) {Pages = strtoul(Value, NULL, 10); a++;}
+  else if (strcmp(argv[a], "-r") == 0) {Rate = strtoul(Value, NULL, 10); a++;}
+  else if (strcmp(argv[a], "-t") == 0) {Type = strtol(Value, NULL, 10); a++;}
+  else if (strcmp(argv[a], "-l") == 0) {Len = strtoul(Value, NULL, 10); a++;}
+  else if (strcmp(argv[a], "-w") == 0) {Wait_Air = true;}
+  else {Connect = Port = Exec = NULL; break;}
+  }
+
+if (Connect)
+  {
+  if (Type < 0 || Type > 5 || Len > TEXT_MAX || Pages == 0) {fprintf(stderr, "type 0..5, length 0..%u, pages > 0\n", TEXT_MAX); return 2;}
+  return Run_Client(Connect, Pages, Rate, Type, Len, Wait_Air);
+  }
+if (!Port == !Exec || (!Socket_Name && !Pipe_Name) || Pages_Max == 0 || Pages_Max > 65535)
+  {
+  fprintf(stderr, "Usage: %s (-d tty | -e command) [-u socket] [-f fifo] [-q pages 1..65535] [-m] [-i seconds] [-v]\n"
+                  "       %s -c socket [-n pages] [-r pages/s] [-t type] [-l length] [-w]\n", argv[0], argv[0]);
+  return 2;
+  }
+return Run_Gateway(Port, Exec, Socket_Name, Pipe_Name, Report_s);
+}
@@ -0,0 +1,224 @@
+/*  Arduino and Wire stand-in for Linux host build (implementation)
+*/
+
+#include <time.h>
+#include <unistd.h>
+#include <new>
+#include <malloc.h>
+#include "Arduino.h"
+#include "Wire.h"
+
+HardwareSerial Serial;
+TwoWire Wire;
+unsigned long Host_Allocs = 0;
+unsigned long Host_Heap = 0;
+unsigned long Host_Heap_Peak = 0;
+
+// -------------------------------------------------------- Time
+static unsigned long long HostClock()
+// monotonic time in microseconds
+{
+struct timespec Now;
+clock_gettime(CLOCK_MONOTONIC, &Now);
+return (unsigned long long)Now.tv_sec * 1000000ULL + Now.tv_nsec / 1000;
+}
+
+static const unsigned long long Host_Start = HostClock();
+
+bool Host_Virtual = false;
+unsigned long long Host_Time_us = 0;
+unsigned int Host_Read_us = 1;
+
+static unsigned long long HostTime()
+{
+if (!Host_Virtual) {return HostClock() - Host_Start;}
+Host_Time_us += Host_Read_us; // spin loops on millis() go on
+return Host_Time_us;
+}
+
+unsigned long micros() {return (unsigned long)HostTime();}
+unsigned long millis() {return (unsigned long)(HostTime() / 1000);}
+void delay(unsigned long ms) {if (Host_Virtual) {Host_Advance(ms * 1000);} else {usleep(ms * 1000);}}
+void delayMicroseconds(unsigned int us) {if (Host_Virtual) {Host_Advance(us);} else {usleep(us);}}
+
+// -------------------------------------------------------- Heap counters
+void *Host_Realloc(void *Ptr, size_t Size)
+// usable size of block is counted, as the allocator really keeps it
+{
+Host_Allocs++;
+size_t Old = Ptr ? malloc_usable_size(Ptr) : 0;
+void *New = realloc(Ptr, Size);
+if (!New) {return NULL;}
+Host_Heap += malloc_usable_size(New) - Old;
+if (Host_Heap > Host_Heap_Peak) {Host_Heap_Peak = Host_Heap;}
+return New;
+}
+
+void Host_Free(void *Ptr)
+{
+if (!Ptr) {return;}
+Host_Heap -= malloc_usable_size(Ptr);
+free(Ptr);
+}
+
+void *operator new (size_t Size)
+{
+void *Ptr = Host_Realloc(NULL, Size ? Size : 1);
+if (!Ptr) {throw std::bad_alloc();}
+return Ptr;
+}
+
+void *operator new[] (size_t Size) {return operator new (Size);}
+void operator delete (void *Ptr) noexcept {Host_Free(Ptr);}
+void operator delete[] (void *Ptr) noexcept {Host_Free(Ptr);}
+void operator delete (void *Ptr, size_t) noexcept {Host_Free(Ptr);}
+void operator delete[] (void *Ptr, size_t) noexcept {Host_Free(Ptr);}
+
+// -------------------------------------------------------- String
+void String::Reserve(unsigned int Size)
+{
+if (Size < Cap && Buf) {return;}
+char *New = (char *)Host_Realloc(Buf, Size + 1);
+if (!New) {return;}
+Buf = New;
+Cap = Size + 1;
+}
+
+void String::Copy(const char *Text, unsigned int Size)
+{
+Reserve(Size);
+memmove(Buf, Text, Size);
+Len = Size;
+Buf[Len] = 0;
+}
+
+void String::Concat(const char *Text, unsigned int Size)
+{
+if (!Size) {return;}
+Reserve(Len + Size);
+memmove(Buf + Len, Text, Size);
+Len += Size;
+Buf[Len] = 0;
+}
+
+void String::Number(unsigned long Value, uint8_t Base)
+{
+char Tmp[34];
+snprintf(Tmp, sizeof(Tmp), Base == HEX ? "%lx" : "%lu", Value);
+Copy(Tmp, strlen(Tmp));
+}
+
+void String::Number(long Value, uint8_t Base)
+{
+if (Base == HEX) {Number((unsigned long)Value, Base); return;}
+char Tmp[34];
+snprintf(Tmp, sizeof(Tmp), "%ld", Value);
+Copy(Tmp, strlen(Tmp));
+}
+
+void String::trim()
+{
+unsigned int From = 0;
+while (From < Len && isspace(Buf[From])) {From++;}
+while (Len > From && isspace(Buf[Len - 1])) {Len--;}
+if (Buf) {memmove(Buf, Buf + From, Len - From); Len -= From; Buf[Len] = 0;}
+}
+
+void String::toCharArray(char *Out, unsigned int Size) const
+{
+if (!Size) {return;}
+unsigned int n = Len < Size - 1 ? Len : Size - 1;
+memcpy(Out, c_str(), n);
+Out[n] = 0;
+}
+
+String String::substring(unsigned int From, unsigned int To) const
+{
+if (From > To) {unsigned int Tmp = From; From = To; To = Tmp;}
+if (From >= Len) {return String();}
+if (To > Len) {To = Len;}
+String Out;
+Out.Copy(Buf + From, To - From);
+return Out;
+}
+
+String operator + (const String &Left, const String &Right) {String Out(Left); Out += Right; return Out;}
+String operator + (const String &Left, const char *Right) {String Out(Left); Out += Right; return Out;}
+String operator + (const char *Left, const String &Right) {String Out(Left); Out += Right; return Out;}
+String operator + (const String &Left, char Right) {String Out(Left); Out += Right; return Out;}
+
+// -------------------------------------------------------- Serial
+void HardwareSerial::Feed(const void *Data, size_t Size)
+{
+if (In_Pos > 0) // unread bytes to start of buffer
+  {
+  memmove(In, In + In_Pos, In_Len - In_Pos);
+  In_Len -= In_Pos;
+  In_Pos = 0;
+  }
+if (Size > Rx_Size - In_Len) {Overruns += Size - (Rx_Size - In_Len); Size = Rx_Size - In_Len;}
+memcpy(In + In_Len, Data, Size);
+In_Len += Size;
+}
+
+// -------------------------------------------------------- Wire
+size_t TwoWire::write(uint8_t Data)
+{
+if (Count < sizeof(Tx)) {Tx[Count++] = Data;}
+Log[Written % HOST_WIRE_LOG] = Data;
+Written++;
+Hash = (Hash ^ Data) * 16777619UL;
+return 1;
+}
+
+HostDevice *TwoWire::Find(uint8_t Address)
+{
+for (HostDevice *Device = Devices; Device; Device = Device->Next) {if (Device->Address == Address) {return Device;}}
+return NULL;
+}
+
+void TwoWire::Transfer(uint8_t Bytes)
+// address byte + data bytes, 9 clocks each
+{
+if (Host_Virtual) {Host_Advance(((Bytes + 1) * 9UL * 1000000UL + Clock - 1) / Clock);}
+}
+
+uint8_t TwoWire::endTransmission(bool)
+{
+Transfers++;
+if (Trace)
+  {
+  for (uint8_t i = 0; i < Count; i++) {fprintf(Trace, "%02X", Tx[i]);}
+  fputc('\n', Trace);
+  }
+if (Devices)
+  {
+  Transfer(Count);
+  HostDevice *Device = Find(Target);
+  return Device ? Device->Write(Tx, Count) : 2; // 2 = NACK on address
+  }
+return 0; // ACK
+}
+
+uint8_t TwoWire::requestFrom(uint8_t Address, uint8_t Size)
+{
+if (Size > sizeof(Rx)) {Size = sizeof(Rx);}
+memset(Rx, 0, sizeof(Rx));
+if (Devices)
+  {
+  Transfer(Size);
+  HostDevice *Device = Find(Address);
+  RxLen = Device ? Device->Read(Rx, Size) : 0;
+  RxPos = 0;
+  return RxLen;
+  }
+Rx[0] = 0x80; // CTS
+if (Count && Tx[0] == 0x35) // TX_RDS_BUFF: FIFO is empty
+  {
+  Rx[4] = HOST_FIFO_SIZE;
+  Rx[5] = 0;
+  }
+RxLen = Size;
+RxPos = 0;
+return Size;
+}
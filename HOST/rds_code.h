@@ -0,0 +1,64 @@
+/*  RDS block code: 10 bits checkword and offset words
+ *
+ *  Block = 16 bits information + 10 bits (CRC ^ offset), sent MSB first.
+ *  Generator polynomial g(x) = x^10 + x^8 + x^7 + x^5 + x^4 + x^3 + 1
+*/
+
+#ifndef HOST_RDS_CODE_H
+#define HOST_RDS_CODE_H
+
+#include <stdint.h>
+
+#define RDS_BIT_RATE 1187.5  // bit/s = 57000 / 48
+#define RDS_CARRIER 57000    // Hz
+#define RDS_GROUP_BITS 104   // 4 blocks * 26 bits
+#define RDS_BLOCK_BITS 26
+#define RDS_POLY 0x5B9       // g(x), bit n = x^n
+
+// Offset words
+#define RDS_OFFSET_A 0x0FC
+#define RDS_OFFSET_B 0x198
+#define RDS_OFFSET_C 0x168
+#define RDS_OFFSET_C2 0x350 // C' for version B groups
+#define RDS_OFFSET_D 0x1B4
+
+inline uint16_t RDS_CHECKWORD(uint16_t Data)
+// 10 bits CRC of information word (remainder of Data * x^10 / g(x))
+{
+uint32_t Reg = (uint32_t)Data << 10;
+for (int8_t i = 25; i >= 10; i--)
+  {
+  if (Reg & (1UL << i)) {Reg ^= (uint32_t)RDS_POLY << (i - 10);}
+  }
+return Reg & 0x3FF;
+}
+
+inline uint16_t RDS_SYNDROME(uint32_t Block)
+// Remainder of 26 bits block / g(x): equal to offset word when block has no errors
+{
+for (int8_t i = 25; i >= 10; i--)
+  {
+  if (Block & (1UL << i)) {Block ^= (uint32_t)RDS_POLY << (i - 10);}
+  }
+return Block & 0x3FF;
+}
+
+inline uint16_t RDS_GROUP_OFFSET(const uint16_t *Group, uint8_t Block)
+// Offset word for block 0..3 of group {A,B,C,D}; C' when group is version B (bit 11 of block B)
+{
+switch (Block)
+  {
+  case 0: return RDS_OFFSET_A;
+  case 1: return RDS_OFFSET_B;
+  case 2: return ((Group[1] >> 11) & 1) ? RDS_OFFSET_C2 : RDS_OFFSET_C;
+  default: return RDS_OFFSET_D;
+  }
+}
+
+inline uint32_t RDS_BLOCK(uint16_t Data, uint16_t Offset)
+// 26 bits block: information word and checkword with offset
+{
+return ((uint32_t)Data << 10) | (RDS_CHECKWORD(Data) ^ Offset);
+}
+
+#endif
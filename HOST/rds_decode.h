@@ -0,0 +1,435 @@
+/*  RDS bits -> blocks -> groups -> decoded 0A/1A/2A/4A/7A information
+ *
+ *  BlockSync: syndrome check of every 26 bits window until two blocks with right distance and order
+ *  are found, then one block every 26 bits; burst errors up to 5 bits are corrected.
+ *  GroupDecoder: prints decoded groups and reassembles paging messages (inverse of RDS_7A_COMPILE),
+ *  Page_Sink gets each message (chipsim matches it with submitted pages), Quiet = nothing is printed.
+*/
+
+#ifndef HOST_RDS_DECODE_H
+#define HOST_RDS_DECODE_H
+
+#include <stdio.h>
+#include <stdarg.h>
+#include <string.h>
+#include "rds_code.h"
+
+#ifndef TONE // message types as in config.h
+#define TONE  0
+#define DIG10 1
+#define DIG18 2
+#define ALPHA 3
+#define VARNUM 4
+#define FUNC  5
+#endif
+
+#define SYNC_BURST 5        // max length of corrected burst error
+#define SYNC_LOST 10        // bad blocks in a row to lose sync
+
+typedef void (*type_Group_Sink)(const uint16_t *Group, uint8_t Valid, void *Arg); // Valid: bit n = block n is good
+
+// -------------------------------------------------------- Block sync
+class BlockSync
+{
+  public:
+    uint32_t Blocks = 0;      // blocks received in sync
+    uint32_t Corrected = 0;   // blocks with corrected errors
+    uint32_t Bad = 0;         // uncorrectable blocks
+    uint32_t Groups = 0;      // groups sent to sink
+    uint32_t Lost = 0;        // sync losses
+
+    void Begin(type_Group_Sink Sink, void *Arg);
+    void Bit(uint8_t Bit);
+    static void BitSink(uint8_t Bit, void *Arg) {((BlockSync *)Arg)->Bit(Bit);} // for Demodulator
+
+  private:
+    type_Group_Sink Sink = NULL;
+    void *Sink_Arg = NULL;
+    uint32_t Burst[1024];     // syndrome of error -> error pattern
+    uint32_t Reg = 0;         // last 26 bits
+    uint32_t Count = 0;       // bits received
+    bool Synced = false;
+    uint8_t Next = 0;         // expected block 0..3
+    uint8_t Left = 0;         // bits to end of block
+    uint8_t Bad_Run = 0;
+    uint32_t Found_Pos = 0;   // last block found without sync
+    int8_t Found_Block = -1;
+    uint16_t Group[4];
+    uint8_t Valid = 0;
+
+    static int8_t OffsetBlock(uint16_t Syndrome); // block number of offset word, -1 if none
+    void Block(uint8_t Number, uint16_t Data, bool Good);
+};
+
+void BlockSync::Begin(type_Group_Sink Group_Sink, void *Arg)
+{
+Sink = Group_Sink;
+Sink_Arg = Arg;
+memset(Burst, 0, sizeof(Burst));
+for (uint8_t Len = SYNC_BURST; Len >= 1; Len--) // short bursts win
+  {
+  for (uint32_t Inner = 0; Inner < (Len > 2 ? 1UL << (Len - 2) : 1); Inner++)
+    {
+    uint32_t Pattern = (Len == 1) ? 1 : ((1UL << (Len - 1)) | (Inner << 1) | 1);
+    for (uint8_t Shift = 0; Shift + Len <= RDS_BLOCK_BITS; Shift++)
+      {
+      uint32_t Error = Pattern << Shift;
+      Burst[RDS_SYNDROME(Error)] = Error;
+      }
+    }
+  }
+Reg = 0;
+Count = 0;
+Synced = false;
+Found_Block = -1;
+Valid = 0;
+}
+
+int8_t BlockSync::OffsetBlock(uint16_t Syndrome)
+{
+switch (Syndrome)
+  {
+  case RDS_OFFSET_A: return 0;
+  case RDS_OFFSET_B: return 1;
+  case RDS_OFFSET_C: case RDS_OFFSET_C2: return 2;
+  case RDS_OFFSET_D: return 3;
+  }
+return -1;
+}
+
+void BlockSync::Bit(uint8_t Bit)
+{
+Reg = ((Reg << 1) | Bit) & 0x3FFFFFF;
+Count++;
+
+if (!Synced) // search two blocks in right order
+  {
+  if (Count < RDS_BLOCK_BITS) {return;}
+  int8_t Number = OffsetBlock(RDS_SYNDROME(Reg));
+  if (Number < 0) {return;}
+  uint32_t Distance = Count - Found_Pos;
+  if (Found_Block >= 0 && Distance % RDS_BLOCK_BITS == 0 && Distance <= 4 * RDS_BLOCK_BITS &&
+      (Found_Block + Distance / RDS_BLOCK_BITS) % 4 == (uint32_t)Number)
+    {
+    Synced = true;
+    Bad_Run = 0;
+    Valid = 0;
+    Next = Number;
+    Left = 0;
+    }
+  else
+    {
+    Found_Pos = Count;
+    Found_Block = Number;
+    return;
+    }
+  }
+else if (--Left) {return;}
+
+// end of block in sync
+uint8_t Number = Next;
+uint16_t Syndrome = RDS_SYNDROME(Reg);
+uint16_t Offset = RDS_GROUP_OFFSET(Group, Number);
+if (Number == 2 && (Syndrome == RDS_OFFSET_C || Syndrome == RDS_OFFSET_C2)) {Offset = Syndrome;} // C or C'
+uint16_t Error = Syndrome ^ Offset;
+bool Good = true;
+Blocks++;
+if (Error)
+  {
+  if (Burst[Error])
+    {
+    Reg ^= Burst[Error];
+    Corrected++;
+    }
+  else
+    {
+    Good = false;
+    Bad++;
+    }
+  }
+Block(Number, Reg >> 10, Good);
+
+Next = (Next + 1) & 3;
+Left = RDS_BLOCK_BITS;
+Bad_Run = Good ? 0 : Bad_Run + 1;
+if (Bad_Run >= SYNC_LOST)
+  {
+  Synced = false;
+  Lost++;
+  Found_Block = -1;
+  }
+}
+
+void BlockSync::Block(uint8_t Number, uint16_t Data, bool Good)
+{
+if (Number == 0) {Valid = 0;}
+Group[Number] = Data;
+if (Good) {Valid |= 1 << Number;}
+if (Number == 3 && Valid)
+  {
+  Groups++;
+  if (Sink) {Sink(Group, Valid, Sink_Arg);}
+  }
+}
+
+// -------------------------------------------------------- Group decoder
+inline void RDS_4A_DATE(const uint16_t *G, long &Year, long &Month, long &Day)
+// MJD of 4A group to date (IEC 62106 annex G)
+{
+long MJD = ((long)(G[1] & 3) << 15) | (G[2] >> 1);
+long Y1 = (long)((MJD - 15078.2) / 365.25);
+long M1 = (long)((MJD - 14956.1 - (long)(Y1 * 365.25)) / 30.6001);
+long K = (M1 == 14 || M1 == 15) ? 1 : 0;
+Day = MJD - 14956 - (long)(Y1 * 365.25) - (long)(M1 * 30.6001);
+Month = M1 - 1 - K * 12;
+Year = 1900 + Y1 + K;
+}
+
+typedef struct
+{
+  uint32_t Address;          // ggnnnn
+  uint8_t Type;              // TONE, DIG10, DIG18, ALPHA, VARNUM, FUNC
+  uint8_t ABflag;
+  uint8_t X1X2;              // alpha and variable-length: message type, repeat flag, call counter
+  char Text[96];
+  char Psac[24];             // psac sequence as hex digits
+  uint8_t Len;
+  uint8_t Next_Psac;         // expected psac, 0xFF = no message in progress
+} type_Rx_Page;
+
+typedef void (*type_Page_Sink)(const type_Rx_Page &Page, bool Complete, void *Arg);
+
+class GroupDecoder
+{
+  public:
+    bool Print_Groups = false;    // print every group
+    bool Quiet = false;           // print nothing
+    type_Page_Sink Page_Sink = NULL; // called for each paging message
+    void *Page_Arg = NULL;
+    uint32_t Pages = 0;           // complete paging messages
+    uint32_t Broken = 0;          // paging messages with missing groups
+    uint32_t Types[32];           // groups by type (type * 2 + version)
+
+    GroupDecoder() {memset(Types, 0, sizeof(Types)); memset(PS, ' ', 8); PS[8] = 0; RT[0] = 0; Page.Next_Psac = 0xFF;}
+    void Group(const uint16_t *Group, uint8_t Valid);
+    static void GroupSink(const uint16_t *Group, uint8_t Valid, void *Arg) {((GroupDecoder *)Arg)->Group(Group, Valid);} // for BlockSync
+
+  private:
+    char PS[9];
+    char RT[65];
+    uint8_t RT_ABflag = 0xFF;
+    uint16_t RT_Segments = 0;     // bit n = segment n received
+    bool RT_Printed = false;
+    uint16_t Last_1A[3] = {0xFFFF, 0xFFFF, 0xFFFF}; // last B, C, D of 1A
+    type_Rx_Page Page;
+
+    void Group_0A(const uint16_t *G);
+    void Group_1A(const uint16_t *G);
+    void Group_2A(const uint16_t *G);
+    void Group_4A(const uint16_t *G);
+    void Group_7A(const uint16_t *G);
+    void PrintRT();
+    void PageDone();
+    void Print(const char *Format, ...) __attribute__((format(printf, 2, 3)));
+    static char Digit(uint8_t Nibble) {return Nibble < 10 ? '0' + Nibble : (Nibble == 0xA ? ':' : '?');}
+    static char Symbol(uint8_t Code) {return (Code >= 0x20 && Code < 0x7F) ? Code : '.';}
+};
+
+void GroupDecoder::Group(const uint16_t *G, uint8_t Valid)
+{
+if (!(Valid & 2)) {return;} // group type unknown
+uint8_t Type = G[1] >> 11; // type * 2 + version
+Types[Type]++;
+
+if (Print_Groups)
+  {
+  Print("G %u%c %04X %04X %04X %04X%s\n", Type >> 1, (Type & 1) ? 'B' : 'A', G[0], G[1], G[2], G[3], Valid == 0x0F ? "" : " (errors)");
+  }
+if (Valid != 0x0F) {return;} // decode only good groups
+switch (Type)
+  {
+  case 0: case 1: Group_0A(G); break;
+  case 2: Group_1A(G); break;
+  case 4: Group_2A(G); break;
+  case 8: Group_4A(G); break;
+  case 14: Group_7A(G); break;
+  }
+}
+
+void GroupDecoder::Group_0A(const uint16_t *G)
+// Programme Service name, 2 symbols in each group
+{
+uint8_t Pos = (G[1] & 3) * 2;
+PS[Pos] = Symbol(G[3] >> 8);
+PS[Pos + 1] = Symbol(G[3] & 0xFF);
+if (Pos == 6) {Print("0A PS: '%s'\n", PS);}
+}
+
+void GroupDecoder::Group_1A(const uint16_t *G)
+// Radio Paging Codes, Slow Labeling Code and Programme Item Number; print on change
+{
+if (memcmp(Last_1A, G + 1, sizeof(Last_1A)) == 0) {return;}
+memcpy(Last_1A, G + 1, sizeof(Last_1A));
+Print("1A PI=%04X RPC=%02X SLC=%04X PIN=%04X\n", G[0], G[1] & 0x1F, G[2], G[3]);
+}
+
+void GroupDecoder::Group_2A(const uint16_t *G)
+// Radio Text, 4 symbols in each group; print when segments up to end of text (0x0D, segment 15
+// or start of next cycle) are received, again after a segment changed without new A/B flag
+{
+uint8_t AB = (G[1] >> 4) & 1;
+uint8_t Segment = G[1] & 0x0F;
+if (AB != RT_ABflag) // new text
+  {
+  RT_ABflag = AB;
+  RT_Segments = 0;
+  RT_Printed = false;
+  memset(RT, ' ', 64);
+  RT[64] = 0;
+  }
+if (Segment == 0 && RT_Segments && !RT_Printed && (RT_Segments & (RT_Segments + 1)) == 0) // next cycle, all segments received
+  {
+  PrintRT();
+  }
+uint8_t Code[4] = {(uint8_t)(G[2] >> 8), (uint8_t)G[2], (uint8_t)(G[3] >> 8), (uint8_t)G[3]};
+for (uint8_t i = 0; i < 4; i++)
+  {
+  char c = Code[i] == 0x0D ? 0 : Symbol(Code[i]);
+  if (RT[Segment * 4 + i] != c && (RT_Segments >> Segment) & 1) {RT_Printed = false;} // segment changed, same A/B flag
+  RT[Segment * 4 + i] = c;
+  }
+RT_Segments |= 1 << Segment;
+if (!RT_Printed && RT_Segments == (uint16_t)((2UL << Segment) - 1) && (Segment == 15 || memchr(RT, 0, 64)))
+  {
+  PrintRT();
+  }
+}
+
+void GroupDecoder::PrintRT()
+// Text without trailing spaces
+{
+char Text[65];
+memcpy(Text, RT, sizeof(Text));
+uint8_t Len = strlen(Text);
+while (Len && Text[Len - 1] == ' ') {Text[--Len] = 0;}
+Print("2A RT(%c): '%s'\n", RT_ABflag ? 'B' : 'A', Text);
+RT_Printed = true;
+}
+
+void GroupDecoder::Group_4A(const uint16_t *G)
+// Clock time and date
+{
+long Year, Month, Day;
+RDS_4A_DATE(G, Year, Month, Day);
+uint8_t Hour = ((G[2] & 1) << 4) | (G[3] >> 12);
+uint8_t Minute = (G[3] >> 6) & 0x3F;
+uint8_t Offset = G[3] & 0x1F;
+Print("4A %04ld-%02ld-%02ld %02u:%02u UTC %c%02u:%02u\n", Year, Month, Day, Hour, Minute,
+       ((G[3] >> 5) & 1) ? '-' : '+', Offset / 2, (Offset & 1) * 30);
+}
+
+void GroupDecoder::Group_7A(const uint16_t *G)
+// Paging: psac 0 = tone, 2..3 = 10 digits, 4..6 = 18 digits, 8 + 9..E + F = alpha or variable-length (X1X2 of address group)
+{
+uint8_t AB = (G[1] >> 4) & 1;
+uint8_t Psac = G[1] & 0x0F;
+uint8_t Nibble[8] = {(uint8_t)(G[2] >> 12), (uint8_t)((G[2] >> 8) & 0xF), (uint8_t)((G[2] >> 4) & 0xF), (uint8_t)(G[2] & 0xF),
+                     (uint8_t)(G[3] >> 12), (uint8_t)((G[3] >> 8) & 0xF), (uint8_t)((G[3] >> 4) & 0xF), (uint8_t)(G[3] & 0xF)};
+
+if (Psac == 0 || Psac == 2 || Psac == 4 || Psac == 8) // address group: new message
+  {
+  if (Page.Next_Psac != 0xFF) {PageDone();} // previous message is not complete
+  Page.Address = 0;
+  for (uint8_t i = 0; i < 6; i++) {Page.Address = Page.Address * 10 + (Nibble[i] % 10);}
+  Page.Type = (Psac == 0) ? TONE : (Psac == 2) ? DIG10 : (Psac == 4) ? DIG18 : ALPHA;
+  if (Psac == 8 && (Nibble[6] >> 2) == 1) {Page.Type = VARNUM;} // X1X2 message type: 0 alpha, 1 numeric, 3 function
+  if (Psac == 8 && (Nibble[6] >> 2) == 3) {Page.Type = FUNC;}
+  Page.ABflag = AB;
+  Page.X1X2 = (Nibble[6] << 4) | Nibble[7];
+  Page.Len = 0;
+  Page.Text[0] = 0;
+  Page.Psac[0] = "0123456789ABCDEF"[Psac];
+  Page.Psac[1] = 0;
+  if (Page.Type == DIG10 || Page.Type == DIG18)
+    {
+    Page.Text[0] = Digit(Nibble[6]);
+    Page.Text[1] = Digit(Nibble[7]);
+    Page.Len = 2;
+    }
+  Page.Next_Psac = (Psac == 8) ? 9 : Psac + 1;
+  if (Page.Type == TONE) {PageDone();}
+  return;
+  }
+
+if (Page.Next_Psac == 0xFF) {return;} // middle of message we didn't see start of
+
+bool Alpha = Page.Type == ALPHA;
+bool Variable = Page.Type == VARNUM || Page.Type == FUNC;
+bool Expected = (Psac == Page.Next_Psac) || ((Alpha || Variable) && Psac == 0xF && Page.Next_Psac >= 9);
+if (!Expected || AB != Page.ABflag)
+  {
+  PageDone(); // broken
+  return;
+  }
+
+uint8_t Pos = strlen(Page.Psac);
+if (Pos < sizeof(Page.Psac) - 1) {Page.Psac[Pos] = "0123456789ABCDEF"[Psac]; Page.Psac[Pos + 1] = 0;}
+
+if (Alpha)
+  {
+  uint8_t Code[4] = {(uint8_t)(G[2] >> 8), (uint8_t)G[2], (uint8_t)(G[3] >> 8), (uint8_t)G[3]};
+  for (uint8_t i = 0; i < 4 && Page.Len < sizeof(Page.Text) - 1; i++) {Page.Text[Page.Len++] = Symbol(Code[i]);}
+  Page.Text[Page.Len] = 0;
+  Page.Next_Psac = (Psac == 0xE) ? 9 : Psac + 1;
+  if (Psac == 0xF) {Page.Next_Psac = 0; PageDone();}
+  }
+else if (Variable)
+  {
+  for (uint8_t i = 0; i < 8 && Page.Len < sizeof(Page.Text) - 1; i++)
+    {
+    Page.Text[Page.Len++] = (Page.Type == FUNC) ? "0123456789ABCDEF"[Nibble[i]] : Digit(Nibble[i]);
+    }
+  Page.Text[Page.Len] = 0;
+  Page.Next_Psac = (Psac == 0xE) ? 9 : Psac + 1;
+  if (Psac == 0xF) {Page.Next_Psac = 0; PageDone();}
+  }
+else
+  {
+  for (uint8_t i = 0; i < 8; i++) {Page.Text[Page.Len++] = Digit(Nibble[i]);}
+  Page.Text[Page.Len] = 0;
+  Page.Next_Psac = Psac + 1;
+  if ((Page.Type == DIG10 && Psac == 3) || (Page.Type == DIG18 && Psac == 6)) {Page.Next_Psac = 0; PageDone();}
+  }
+}
+
+void GroupDecoder::PageDone()
+// Next_Psac = 0: message complete, else message is broken
+{
+static const char *Names[] = {"TONE", "DIG10", "DIG18", "ALPHA", "VARNUM", "FUNC"};
+bool Complete = (Page.Type == TONE) || (Page.Next_Psac == 0);
+if (Page.Type == ALPHA) // trailing spaces are padding
+  {
+  while (Page.Len && Page.Text[Page.Len - 1] == ' ') {Page.Text[--Page.Len] = 0;}
+  }
+if (Page.Type == VARNUM) // ':' after end of number, function message keeps its A digits
+  {
+  while (Page.Len && Page.Text[Page.Len - 1] == ':') {Page.Text[--Page.Len] = 0;}
+  }
+if (Complete) {Pages++;} else {Broken++;}
+if (Page_Sink) {Page_Sink(Page, Complete, Page_Arg);}
+Print("7A Page %06lu %s A/B=%u", (unsigned long)Page.Address, Names[Page.Type], Page.ABflag);
+if (Page.Type >= ALPHA) {Print(" call=%u%s", Page.X1X2 & 0x0F, (Page.X1X2 & 0x10) ? " repeat" : "");}
+Print(" psac=%s%s: %s\n", Page.Psac, Complete ? "" : " BROKEN", Page.Text);
+Page.Next_Psac = 0xFF;
+}
+
+void GroupDecoder::Print(const char *Format, ...)
+{
+if (Quiet) {return;}
+va_list Args;
+va_start(Args, Format);
+vprintf(Format, Args);
+va_end(Args);
+}
+
+#endif
@@ -0,0 +1,252 @@
+/*  Software RDS demodulator: 57 kHz subcarrier samples (16 bits) -> data bits
+ *
+ *  - Mixer 57 kHz (table of one period) to I/Q and decimating low-pass FIR (dot product kernels: SSE, NEON or scalar)
+ *  - Biphase matched filter (running sums of older and newer half bit)
+ *  - Clock recovery: energy of matched filter in 16 phase bins of bit; bit is sampled at bin 0,
+ *    in the middle of bit phase is moved by one bin to the best bin
+ *  - Differential decoding without carrier recovery: bit = sign of Re(m[k] * conj(m[k-1])),
+ *    so carrier phase and 180 degrees ambiguity don't matter
+*/
+
+#ifndef HOST_RDS_DEMOD_H
+#define HOST_RDS_DEMOD_H
+
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#if defined(__SSE__)
+#include <xmmintrin.h>
+#elif defined(__ARM_NEON)
+#include <arm_neon.h>
+#endif
+#include "rds_code.h"
+
+#define DEM_BIT_SAMPLES 16   // min samples per bit after decimation
+#define DEM_PHASE_BINS 16    // clock recovery bins in one bit
+#define DEM_FIR_CUTOFF 2800  // Hz, RDS band is +-2.4 kHz
+#define DEM_FIR_WIDTH 4000   // Hz, transition band of FIR
+#define DEM_FIR_MAX 1024     // max FIR taps
+#define DEM_MF_MAX 64        // max samples per bit in matched filter
+#define DEM_OSC_MAX 4096     // max 57 kHz oscillator table (period in samples), else recurrence is used
+
+typedef void (*type_Bit_Sink)(uint8_t Bit, void *Arg);
+
+// -------------------------------------------------------- Dot product kernel
+inline float DEM_DOT(const float *a, const float *b, uint16_t n)
+// n must be multiple of 4
+{
+#if defined(__SSE__)
+__m128 Sum = _mm_setzero_ps();
+for (uint16_t i = 0; i < n; i += 4) {Sum = _mm_add_ps(Sum, _mm_mul_ps(_mm_loadu_ps(a + i), _mm_loadu_ps(b + i)));}
+float Out[4];
+_mm_storeu_ps(Out, Sum);
+return (Out[0] + Out[1]) + (Out[2] + Out[3]);
+#elif defined(__ARM_NEON)
+float32x4_t Sum = vdupq_n_f32(0);
+for (uint16_t i = 0; i < n; i += 4) {Sum = vmlaq_f32(Sum, vld1q_f32(a + i), vld1q_f32(b + i));}
+float Out[4];
+vst1q_f32(Out, Sum);
+return (Out[0] + Out[1]) + (Out[2] + Out[3]);
+#else
+float Sum = 0;
+for (uint16_t i = 0; i < n; i++) {Sum += a[i] * b[i];}
+return Sum;
+#endif
+}
+
+// -------------------------------------------------------- Demodulator
+class Demodulator
+{
+  public:
+    uint32_t Rate = 0;        // input samples per second
+    uint16_t Decim = 0;       // decimation factor
+    uint16_t Taps = 0;        // FIR length (multiple of 4)
+    uint32_t Bits = 0;        // bits sent to sink
+
+    bool Begin(uint32_t Sample_Rate, type_Bit_Sink Sink, void *Arg); // false = rate too low
+    void Process(const int16_t *In, uint32_t Count);
+
+  private:
+    type_Bit_Sink Sink = NULL;
+    void *Sink_Arg = NULL;
+
+    // Mixer: table of one period Rate / gcd(Rate, 57000) or complex recurrence
+    float Osc_I[DEM_OSC_MAX], Osc_Q[DEM_OSC_MAX];
+    uint16_t Osc_Len, Osc_Pos;
+    double Osc_Re, Osc_Im, Step_Re, Step_Im;
+    uint16_t Osc_Count;
+
+    // FIR, history is written twice so window is always contiguous
+    float Fir[DEM_FIR_MAX];
+    float Hist_I[2 * DEM_FIR_MAX];
+    float Hist_Q[2 * DEM_FIR_MAX];
+    uint16_t Hist_Pos;
+    uint16_t Decim_Count;
+
+    // Matched filter
+    float MF_I[DEM_MF_MAX], MF_Q[DEM_MF_MAX]; // last samples of bit
+    uint8_t MF_Len, MF_Half, MF_Pos;
+    double New_I, New_Q, Old_I, Old_Q;        // sums of newer and older half bit
+
+    // Clock recovery
+    double Phase, Phase_Step;
+    float Energy[DEM_PHASE_BINS];             // matched filter energy for each phase bin
+    uint8_t Last_Bin;
+    bool Tracked;                             // phase was checked in this bit
+    float Last_I, Last_Q;                     // matched filter at previous bit
+
+    void Baseband(float I, float Q);
+};
+
+// -------------------------------------------------------- Implementation
+
+bool Demodulator::Begin(uint32_t Sample_Rate, type_Bit_Sink Bit_Sink, void *Arg)
+{
+if (Sample_Rate < 2 * (RDS_CARRIER + DEM_FIR_CUTOFF)) {return false;}
+Rate = Sample_Rate;
+Sink = Bit_Sink;
+Sink_Arg = Arg;
+Bits = 0;
+
+Decim = (uint16_t)(Rate / (RDS_BIT_RATE * DEM_BIT_SAMPLES));
+double Rate_Out = (double)Rate / Decim;
+double Bit_Samples = Rate_Out / RDS_BIT_RATE;
+if (Bit_Samples >= DEM_MF_MAX) {return false;}
+
+// Hamming windowed sinc, gain 2 (DSB: half of amplitude in each side band)
+Taps = ((uint32_t)(3.3 * Rate / DEM_FIR_WIDTH) + 3) & ~3;
+if (Taps > DEM_FIR_MAX) {Taps = DEM_FIR_MAX;}
+double fc = (double)DEM_FIR_CUTOFF / Rate;
+for (uint16_t i = 0; i < Taps; i++)
+  {
+  double m = i - (Taps - 1) / 2.0;
+  double Sinc = (m == 0) ? 2 * fc : sin(2 * M_PI * fc * m) / (M_PI * m);
+  Fir[i] = 2 * Sinc * (0.54 - 0.46 * cos(2 * M_PI * i / (Taps - 1))) / 32768.0;
+  }
+memset(Hist_I, 0, sizeof(Hist_I));
+memset(Hist_Q, 0, sizeof(Hist_Q));
+Hist_Pos = 0;
+Decim_Count = 0;
+
+uint32_t a = Rate, b = RDS_CARRIER; // gcd
+while (b) {uint32_t t = a % b; a = b; b = t;}
+Osc_Len = (Rate / a <= DEM_OSC_MAX) ? Rate / a : 0;
+for (uint16_t i = 0; i < Osc_Len; i++)
+  {
+  Osc_I[i] = cos(2 * M_PI * RDS_CARRIER * (double)i / Rate);
+  Osc_Q[i] = -sin(2 * M_PI * RDS_CARRIER * (double)i / Rate);
+  }
+Osc_Pos = 0;
+Osc_Re = 1;
+Osc_Im = 0;
+Step_Re = cos(2 * M_PI * RDS_CARRIER / Rate);
+Step_Im = -sin(2 * M_PI * RDS_CARRIER / Rate);
+Osc_Count = 0;
+
+MF_Len = (uint8_t)(Bit_Samples + 0.5) & ~1;
+MF_Half = MF_Len / 2;
+MF_Pos = 0;
+memset(MF_I, 0, sizeof(MF_I));
+memset(MF_Q, 0, sizeof(MF_Q));
+New_I = New_Q = Old_I = Old_Q = 0;
+
+Phase = 0;
+Phase_Step = 1.0 / Bit_Samples;
+memset(Energy, 0, sizeof(Energy));
+Last_Bin = 0;
+Tracked = false;
+Last_I = Last_Q = 0;
+return true;
+}
+
+void Demodulator::Process(const int16_t *In, uint32_t Count)
+{
+for (uint32_t n = 0; n < Count; n++)
+  {
+  // mix down to baseband
+  float x = In[n];
+  float I, Q;
+  if (Osc_Len)
+    {
+    I = Osc_I[Osc_Pos];
+    Q = Osc_Q[Osc_Pos];
+    if (++Osc_Pos == Osc_Len) {Osc_Pos = 0;}
+    }
+  else
+    {
+    I = Osc_Re;
+    Q = Osc_Im;
+    double Re = Osc_Re * Step_Re - Osc_Im * Step_Im;
+    Osc_Im = Osc_Re * Step_Im + Osc_Im * Step_Re;
+    Osc_Re = Re;
+    if (++Osc_Count == 0) // keep amplitude 1
+      {
+      double Norm = 1 / sqrt(Osc_Re * Osc_Re + Osc_Im * Osc_Im);
+      Osc_Re *= Norm;
+      Osc_Im *= Norm;
+      }
+    }
+  Hist_I[Hist_Pos] = Hist_I[Hist_Pos + Taps] = x * I;
+  Hist_Q[Hist_Pos] = Hist_Q[Hist_Pos + Taps] = x * Q;
+  if (++Hist_Pos == Taps) {Hist_Pos = 0;}
+
+  // low-pass only for decimated outputs
+  if (++Decim_Count < Decim) {continue;}
+  Decim_Count = 0;
+  Baseband(DEM_DOT(Fir, Hist_I + Hist_Pos, Taps), DEM_DOT(Fir, Hist_Q + Hist_Pos, Taps));
+  }
+}
+
+void Demodulator::Baseband(float I, float Q)
+// One decimated sample: matched filter and clock recovery
+{
+uint8_t Mid = (MF_Pos + MF_Half) % MF_Len; // sample leaving newer half
+New_I += I - MF_I[Mid];
+New_Q += Q - MF_Q[Mid];
+Old_I += MF_I[Mid] - MF_I[MF_Pos]; // MF_Pos is the oldest sample
+Old_Q += MF_Q[Mid] - MF_Q[MF_Pos];
+MF_I[MF_Pos] = I;
+MF_Q[MF_Pos] = Q;
+MF_Pos = (MF_Pos + 1) % MF_Len;
+
+// biphase: + in first half of bit, - in second half
+float m_I = Old_I - New_I;
+float m_Q = Old_Q - New_Q;
+
+uint8_t Bin = (uint8_t)(Phase * DEM_PHASE_BINS);
+Energy[Bin] += 0.02f * (m_I * m_I + m_Q * m_Q - Energy[Bin]);
+
+if (Bin < Last_Bin) // phase wrapped: sampling point of bit
+  {
+  uint8_t Bit = (m_I * Last_I + m_Q * Last_Q) < 0; // polarity changed = 1
+  Last_I = m_I;
+  Last_Q = m_Q;
+  Bits++;
+  Tracked = false;
+  if (Sink) {Sink(Bit, Sink_Arg);}
+  }
+else if (Bin >= DEM_PHASE_BINS / 2 && !Tracked) // middle of bit: follow the clock
+  {
+  Tracked = true;
+  uint8_t Best = 0;
+  for (uint8_t b = 1; b < DEM_PHASE_BINS; b++)
+    {
+    if (Energy[b] > Energy[Best]) {Best = b;}
+    }
+  if (Best != 0 && Best != DEM_PHASE_BINS / 2)
+    {
+    int8_t Shift = (Best < DEM_PHASE_BINS / 2) ? 1 : -1; // 1 = sample later
+    float Tmp[DEM_PHASE_BINS];
+    for (uint8_t b = 0; b < DEM_PHASE_BINS; b++) {Tmp[(b - Shift) & (DEM_PHASE_BINS - 1)] = Energy[b];}
+    memcpy(Energy, Tmp, sizeof(Energy));
+    Phase -= (double)Shift / DEM_PHASE_BINS;
+    Bin = (uint8_t)(Phase * DEM_PHASE_BINS);
+    }
+  }
+Last_Bin = Bin;
+
+Phase += Phase_Step;
+if (Phase >= 1) {Phase -= 1;}
+}
+
+#endif
@@ -0,0 +1,139 @@
+/*  Software RDS modulator: groups {A,B,C,D} -> 57 kHz DSB-SC samples (16 bits)
+ *
+ *  Checkwords + offset words, differential coding, biphase symbols shaped with
+ *  H(f) = cos(pi*f*Td/4) for f < 2/Td (IEC 62106), multiplied by 57 kHz carrier.
+ *
+ *  Sample rate must be multiple of 2375 Hz: then one bit has integer number of samples
+ *  and exactly 48 carrier periods, so carrier is the same in every bit period and is
+ *  folded into symbol table. One bit period of output = sum of MOD_SPAN table rows
+ *  multiplied by +1/-1 (plain float loops, vectorized by compiler).
+*/
+
+#ifndef HOST_RDS_MOD_H
+#define HOST_RDS_MOD_H
+
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include "rds_code.h"
+
+#define MOD_SPAN 8            // bit periods covered by one shaped symbol (power of 2)
+#define MOD_MIN_RATE 121125   // lowest rate above Nyquist for 57 kHz + RDS band
+#define MOD_DEFAULT_RATE 228000 // 192 samples per bit, 4 samples per carrier period
+
+class Modulator
+{
+  public:
+    uint16_t Bit_Samples = 0; // samples per bit
+    uint32_t Rate = 0;        // samples per second
+
+    ~Modulator() {free(Table); free(Acc);}
+    bool Begin(uint32_t Sample_Rate, float Level); // Level 0..1 of full scale; false = rate not supported
+    uint32_t Group(const uint16_t *Group, int16_t *Out); // Modulate group, Out must have RDS_GROUP_BITS * Bit_Samples; return samples
+    uint32_t Flush(int16_t *Out);  // Tail of last symbols, Out must have MOD_SPAN * Bit_Samples; return samples
+    uint32_t GroupSamples() {return (uint32_t)RDS_GROUP_BITS * Bit_Samples;}
+
+  private:
+    float *Table = NULL;      // MOD_SPAN rows of Bit_Samples: shaped symbol * carrier * scale
+    float *Acc = NULL;        // one bit period
+    int8_t Sign[MOD_SPAN];    // last symbols polarity (0 = nothing sent yet)
+    uint8_t Pos = 0;          // index of last symbol in Sign
+    uint8_t Diff = 0;         // last differential coded bit
+    void Bit(int8_t Polarity, int16_t *Out);
+    static double Shape(double t);
+};
+
+// -------------------------------------------------------- Implementation
+
+double Modulator::Shape(double t)
+// Impulse response of H(f) = cos(pi*f*Td/4), |f| < 2/Td; t in bit periods
+{
+const double a = M_PI / 4;
+double d = a * a - 4 * M_PI * M_PI * t * t;
+if (fabs(d) < 1e-9) {return 2;} // limit at t = +-1/8
+return cos(4 * M_PI * t) * 2 * a / d;
+}
+
+bool Modulator::Begin(uint32_t Sample_Rate, float Level)
+{
+if (Sample_Rate < MOD_MIN_RATE || Sample_Rate % 2375 != 0) {return false;}
+Rate = Sample_Rate;
+Bit_Samples = Sample_Rate * 2 / 2375;
+
+free(Table);
+free(Acc);
+Table = (float *)malloc(sizeof(float) * MOD_SPAN * Bit_Samples);
+Acc = (float *)malloc(sizeof(float) * Bit_Samples);
+if (!Table || !Acc) {return false;}
+
+// Biphase symbol: +impulse at start of bit, -impulse in the middle; symbol is centered in the table
+double Peak = 0;
+for (uint16_t n = 0; n < Bit_Samples; n++)
+  {
+  double Carrier = cos(2 * M_PI * 48.0 * n / Bit_Samples); // 48 periods per bit
+  double Sum = 0;
+  for (uint8_t j = 0; j < MOD_SPAN; j++)
+    {
+    double t = (double)j - MOD_SPAN / 2 + (double)n / Bit_Samples;
+    double v = (Shape(t) - Shape(t - 0.5)) * Carrier;
+    Table[j * Bit_Samples + n] = v;
+    Sum += fabs(v);
+    }
+  if (Sum > Peak) {Peak = Sum;}
+  }
+
+// worst case sum of all rows = Level of full scale
+float Scale = Level * 32767.0 / Peak;
+for (uint32_t i = 0; i < (uint32_t)MOD_SPAN * Bit_Samples; i++) {Table[i] *= Scale;}
+
+memset(Sign, 0, sizeof(Sign));
+Pos = 0;
+Diff = 0;
+return true;
+}
+
+void Modulator::Bit(int8_t Polarity, int16_t *Out)
+// Add symbol and output one bit period; row j of table belongs to symbol sent j bits ago
+{
+Pos = (Pos + 1) & (MOD_SPAN - 1);
+Sign[Pos] = Polarity;
+
+float *__restrict Sum = Acc;
+const uint16_t Len = Bit_Samples;
+for (uint16_t n = 0; n < Len; n++) {Sum[n] = 0;}
+for (uint8_t j = 0; j < MOD_SPAN; j++)
+  {
+  const float s = Sign[(Pos - j) & (MOD_SPAN - 1)];
+  if (s == 0) {continue;}
+  const float *__restrict Row = Table + (uint32_t)j * Len;
+  for (uint16_t n = 0; n < Len; n++) {Sum[n] += s * Row[n];}
+  }
+for (uint16_t n = 0; n < Len; n++) {Out[n] = (int16_t)Sum[n];} // |Sum| <= 32767 * Level
+}
+
+uint32_t Modulator::Group(const uint16_t *Group, int16_t *Out)
+{
+for (uint8_t b = 0; b < 4; b++)
+  {
+  uint32_t Block = RDS_BLOCK(Group[b], RDS_GROUP_OFFSET(Group, b));
+  for (int8_t i = RDS_BLOCK_BITS - 1; i >= 0; i--)
+    {
+    Diff ^= (Block >> i) & 1; // differential coding
+    Bit(Diff ? 1 : -1, Out);
+    Out += Bit_Samples;
+    }
+  }
+return GroupSamples();
+}
+
+uint32_t Modulator::Flush(int16_t *Out)
+{
+for (uint8_t i = 0; i < MOD_SPAN; i++)
+  {
+  Bit(0, Out);
+  Out += Bit_Samples;
+  }
+return (uint32_t)MOD_SPAN * Bit_Samples;
+}
+
+#endif
@@ -0,0 +1,166 @@
+/*  rdsdec - decode RDS from 57 kHz subcarrier samples (output of rdsmod or SDR recording of MPX)
+ *
+ *  Input: WAV (16 bits, first channel is used) or raw s16le with -s rate.
+ *  Output: decoded 0A/1A/2A/4A groups and paging messages, with -g every group.
+ *  Summary (blocks, corrected, bad, groups, pages, speed) goes to stderr.
+ *  -c file: decoded pages must be the pages of file in the same order (lines "address text" from bench -m -e),
+ *           padding at the end of text (' ', ':') is not compared; exit code 1 on a broken, other or missing page.
+ *
+ *  Usage: ./rdsdec [-g] [-s rate] [-c file] [file.wav|file.raw|-]
+*/
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "rds_demod.h"
+#include "rds_decode.h"
+
+#define READ_SAMPLES 8192
+#define COMPARE_PAGES 64 // decoded pages kept for -c
+
+static struct {uint32_t Address; bool Complete; char Text[96];} Pages[COMPARE_PAGES];
+static uint32_t Pages_Decoded = 0;
+
+static uint32_t Get32(const uint8_t *b) {return b[0] | (b[1] << 8) | ((uint32_t)b[2] << 16) | ((uint32_t)b[3] << 24);}
+static uint16_t Get16(const uint8_t *b) {return b[0] | (b[1] << 8);}
+
+static void Page_Sink(const type_Rx_Page &Page, bool Complete, void *)
+{
+if (Pages_Decoded < COMPARE_PAGES)
+  {
+  Pages[Pages_Decoded].Address = Page.Address;
+  Pages[Pages_Decoded].Complete = Complete;
+  strcpy(Pages[Pages_Decoded].Text, Page.Text);
+  }
+Pages_Decoded++;
+}
+
+static size_t Unpadded(const char *Text)
+// Length of text without ' ' and ':' at the end (alpha and numeric padding)
+{
+size_t Len = strlen(Text);
+while (Len && (Text[Len - 1] == ' ' || Text[Len - 1] == ':')) {Len--;}
+return Len;
+}
+
+static uint32_t Compare(const char *Name)
+// Decoded pages against lines "address text" of file, return number of differences
+{
+FILE *f = fopen(Name, "r");
+if (!f) {perror(Name); return 1;}
+char Line[128];
+uint32_t n = 0, Errors = 0;
+while (fgets(Line, sizeof(Line), f))
+  {
+  Line[strcspn(Line, "\r\n")] = 0;
+  char *Text = strchr(Line, ' ');
+  Text = Text ? Text + 1 : Line + strlen(Line);
+  uint32_t Address = strtoul(Line, NULL, 10);
+  if (n >= Pages_Decoded || n >= COMPARE_PAGES) {fprintf(stderr, "page %lu missing: %06lu %s\n", (unsigned long)n + 1, (unsigned long)Address, Text); Errors++;}
+  else if (!Pages[n].Complete || Pages[n].Address != Address || Unpadded(Pages[n].Text) != Unpadded(Text) ||
+           memcmp(Pages[n].Text, Text, Unpadded(Text)) != 0)
+    {
+    fprintf(stderr, "page %lu differs: sent %06lu '%s', decoded %06lu '%s'%s\n", (unsigned long)n + 1, (unsigned long)Address, Text,
+            (unsigned long)Pages[n].Address, Pages[n].Text, Pages[n].Complete ? "" : " (broken)");
+    Errors++;
+    }
+  n++;
+  }
+fclose(f);
+if (Pages_Decoded > n) {fprintf(stderr, "%lu pages more than sent\n", (unsigned long)(Pages_Decoded - n)); Errors++;}
+fprintf(stderr, "compare: %lu pages sent, %lu decoded, %lu differences\n", (unsigned long)n, (unsigned long)Pages_Decoded, (unsigned long)Errors);
+return Errors;
+}
+
+static bool WavHeader(FILE *f, uint32_t &Rate, uint16_t &Channels)
+// Read chunks up to "data"; false if not 16 bits PCM WAV
+{
+uint8_t Head[12];
+if (fread(Head, 1, 12, f) != 12 || memcmp(Head, "RIFF", 4) != 0 || memcmp(Head + 8, "WAVE", 4) != 0) {return false;}
+bool Format = false;
+uint8_t Chunk[8];
+while (fread(Chunk, 1, 8, f) == 8)
+  {
+  uint32_t Size = Get32(Chunk + 4);
+  if (memcmp(Chunk, "data", 4) == 0) {return Format;}
+  if (memcmp(Chunk, "fmt ", 4) == 0 && Size >= 16)
+    {
+    uint8_t Fmt[16];
+    if (fread(Fmt, 1, 16, f) != 16) {return false;}
+    Channels = Get16(Fmt + 2);
+    Rate = Get32(Fmt + 4);
+    Format = Get16(Fmt) == 1 && Get16(Fmt + 14) == 16 && Channels > 0;
+    Size -= 16;
+    }
+  for (uint32_t i = 0; i < Size + (Size & 1); i++) {fgetc(f);} // skip rest of chunk
+  }
+return false;
+}
+
+int main(int argc, char **argv)
+{
+uint32_t Rate = 0;
+uint16_t Channels = 1;
+const char *In_Name = "-";
+const char *Compare_Name = NULL;
+GroupDecoder Decoder;
+Decoder.Page_Sink = Page_Sink;
+
+for (int a = 1; a < argc; a++)
+  {
+  if (strcmp(argv[a], "-g") == 0) {Decoder.Print_Groups = true;}
+  else if (strcmp(argv[a], "-s") == 0 && a + 1 < argc) {Rate = strtoul(argv[++a], NULL, 10);}
+  else if (strcmp(argv[a], "-c") == 0 && a + 1 < argc) {Compare_Name = argv[++a];}
+  else if (argv[a][0] == '-' && argv[a][1]) {fprintf(stderr, "Usage: %s [-g] [-s rate] [-c file] [file.wav|file.raw|-]\n", argv[0]); return 2;}
+  else {In_Name = argv[a];}
+  }
+
+bool Pipe = strcmp(In_Name, "-") == 0;
+FILE *In = Pipe ? stdin : fopen(In_Name, "rb");
+if (!In) {perror(In_Name); return 1;}
+size_t Name_Len = strlen(In_Name);
+if (Name_Len > 4 && strcmp(In_Name + Name_Len - 4, ".wav") == 0)
+  {
+  if (!WavHeader(In, Rate, Channels)) {fprintf(stderr, "%s: not 16 bits PCM WAV\n", In_Name); return 1;}
+  }
+if (!Rate) {Rate = 228000;}
+
+BlockSync Sync;
+Sync.Begin(GroupDecoder::GroupSink, &Decoder);
+Demodulator Demod;
+if (!Demod.Begin(Rate, BlockSync::BitSink, &Sync)) {fprintf(stderr, "Sample rate %lu is too low\n", (unsigned long)Rate); return 2;}
+
+static int16_t Samples[READ_SAMPLES];
+uint64_t Total = 0;
+struct timespec Start, End;
+clock_gettime(CLOCK_MONOTONIC, &Start);
+
+size_t Count;
+while ((Count = fread(Samples, sizeof(int16_t) * Channels, READ_SAMPLES / Channels, In)) > 0)
+  {
+  if (Channels > 1) // first channel
+    {
+    for (size_t i = 0; i < Count; i++) {Samples[i] = Samples[i * Channels];}
+    }
+#if __BYTE_ORDER__ != __ORDER_LITTLE_ENDIAN__
+  for (size_t i = 0; i < Count; i++) {Samples[i] = (int16_t)Get16((const uint8_t *)&Samples[i]);}
+#endif
+  Demod.Process(Samples, Count);
+  Total += Count;
+  }
+
+clock_gettime(CLOCK_MONOTONIC, &End);
+if (!Pipe) {fclose(In);}
+fflush(stdout);
+
+double Time = (End.tv_sec - Start.tv_sec) + (End.tv_nsec - Start.tv_nsec) * 1e-9;
+double Audio = (double)Total / Rate;
+fprintf(stderr, "%.1f s of signal in %.3f s (x%.0f real time), FIR %u taps, decimation %u\n",
+        Audio, Time, Audio / Time, Demod.Taps, Demod.Decim);
+fprintf(stderr, "bits %lu, blocks %lu, corrected %lu, bad %lu, groups %lu, sync lost %lu, pages %lu, broken %lu\n",
+        (unsigned long)Demod.Bits, (unsigned long)Sync.Blocks, (unsigned long)Sync.Corrected, (unsigned long)Sync.Bad,
+        (unsigned long)Sync.Groups, (unsigned long)Sync.Lost, (unsigned long)Decoder.Pages, (unsigned long)Decoder.Broken);
+return (Compare_Name && Compare(Compare_Name)) ? 1 : 0;
+}
@@ -0,0 +1,159 @@
+/*  rdsmod - render RDS groups to 57 kHz subcarrier samples
+ *
+ *  Input: text lines with 4 hex words A B C D (first 4 words of 4 hex digits on the line),
+ *         f.e. monitor log of the encoder "Tx 7A: 6277 7108 1004 6600 : ".
+ *  Output: signed 16 bits mono, WAV if file name ends with .wav, else raw (s16le).
+ *
+ *  Usage: ./rdsmod [-s rate] [-l level] [-N noise] [-n repeat] [-o out.wav|out.raw|-] [groups.txt]
+ *         noise: white gaussian noise, RMS in parts of full scale (f.e. 0.3), to test decoder
+*/
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <ctype.h>
+#include <time.h>
+#include "rds_mod.h"
+
+#define MAX_GROUPS 65536 // groups kept from input
+
+static uint16_t Groups[MAX_GROUPS][4];
+static uint32_t Group_Count = 0;
+
+static bool ParseLine(const char *Line, uint16_t *Group)
+// First 4 words of exactly 4 hex digits
+{
+uint8_t Found = 0;
+const char *p = Line;
+while (*p && Found < 4)
+  {
+  if (!isalnum((unsigned char)*p)) {p++; continue;}
+  const char *Start = p;
+  while (isalnum((unsigned char)*p)) {p++;}
+  if (p - Start != 4) {continue;}
+  bool Hex = true;
+  for (const char *c = Start; c < p; c++) {Hex = Hex && isxdigit((unsigned char)*c);}
+  if (!Hex) {continue;}
+  Group[Found++] = (uint16_t)strtoul(Start, NULL, 16);
+  }
+return Found == 4;
+}
+
+static void AddNoise(int16_t *Samples, uint32_t Count, float Noise)
+// Box-Muller from xorshift32
+{
+static uint32_t Seed = 2463534242UL;
+for (uint32_t i = 0; i < Count; i += 2)
+  {
+  float u[2];
+  for (uint8_t k = 0; k < 2; k++)
+    {
+    Seed ^= Seed << 13; Seed ^= Seed >> 17; Seed ^= Seed << 5;
+    u[k] = (Seed + 1.0f) / 4294967296.0f;
+    }
+  float r = Noise * 32767 * sqrtf(-2 * logf(u[0]));
+  float v[2] = {r * cosf(2 * (float)M_PI * u[1]), r * sinf(2 * (float)M_PI * u[1])};
+  for (uint8_t k = 0; k < 2 && i + k < Count; k++)
+    {
+    float x = Samples[i + k] + v[k];
+    Samples[i + k] = (x > 32767) ? 32767 : (x < -32768) ? -32768 : (int16_t)x;
+    }
+  }
+}
+
+// -------------------------------------------------------- Output
+static void Put32(FILE *f, uint32_t v) {uint8_t b[4] = {(uint8_t)v, (uint8_t)(v >> 8), (uint8_t)(v >> 16), (uint8_t)(v >> 24)}; fwrite(b, 1, 4, f);}
+static void Put16(FILE *f, uint16_t v) {uint8_t b[2] = {(uint8_t)v, (uint8_t)(v >> 8)}; fwrite(b, 1, 2, f);}
+
+static void WavHeader(FILE *f, uint32_t Rate, uint32_t Samples)
+// mono, 16 bits; Samples = 0xFFFFFFFF when unknown (pipe)
+{
+uint32_t Data = Samples == 0xFFFFFFFF ? 0xFFFFFFFF : Samples * 2;
+fwrite("RIFF", 1, 4, f); Put32(f, Data == 0xFFFFFFFF ? Data : Data + 36);
+fwrite("WAVEfmt ", 1, 8, f); Put32(f, 16); Put16(f, 1); Put16(f, 1);
+Put32(f, Rate); Put32(f, Rate * 2); Put16(f, 2); Put16(f, 16);
+fwrite("data", 1, 4, f); Put32(f, Data);
+}
+
+static void WriteSamples(FILE *f, const int16_t *Samples, uint32_t Count)
+{
+#if __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+fwrite(Samples, sizeof(int16_t), Count, f);
+#else
+for (uint32_t i = 0; i < Count; i++) {Put16(f, (uint16_t)Samples[i]);}
+#endif
+}
+
+// -------------------------------------------------------- Main
+int main(int argc, char **argv)
+{
+uint32_t Rate = MOD_DEFAULT_RATE;
+float Level = 0.8;
+float Noise = 0;
+uint32_t Repeat = 1;
+const char *Out_Name = "-";
+const char *In_Name = NULL;
+
+for (int a = 1; a < argc; a++)
+  {
+  if (strcmp(argv[a], "-s") == 0 && a + 1 < argc) {Rate = strtoul(argv[++a], NULL, 10);}
+  else if (strcmp(argv[a], "-l") == 0 && a + 1 < argc) {Level = atof(argv[++a]);}
+  else if (strcmp(argv[a], "-N") == 0 && a + 1 < argc) {Noise = atof(argv[++a]);}
+  else if (strcmp(argv[a], "-n") == 0 && a + 1 < argc) {Repeat = strtoul(argv[++a], NULL, 10);}
+  else if (strcmp(argv[a], "-o") == 0 && a + 1 < argc) {Out_Name = argv[++a];}
+  else if (argv[a][0] == '-' && argv[a][1]) {fprintf(stderr, "Usage: %s [-s rate] [-l level] [-N noise] [-n repeat] [-o out.wav|out.raw|-] [groups.txt]\n", argv[0]); return 2;}
+  else {In_Name = argv[a];}
+  }
+
+Modulator Mod;
+if (!Mod.Begin(Rate, Level))
+  {
+  fprintf(stderr, "Sample rate %lu not supported: use multiple of 2375 Hz >= %lu (f.e. 171000, 190000, 228000)\n", (unsigned long)Rate, (unsigned long)MOD_MIN_RATE);
+  return 2;
+  }
+
+FILE *In = In_Name ? fopen(In_Name, "r") : stdin;
+if (!In) {perror(In_Name); return 1;}
+char Line[256];
+while (fgets(Line, sizeof(Line), In) && Group_Count < MAX_GROUPS)
+  {
+  if (ParseLine(Line, Groups[Group_Count])) {Group_Count++;}
+  }
+if (In != stdin) {fclose(In);}
+if (!Group_Count) {fprintf(stderr, "No groups in input\n"); return 1;}
+
+bool Pipe = strcmp(Out_Name, "-") == 0;
+FILE *Out = Pipe ? stdout : fopen(Out_Name, "wb");
+if (!Out) {perror(Out_Name); return 1;}
+size_t Name_Len = strlen(Out_Name);
+bool Wav = Name_Len > 4 && strcmp(Out_Name + Name_Len - 4, ".wav") == 0;
+
+uint64_t Total = (uint64_t)Group_Count * Repeat * Mod.GroupSamples() + (uint64_t)MOD_SPAN * Mod.Bit_Samples;
+if (Wav) {WavHeader(Out, Rate, Total * 2 + 36 > 0xFFFFFFFFULL ? 0xFFFFFFFF : (uint32_t)Total);}
+
+int16_t *Samples = (int16_t *)malloc(sizeof(int16_t) * Mod.GroupSamples());
+struct timespec Start, End;
+clock_gettime(CLOCK_MONOTONIC, &Start);
+
+for (uint32_t r = 0; r < Repeat; r++)
+  {
+  for (uint32_t g = 0; g < Group_Count; g++)
+    {
+    uint32_t Count = Mod.Group(Groups[g], Samples);
+    if (Noise > 0) {AddNoise(Samples, Count, Noise);}
+    WriteSamples(Out, Samples, Count);
+    }
+  }
+WriteSamples(Out, Samples, Mod.Flush(Samples));
+
+clock_gettime(CLOCK_MONOTONIC, &End);
+if (!Pipe) {fclose(Out);}
+free(Samples);
+
+double Render = (End.tv_sec - Start.tv_sec) + (End.tv_nsec - Start.tv_nsec) * 1e-9;
+double Audio = (double)Total / Rate;
+fprintf(stderr, "%lu groups, %lu Hz, %.1f s of signal in %.3f s (x%.0f real time)\n",
+        (unsigned long)Group_Count * Repeat, (unsigned long)Rate, Audio, Render, Audio / Render);
+return 0;
+}
@@ -0,0 +1,163 @@
+/*  tracedec - print monitor trace of the encoder (binary records, SOURCE/trace.h) as monitor lines
+ *
+ *  Input: serial output of the encoder, text between frames is printed as it is.
+ *  Output: "Tx 7A: AAAA BBBB CCCC DDDD : ..." for each record (input for rdsmod),
+ *          "Sent 2A: text" after radio text update or refresh cycle (whole text of segment table), decoded page
+ *          (rds_decode.h) after 7A message,
+ *          "# dropped N" where the encoder had no place for records (exit code 1).
+ *          Records of second transmitter (TRACE_TX2, spread mode of scheduler.h) start with "TX2 " and have own 7A decoder.
+ *
+ *  Usage: ./tracedec [-t] [file|-]    -t: time of group (s from start of encoder) before each line
+ *         stty -F /dev/ttyUSB0 57600 raw && ./tracedec /dev/ttyUSB0
+*/
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include "rds_decode.h"
+
+#define FRAME_SYNC 0xA5  // protocol.h
+#define FRAME_TRACE 0xA0 // CMD_TRACE | 0x80
+#define RECORD_LEN 14    // TRACE_RECORD_LEN
+#define RECORD_LAST 0x01 // TRACE_LAST
+#define RECORD_TX2  0x02 // TRACE_TX2
+
+static uint16_t CRC16(const uint8_t *p, uint16_t Len)
+// CRC-16/CCITT, as CRC16() of SOURCE/tools.h
+{
+uint16_t CRC = 0xFFFF;
+for (uint16_t i = 0; i < Len; i++)
+  {
+  CRC ^= (uint16_t)p[i] << 8;
+  for (uint8_t b = 0; b < 8; b++) {CRC = (CRC & 0x8000) ? (CRC << 1) ^ 0x1021 : (CRC << 1);}
+  }
+return CRC;
+}
+
+static uint16_t Get16(const uint8_t *p) {return p[0] | (p[1] << 8);}
+static uint32_t Get32(const uint8_t *p) {return Get16(p) | ((uint32_t)Get16(p + 2) << 16);}
+
+// -------------------------------------------------------- Records
+static GroupDecoder Decoder[2]; // 7A messages of each transmitter
+static char RT[65];          // radio text: segments of current A/B flag
+static uint8_t RT_ABflag = 0xFF, RT_Segments = 0; // segments = last received segment + 1
+static bool Show_Time = false;
+static unsigned long Dropped = 0, Records = 0;
+
+static char Symbol(uint8_t Code) {return (Code >= 0x20 && Code < 0x7F) ? Code : '.';}
+
+static void Record(uint8_t Lost, const uint8_t *Data)
+{
+uint32_t Time = Get32(Data);
+uint8_t ID = Data[4];
+uint8_t Flags = Data[5];
+uint16_t G[4];
+for (uint8_t i = 0; i < 4; i++) {G[i] = Get16(Data + 6 + i * 2);}
+uint8_t Type = G[1] >> 12;
+bool B = (G[1] >> 11) & 1;
+
+Records++;
+if (Lost) {Dropped += Lost; printf("# dropped %u\n", Lost);}
+if (Show_Time) {printf("[%6lu.%03lu] ", (unsigned long)(Time / 1000), (unsigned long)(Time % 1000));}
+if (Flags & RECORD_TX2) {printf("TX2 ");}
+printf("Tx %u%c: %04X %04X %04X %04X : ", Type, B ? 'B' : 'A', G[0], G[1], G[2], G[3]);
+
+if (B) {printf("\n"); return;}
+switch (Type)
+  {
+  case 1: // same as firmware log before trace
+    printf("RPC=%02u ECC=%02X PINC=%04X\n", G[1] & 0x1F, G[2] & 0xFF, G[3]);
+    break;
+
+  case 2:
+    {
+    uint8_t Segment = G[1] & 0x0F;
+    uint8_t AB = (G[1] >> 4) & 1;
+    char Text[5] = {Symbol(G[2] >> 8), Symbol(G[2] & 0xFF), Symbol(G[3] >> 8), Symbol(G[3] & 0xFF), 0};
+    if (AB != RT_ABflag) {RT_ABflag = AB; RT_Segments = 0; memset(RT, ' ', 64);} // new text
+    memcpy(RT + Segment * 4, Text, 4);
+    if (Segment >= RT_Segments) {RT_Segments = Segment + 1;}
+    printf("%s%s\n", Text, AB ? " (B)" : "");
+    if (Flags & RECORD_LAST)
+      {
+      size_t Len = RT_Segments * 4;
+      RT[Len] = 0;
+      while (Len && RT[Len - 1] == ' ') {RT[--Len] = 0;} // padding of last segment
+      printf("Sent 2A: %s\n", RT);
+      memset(RT + Len, ' ', 64 - Len);
+      }
+    break;
+    }
+
+  case 4:
+    {
+    long Year, Month, Day;
+    RDS_4A_DATE(G, Year, Month, Day);
+    uint8_t Offset = G[3] & 0x1F;
+    printf("%02ld-%02ld-%4ld %02u:%02u %c%02u:%02u\n", Day, Month, Year, ((G[2] & 1) << 4) | (G[3] >> 12), (G[3] >> 6) & 0x3F,
+           ((G[3] >> 5) & 1) ? '-' : '+', Offset / 2, (Offset & 1) * 30);
+    break;
+    }
+
+  case 7:
+    if (ID) {printf("ID=%u", ID);}
+    printf("\n");
+    Decoder[(Flags & RECORD_TX2) ? 1 : 0].Group(G, 0x0F); // prints message after its last group
+    break;
+
+  default:
+    printf("\n");
+    break;
+  }
+}
+
+// -------------------------------------------------------- Main
+int main(int argc, char **argv)
+{
+const char *In_Name = "-";
+for (int a = 1; a < argc; a++)
+  {
+  if (strcmp(argv[a], "-t") == 0) {Show_Time = true;}
+  else if (argv[a][0] == '-' && argv[a][1]) {fprintf(stderr, "Usage: %s [-t] [file|-]\n", argv[0]); return 2;}
+  else {In_Name = argv[a];}
+  }
+FILE *In = strcmp(In_Name, "-") == 0 ? stdin : fopen(In_Name, "rb");
+if (!In) {perror(In_Name); return 1;}
+
+// Frame is checked in Buf; when it is not a trace frame, its first byte is printed and search goes on from next byte
+uint8_t Buf[260];
+size_t Len = 0;
+int c;
+while (true)
+  {
+  if (Len == 0 || Buf[0] != FRAME_SYNC) // text
+    {
+    if (Len) {putchar(Buf[0]); memmove(Buf, Buf + 1, --Len); continue;}
+    if ((c = fgetc(In)) == EOF) {break;}
+    if (c != FRAME_SYNC) {putchar(c); if (c == '\n') {fflush(stdout);} continue;}
+    Buf[Len++] = c;
+    continue;
+    }
+
+  size_t Need = (Len >= 2) ? Buf[1] + 4 : 2; // SYNC LEN CMD..DATA CRC
+  if (Len < Need)
+    {
+    if ((c = fgetc(In)) == EOF) {break;}
+    Buf[Len++] = c;
+    continue;
+    }
+
+  bool Good = Buf[1] >= 2 && CRC16(Buf + 1, Buf[1] + 1) == Get16(Buf + Buf[1] + 2);
+  if (!Good) {putchar(Buf[0]); memmove(Buf, Buf + 1, --Len); continue;} // SYNC was text
+  if (Buf[2] == FRAME_TRACE && Buf[1] == RECORD_LEN + 2) {Record(Buf[3], Buf + 4);}
+  Len = 0;
+  fflush(stdout);
+  }
+for (size_t i = 0; i < Len; i++) {putchar(Buf[i]);}
+
+if (In != stdin) {fclose(In);}
+fflush(stdout);
+fprintf(stderr, "records %lu, dropped %lu\n", Records, Dropped);
+return Dropped ? 1 : 0;
+}
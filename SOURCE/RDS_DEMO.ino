@@ -1,413 +1,753 @@
-/* Paging LAB RDS Encoder V1.01
-
- * Version List:
- * - V1 - Start version
- * - V1.01 - Fix bug with long text messages more than 24 symbols; fix bug with Tone Only Messsges *
- *
- * Protocol description: https://en.wikipedia.org/wiki/Radio_Data_System
- * Datasheet: https://web.archive.org/web/20161020015638/http://www.nrscstandards.org/SG/nrsc-4-B.pdf
-
- * Transmitter chip: SI4713 (f.e. Adafruit SI4713 PCB)
- * Source for chip library: https://github.com/PE5PVB/si4713 Library updated for send 1A, 4A and 7A groups
- * Datasheet for chip: https://www.skyworksinc.com/-/media/Skyworks/SL/documents/public/application-notes/AN332.pdf
- *  
- * Description: 
- * - Tone Only Messages
- * - 10 digits Numeric Messages - use ":" for space symbol
- * - 18 digits Numeric Messages - use ":" for space symbol
- * - Aplphanimeric - up to 80 symbols
- * - Data and Time - Fixed. You can upgrade encdoder with any RTC module if you want. F.e. https://github.com/PaulStoffregen/DS1307RTC
- * - Monitor: turn ON for monitoring RDS packet sending
- * - Test message: ON/OFF; periodicaly send Numeric 10 digits format message
- * - Warnings: there is no validation of input data values, please enter the data correctly
- * - IMPORTANT: serial port baudrate = 57600; Terminal settings: No line Ending
- * - National/International Mode: Work only in National mode, you need read Country code from EEPROM or try all countries from 1 to F
- * - Pager`s Adrress: The pager address can be found on the back cover. If it is missing, you will have to read it from EEPROM I2C 24C02.
- *
- * FaceBook group about paging: https://www.facebook.com/groups/116072934759380                    
- */
-
-#include "si4713.h" //transmitter library
-
-bool overmod;
-int8_t inlevel;
-
-//Cycle Counters 
-long G_4A_Counter = millis();
-long G_1A_Counter = millis();
-long G_7A_Counter = millis();
-long G_2A_Counter = millis();
-
-
-static Config Cfg_Base; //create  default config
-
-//RTC
-SI4713 TX;
-
-void setup() {
-  Cfg_Base.cfg_Offset.All = 0x04; // default UTC offset
-  Cfg_Base.cfg_pi.All = 0x6277; // default PI, 6=Ukraine 0x6277
-    
-  Serial.begin(57600);
-  Serial.setTimeout(50); //default 1000 ms
-  
-  TX.Init(RESET_TX_PIN, 32768, 0x63);   // RST pin (use -1 when using external supervisor), Crystal: 32.768kHz, I2C address: 0x63
- 
-  uint8_t pn;
-  uint8_t chiprev;
- 
-  TX.Rev(pn, chiprev);                         // Receive Chipversion and revision Right: Detected chip: SI4113 Revision: 65
-  Serial.print("TX CHIP: SI41" + String(pn));
-  Serial.println(" Rev: " + String(chiprev));
-  
-  TX.Output(115, 4);                    // Output level: 115dBuV, antenna capacitor: 0.25pF * 4 = 1pF)
-  TX.Freq(Cfg_Base.cfg_Frequency);      // Set Output frequency
-  
-  TX.MPX_Enable(1);                     // 1 = Enable MPX Stereocoder
-  TX.MPX_Deviation(675);                // Set MPX pilot deviation to 6.75kHz
-  TX.MPX_Freq(19000);                   // Set MPX pilot to 19000Hz (19kHz)
-
-  TX.Audio_Deviation(7500);             // Set Audio deviation to 75.00kHz
-  TX.Audio_Mute(0);                     // Unmute audio
-  TX.Audio_PreEmphasis(50);             // Set Audio pre-emphasis to 50uS (can be switched to 75uS or 0 for no pre-emphasis)
-  TX.Audio_Limiter(0);                  // Disable Audio limiter
-  TX.Audio_AGC(1);                      // Enable Audio Dynamic Range Control
-  TX.Audio_Comp_Threshold(-40);         // Set Audio Dynamic Range Threshold to -40dBFS (max = 0dBFS)
-  TX.Audio_Comp_Attack(0);              // Set Audio Dynamic Range Attack time to 0.5mS (max value = 9 -> 5.0mS, stepsize is 0.5mS)
-  TX.Audio_Comp_Release(4);             // Set Audio Dynamic Range Release time to 1S (see p43 of application notes for other values)
-  TX.Audio_Comp_Gain(15);               // Set Audio Dynamic Range Gain to 15dB (max=20dB)
-  TX.Audio_Limiter_Release(102);        // Set Audio Limiter Release time to 5.01mS (see p44 of application notes for other values)
-
-  TX.RDS_PI(Cfg_Base.cfg_pi.All);       // Set RDS PI code
-  TX.RDS_AF(Cfg_Base.cfg_Frequency);    // Set RDS AF to 90.8MHz (use 0 to disable AF)
-  TX.RDS_PTY(10);                       // Set RDS PTY to Pop Music (see list of codes at https://www.electronics-notes.com/articles/audio-video/broadcast-audio/rds-radio-data-system-pty-codes.php)
-  TX.RDS_Deviation(200);                // Set RDS deviation to 2.00kHz
-  TX.RDS_COMP(0);                       // Set RDS Compressed code to not Compressed
-  TX.RDS_ART(0);                        // Set RDS Artificial Head code to Not artificial head
-  TX.RDS_MS(1);                         // Set RDS Mono/Stereo code to stereo
-  TX.RDS_TP(1);                         // Enable RDS Traffic Program
-  TX.RDS_TA(0);                         // Disable RDS Traffic Announcement
-  TX.RDS_MUSP(1);                       // Set RDS Music/Speech selection to Music
-  
-  TX.RDS_PS_MIX(0);                     // default=3; Sets the ratio of RDS PS (group 0A) and circular buffer/FIFO groups.  
-  Update_0A(); // Update radioname and parameters
-
-  TX.RDS_Enable(1);                     // 1 = Enable RDS encoder, 0 = Disable RDS encoder
-  TX.GPO(0,0,0);                        // Set GPO outputs 1,2 and 3 to low.
-  
-  ShowStatus();
-}
-
-// ----------------------------------------------- Loop ------------------------------------------
-void loop() {
-
-//--------------------------------------------------------------------------- TIMERS
-if (((millis() - G_4A_Counter) > G_4A_PERIOD) || (G_4A_Counter ==0 )) // send 4A each minute
-  {
-  TX.RDS_4A_TIME (Cfg_Base.cfg_pi.All, Cfg_Base.cfg_Bo, Cfg_Base.cfg_TP, Cfg_Base.cfg_PTY,
-                   Cfg_Base.cfg_Year, Cfg_Base.cfg_Month, Cfg_Base.cfg_Day, Cfg_Base.cfg_Hour, Cfg_Base.cfg_Minute, 
-                   Cfg_Base.cfg_Offset.refined.offset_sign, Cfg_Base.cfg_Offset.refined.offset_hour, Cfg_Base.cfg_Offset.refined.offset_minute*30, Cfg_Base.cfg_Monitor);
-  G_4A_Counter = millis();
-  }
-
-if ((millis() - G_1A_Counter) > G_1A_PERIOD) // send 1A Group each second
-   {
-    TX.RDS_1A_PIN (Cfg_Base.cfg_pi.All, Cfg_Base.cfg_Bo, Cfg_Base.cfg_TP, Cfg_Base.cfg_PTY, Cfg_Base.cfg_1A_Rpc, Cfg_Base.cfg_1A_Slc, Cfg_Base.cfg_1A_Pinc, Cfg_Base.cfg_Monitor);
-    G_1A_Counter = millis();
-   }
-
-if (((millis() - G_7A_Counter) > Cfg_Base.cfg_Test_Message_Period) && (Cfg_Base.cfg_Test_Message == ON)) // Send test Message
-   {
-    ADflagInvert();
-    Serial.println("Debug Messade>>" + Int2STR(G_7A_Counter, 10));
-    TX.RDS_7A_PAGING (Cfg_Base.cfg_pi.All, Cfg_Base.cfg_Bo, Cfg_Base.cfg_TP, Cfg_Base.cfg_PTY, Cfg_Base.cfg_7A_ADflag, DIG10, Cfg_Base.cfg_7A_Address, Int2STR(G_7A_Counter, 10), Cfg_Base.cfg_Monitor); 
-    G_7A_Counter = millis();
-   }
-   
-if (((millis() - G_2A_Counter) > Cfg_Base.cfg_2A_Period*1000)  && Cfg_Base.cfg_2A_Period !=0) // send Radiotext
-   {
-    TX.RDS_2A_RT (Cfg_Base.cfg_pi.All, Cfg_Base.cfg_Bo, Cfg_Base.cfg_TP, Cfg_Base.cfg_PTY, Cfg_Base.cfg_2A_ADflag, Cfg_Base.cfg_2A_Text, Cfg_Base.cfg_Monitor);
-    G_2A_Counter = millis();
-   }
-
-//----------------------------------------End Timers
-
-  if (Serial.available() > 0) {
-    
-    String Command = ""; //copmmand from terminal or Sprut
-    Command = Serial.readString(); // read command
-        
-    switch (Command.toInt()) { //parce command
-
-    case SET_MONITOR: //Monitor mode ON/OFF
-        SetMonitor();     
-        ShowStatus ();
-        break;
-
-    case SET_TEST_MESSAGE: //Test Message Mode ON/OFF
-        SetTestMessage();     
-        ShowStatus ();
-        break;
-    
-    case SEND_7A_TONE: //Send Tone Message
-
-        ADflagInvert(); //set new message flag                
-        TX.RDS_7A_PAGING (Cfg_Base.cfg_pi.All, Cfg_Base.cfg_Bo, Cfg_Base.cfg_TP, Cfg_Base.cfg_PTY, Cfg_Base.cfg_7A_ADflag, TONE, Cfg_Base.cfg_7A_Address, "AA", Cfg_Base.cfg_Monitor);
-        Serial.println("Tone Message>> Sent");
-        break;
-
-    case SEND_7A_NUM_10: //Send 10 Digits Numeric Message
-
-        ADflagInvert(); //set new message flag                
-        TX.RDS_7A_PAGING (Cfg_Base.cfg_pi.All, Cfg_Base.cfg_Bo, Cfg_Base.cfg_TP, Cfg_Base.cfg_PTY, Cfg_Base.cfg_7A_ADflag, DIG10, Cfg_Base.cfg_7A_Address, SetMessage ("Numeric Message [max=10]>"), Cfg_Base.cfg_Monitor);
-        break;
-
-    case SEND_7A_NUM_18: //Send 10 Digits Numeric Message
-
-        ADflagInvert(); //set new message flag                
-        TX.RDS_7A_PAGING (Cfg_Base.cfg_pi.All, Cfg_Base.cfg_Bo, Cfg_Base.cfg_TP, Cfg_Base.cfg_PTY, Cfg_Base.cfg_7A_ADflag, DIG18, Cfg_Base.cfg_7A_Address, SetMessage ("Numeric Message [max=18]>"), Cfg_Base.cfg_Monitor);
-        break;
-
-    case SEND_7A_ALPHA: //Send debug RDS packet
-        
-        ADflagInvert(); //set new message flag                
-        TX.RDS_7A_PAGING (Cfg_Base.cfg_pi.All, Cfg_Base.cfg_Bo, Cfg_Base.cfg_TP, Cfg_Base.cfg_PTY, Cfg_Base.cfg_7A_ADflag, ALPHA, Cfg_Base.cfg_7A_Address, SetMessage ("Text Message [max=24]>"), Cfg_Base.cfg_Monitor); //Cfg_Base.cfg_Monitor
-        break;
-    
-     case SHOW_STATUS: //Send debug RDS packet
-        ShowStatus ();
-        break;
-
-     case SET_FRQ: //Set frequency
-        SetFRQ();     
-        ShowStatus ();
-        break;
-
-      case SET_COUNTRY: //Set Country Code
-        SetCountry();     
-        ShowStatus ();
-        break;
- 
-      case SET_7A_ADDRESS: //Set pager address
-        Set7AAddress();     
-        ShowStatus ();
-        break;
-
-      default:
-      Serial.println("Command error");
-      break;
-    }
-    
-  }
-
-}// ================================== End Loop
-
-// FUNCTIONS
-
-// --------------------------------- Show Status ------------------------
-void ShowStatus()
-{
-    
-  Serial.println("---------< Paging LAB * RDS Encoder V1 >----------");
-  Serial.println("[xx]Radio Name: " + Cfg_Base.cfg_Radio_Name1 + "|" + Cfg_Base.cfg_Radio_Name2 + "|" + Cfg_Base.cfg_Radio_Name3 + "|" + Cfg_Base.cfg_Radio_Name4);
-  Serial.println("[xx]Radio Text: " + Cfg_Base.cfg_2A_Text );
-  
-  //TIME and Frequency
-  String tmp_Offset_str = "+"; //offset output string
-  if (Cfg_Base.cfg_Offset.refined.offset_sign == 1) {tmp_Offset_str = "-";} //parce offset sign
-  tmp_Offset_str = tmp_Offset_str + Int2STR(Cfg_Base.cfg_Offset.refined.offset_hour,2); //parce offset hour
-  if (Cfg_Base.cfg_Offset.refined.offset_minute == 1) //parce offset minute
-  {tmp_Offset_str = tmp_Offset_str + ":30";} 
-  else
-  {tmp_Offset_str = tmp_Offset_str + ":00";} 
-  String tmp_FRQ = Int2STR(Cfg_Base.cfg_Frequency,5); //**** FREQUENCY *****
-  Serial.println("[xx]UTC:" + Int2STR(Cfg_Base.cfg_Day,2) + "-" + Int2STR(Cfg_Base.cfg_Month,2) + "-" + Int2STR(Cfg_Base.cfg_Year,4) + " " +  Int2STR(Cfg_Base.cfg_Hour,2) + ":" + Int2STR(Cfg_Base.cfg_Minute,2) + " " + tmp_Offset_str + " [21]FRQ:" + tmp_FRQ.substring(0,3) + "." + tmp_FRQ.substring(3,4) + "MHz");
-
-  // Help and monitoring  
-  String tmp_Monitor = "OFF";
-  if (Cfg_Base.cfg_Monitor==ON) {tmp_Monitor = "ON";}
-  String tmp_Message = "OFF";
-  if (Cfg_Base.cfg_Test_Message==ON) {tmp_Message = "ON";}
-  Serial.println("[11]Help [12]Monitor:" + tmp_Monitor + " [13]Test Message:" + tmp_Message);
-  // Country and address  
-  Serial.println("[31]Country:"+ Int2HEX(Cfg_Base.cfg_pi.refined.pi_country,1) +" PI:" + Int2HEX(Cfg_Base.cfg_pi.All,4) + " [32]Address:"+ Int2STR(Cfg_Base.cfg_7A_Address,6));
-  Serial.println("[71]Tone [72]Num_10 [73]Num_18 [74]Alphanumeric");
-  Serial.println("--------------------------------------------------");
-  
-}
-// =============================================================================================
-
-// --------- Set Frequency Menu ------------------
-void SetFRQ()
-{
-String Date_Input = "";
-byte flag = 0;
-
-Serial.print ("Frequency [xxx.x]>" );
-while (flag == 0)
-{
-if (Serial.available()) // waiting input data
-  {
-    Date_Input = Serial.readString();
-    flag = 1;
-
-    uint16_t tmp_FRQ = Date_Input.substring(0,3).toInt() * 100 + Date_Input.substring(4,6).toInt()*10; 
-    
-    if (tmp_FRQ<=7600 || tmp_FRQ>=10800)
-    {
-      Serial.println("FRQ: Error");
-    }
-    else
-    {
-      Cfg_Base.cfg_Frequency = tmp_FRQ; //save config
-      TX.Freq(Cfg_Base.cfg_Frequency); //set base frq
-      TX.RDS_AF(Cfg_Base.cfg_Frequency);  //set RDS frq
-    }
-  }
-}
-}
-//=====================================================================
-
-//----------------------------- Set Country CODE  -----------------------
-void SetCountry()
-{  
-String Input = "";
-byte flag = 0;
-
-Serial.print ("Country [xx]>" );
-while (flag == 0)
-{
-if (Serial.available()) // waiting input data
-  {
-    Input = Serial.readString(); 
-    flag = 1;
-    
-    if (Input.toInt() != 0) //validate country code
-    {
-      Cfg_Base.cfg_pi.refined.pi_country = Input.toInt(); //save to config
-      TX.RDS_PI(Cfg_Base.cfg_pi.All); //update PI      
-    }
-    Serial.println(Input);
-  }
-}
-}
-//=================================================================================
-
-//------------------------------- Update radioname and parameters for 0A Group ------------------------------------------------
-void Update_0A() 
-{ 
-  TX.RDS_PS(Cfg_Base.cfg_Radio_Name1, 0);               // Set PS Message (max 8 characters) and position number in carousel
-  TX.RDS_PS(Cfg_Base.cfg_Radio_Name2, 1);               // Set PS Message (max 8 characters) and position number in carousel
-  TX.RDS_PS(Cfg_Base.cfg_Radio_Name3, 2);               // Set PS Message (max 8 characters) and position number in carousel
-  TX.RDS_PS(Cfg_Base.cfg_Radio_Name4, 3);               // Set PS Message (max 8 characters) and position number in carousel
-  TX.RDS_PSCOUNT(Cfg_Base.cfg_0A_slots, Cfg_Base.cfg_0A_speed);                // Number of PS Messages in carousel(4), (min 1, max 12),  and carousel speed (10) (min 1, max 255);
-}
-//=================================================================================
-
-// -----------------------------  Set Pager Address -------------------------------
-void Set7AAddress()
-
-{  
-String Input = "";
-byte flag = 0;
-
-Serial.print ("Address [xxxxxx]>" );
-while (flag == 0)
- {
- if (Serial.available()) // waiting input data
-  {
-    Input = Serial.readString(); 
-    flag = 1;
-    
-    Cfg_Base.cfg_7A_Address = Input.toInt();
-    Serial.println(Int2STR(Cfg_Base.cfg_7A_Address,6));
-  }
- }
-}
-//=================================================================================
-
-// -------------------------- A/B Invertion for new message -----------------------
-void ADflagInvert()
-{
-  if (Cfg_Base.cfg_7A_ADflag == 0) //Set A/B flag as new message
-     {Cfg_Base.cfg_7A_ADflag = 1;}
-  else
-     {Cfg_Base.cfg_7A_ADflag = 0;}
-}        
-//=================================================================================
-
-// -------------------------- Enter New Message -----------------------------------
-String SetMessage(String Hint)
-{
-String Date_Input = "Error";
-byte flag = 0;
-
-Serial.print (Hint + "> " );
-  while (flag == 0)
-  {
-    if (Serial.available()) // waiting input data
-      {
-        Date_Input = Serial.readString();
-        flag = 1;
-        Serial.println (Date_Input);
-        return Date_Input;   
-      } 
-  }
-}
-//=================================================================================
-
-//------------------------- Set Monitor Mode --------------------------------------
-void SetMonitor()
-{  
-String Input = "";
-byte flag = 0;
-
-Serial.print ("Monitor [0/1]>" );
-while (flag == 0)
-  {
-    if (Serial.available()) // waiting input data
-      {
-        Input = Serial.readString(); 
-        flag = 1;
-    
-        if (Input.toInt() == 0) //Turn OFF
-          {
-            Cfg_Base.cfg_Monitor = OFF; //save to config
-          }
-          else 
-          {
-            Cfg_Base.cfg_Monitor = ON; //save to config
-          }
-        Serial.println(Input);
-      }
-  }
-}
-//=================================================================================
-
-//------------------------- Set Test Message Mode --------------------------------------
-void SetTestMessage()
-{  
-String Input = "";
-byte flag = 0;
-
-Serial.print ("Test Message [0/1]>" );
-while (flag == 0)
- {
-  if (Serial.available()) // waiting input data
-   {
-    Input = Serial.readString(); 
-    flag = 1;
-    
-    if (Input.toInt() == OFF) //Turn OFF
-    {
-      Cfg_Base.cfg_Test_Message = OFF; //save to config
-    }
-    else 
-    {
-      Cfg_Base.cfg_Test_Message = ON; //save to config
-    }
-    Serial.println(Input);
-   } 
- }
-}
-//=================================================================================
+/* Paging LAB RDS Encoder V1.01
+
+ * Version List:
+ * - V1 - Start version
+ * - V1.01 - Fix bug with long text messages more than 24 symbols; fix bug with Tone Only Messsges *
+ *
+ * Protocol description: https://en.wikipedia.org/wiki/Radio_Data_System
+ * Datasheet: https://web.archive.org/web/20161020015638/http://www.nrscstandards.org/SG/nrsc-4-B.pdf
+
+ * Transmitter chip: SI4713 (f.e. Adafruit SI4713 PCB)
+ * Source for chip library: https://github.com/PE5PVB/si4713 Library updated for send 1A, 4A and 7A groups
+ * Datasheet for chip: https://www.skyworksinc.com/-/media/Skyworks/SL/documents/public/application-notes/AN332.pdf
+ *  
+ * Description: 
+ * - Tone Only Messages
+ * - 10 digits Numeric Messages - use ":" for space symbol
+ * - 18 digits Numeric Messages - use ":" for space symbol
+ * - Aplphanimeric - up to 80 symbols
+ * - Variable-length Numeric (up to 80 digits) and Function (hex digits) Messages; numeric message goes in the format with fewest groups (short number as 10 digits, more than 18 digits as variable-length), groups saved are in menu [14]
+ * - Paging queue: several messages to many pagers wait for air time, A/B flag is kept for each pager (repeat of the same message keeps flag)
+ * - Repeats: each message can be sent again [35] times, [36] ms apart, next spacing [37] % of the last one (or own policy in frame CMD_PAGES_REPEAT); repeat goes between new messages, keeps A/B flag and sets repeat flag, call counter of pager counts new messages (alpha and variable-length); a new message to the pager ends repeats of its older one
+ * - Urgent messages: flag PAGE_URGENT in type of CMD_PAGES (gateway type ALPHA!) puts the message before others; a message on air with more than 4 groups left is interrupted and sent again from its start, its groups are taken out of chip FIFO (MTBUFF) and 1A/4A/2A groups are loaded again in their slots
+ * - Radio text: menu [41] or frame CMD_RT; text is a table of 2A segments, after a change only changed segments are sent (A/B flag toggles for new text), whole text is sent again one segment at a time in [42] seconds, slower while pages wait (radiotext.h)
+ * - Country sweep: menu [33] or frame CMD_SWEEP sends one message (encoded once) with each country code 1..F, PI changes only when chip FIFO is empty; [34] or CMD_SWEEP_STATE stops it when pager got the message and shows country, passes and air time (sweep.h)
+ * - Two transmitters: TX_COUNT 2 in config.h drives second SI4713 (own I2C address or bus, [22] frequency); TX_SIMULCAST sends the same groups to both chips, TX_SPREAD spreads pages over chips and keeps each pager on its chip (scheduler.h); commands of both chips overlap on I2C
+ * - Host build: HOST/Makefile builds encoder for Linux with Arduino/Wire stand-ins; ./bench shows ns per group, groups/s and allocations per message
+ * - RDS modulator: HOST/rdsmod renders logged groups (Tx xx: AAAA BBBB CCCC DDDD) to 57 kHz RDS subcarrier, WAV or raw 16 bits, for SDR playback
+ * - RDS decoder: HOST/rdsdec decodes 57 kHz subcarrier (WAV/raw) to 0A/1A/2A/4A groups and paging messages; make loopback checks encoder -> modulator -> decoder: each decoded page must be the sent one (rdsdec -c)
+ * - Chip simulator: HOST/chipsim runs the whole firmware against an SI4713 model (CTS times, 54-group FIFO on the air clock, PS mix, overflow) in virtual time; prints aired groups for rdsmod, throughput, page latency and chip counters (make sim), 1A/4A which go to air in another slot after the FIFO is emptied for an urgent page (make urgent); make pagers sends repeated and urgent messages to shared pagers and checks that each pager gets them in order
+ * - No heap allocation in encoder and monitor log (no String in si4713.h/tools.h); make soak checks it over 100000 pages
+ * - Serial control: binary frames with CRC (protocol.h) for paging gateway, batch of pages in one frame with reply for each page; text menu works as before and never stops the encoder
+ * - Paging gateway: HOST/gateway is a Linux daemon (one epoll loop) which takes pages from clients on a Unix socket or named pipe, sends them in CMD_PAGES batches as the encoder queue has place, reports ACK/AIR with latency for each page; make gwtest runs it on a pty against chipsim
+ * - Counters: chip command time, CTS spins, groups by type, FIFO overflows, queue, page latency, 1A/4A misses and longest loop(), always on (stats.h); menu [14]/[15] or frame CMD_STATS
+ * - Cold start: chip reset 2 ms, setup() properties in one table sent back to back paced by CTS, reset defaults are skipped; boot to first RDS group is boot_ms in menu [14]
+ * - Chip shadow: SI4713 keeps last written properties, PS, frequency and power; same value is not sent again; menu [16] / TX.Resync() sends all of them after chip reset
+ * - Config in EEPROM: settings changed from menu or frames (frequency, country, pager address, monitor, test message) are kept over reset; image with version and CRC, defaults when it doesn't match, only changed bytes are written (storage.h)
+ * - Data and Time - starts from Config (UTC) and runs from millis(); 4A goes in the first slot of each UTC minute, set time with frame CMD_TIME. You can upgrade encdoder with any RTC module if you want (Clock.RTC in clock.h). F.e. https://github.com/PaulStoffregen/DS1307RTC
+ * - Monitor: turn ON for monitoring RDS packet sending; groups are kept as binary records (trace.h) and sent in free time of serial port, HOST/tracedec prints them as text lines
+ * - Test message: ON/OFF; periodicaly send Numeric 10 digits format message
+ * - Warnings: there is no validation of input data values, please enter the data correctly
+ * - IMPORTANT: serial port baudrate = 57600; Terminal settings: No line Ending
+ * - National/International Mode: Work only in National mode, you need read Country code from EEPROM or try all countries from 1 to F
+ * - Pager`s Adrress: The pager address can be found on the back cover. If it is missing, you will have to read it from EEPROM I2C 24C02.
+ *
+ * FaceBook group about paging: https://www.facebook.com/groups/116072934759380                    
+ */
+
+#include "si4713.h" //transmitter library (with serial control port and monitor trace)
+#include "paging.h" //paging queue
+#include "sweep.h" //one message with each country code
+#include "clock.h" //UTC for 4A and slot timing
+#include "radiotext.h" //2A segments
+#include "sequencer.h" //air-time slots for groups
+#include "scheduler.h" //several transmitters
+#include "storage.h" //config in EEPROM
+
+bool overmod;
+int8_t inlevel;
+
+//Cycle Counters 
+unsigned long G_7A_Counter = millis();
+
+
+static Config Cfg_Base; //create  default config
+
+//RTC
+SI4713 TX;
+PagingQueue Pages; //messages waiting for air time
+GroupSequencer Sequencer; //plans 1A, 4A, 7A and 2A groups in air-time slots
+TimeService Clock; //UTC from Config date/time or RTC, then millis()
+CountrySweep Sweep; //message for pager with unknown country code
+#if TX_COUNT > 1
+SI4713 TX2; //second transmitter (TX_MODE in config.h)
+PagingQueue Pages2;
+GroupSequencer Sequencer2;
+#endif
+TxScheduler Transmitters; //drives all chips: simulcast or pages spread over chips
+ControlPort Port; //commands from terminal or paging gateway
+byte Menu_State = 0; //0 = waiting for command, else menu code waiting for its value
+
+void setup() {
+  Cfg_Base.cfg_Offset.All = 0x04; // default UTC offset
+  Cfg_Base.cfg_pi.All = 0x6277; // default PI, 6=Ukraine 0x6277
+    
+  Serial.begin(57600);
+  Serial.println(Storage.Load(Cfg_Base) ? F("Config>> EEPROM") : F("Config>> Defaults")); // changed settings are kept over reset
+  
+  TX.Init(RESET_TX_PIN, 32768, 0x63);   // RST pin (use -1 when using external supervisor), Crystal: 32.768kHz, I2C address: 0x63
+  Start_TX(TX, Cfg_Base.cfg_Frequency);
+  Transmitters.Add(TX, Pages, Sequencer);
+#if TX_COUNT > 1
+  TX2.Init(TX2_RESET_PIN, 32768, TX2_ADDRESS, TX2_BUS, TX2_INT_PIN); // commands of both chips overlap from here (Transmitters.Poll)
+  Start_TX(TX2, Cfg_Base.cfg_Frequency2);
+  Transmitters.Add(TX2, Pages2, Sequencer2);
+#endif
+  
+  Clock.Begin(Cfg_Base); // UTC from RTC (Clock.RTC) or Config
+  Clock.Run(TX, Cfg_Base); // first 4A is ready
+  Transmitters.Begin(TX_MODE); // start air-time slots
+  Transmitters.Run(Cfg_Base, Clock, Sweep); // first groups before status text, boot time is in TX.First_Group
+  ShowStatus();
+}
+
+// ---------------------------- Chip settings after Init() ------------------------
+void Start_TX(SI4713 &Chip, uint16_t Frequency)
+{
+  uint8_t pn;
+  uint8_t chiprev;
+ 
+  if (Chip.Rev(pn, chiprev))                     // Receive Chipversion and revision Right: Detected chip: SI4113 Revision: 65
+     {
+       Serial.print(F("TX CHIP: SI41"));
+       Serial.print(pn);
+       Serial.print(F(" Rev: "));
+       Serial.println(chiprev);
+     }
+  else {Serial.println(F("TX CHIP: no answer to GET_REV"));}
+  
+  Chip.Output(115, 4);                    // Output level: 115dBuV, antenna capacitor: 0.25pF * 4 = 1pF)
+  Chip.Freq(Frequency);                   // Set Output frequency
+  
+  Update_0A(Chip); // Update radioname and parameters
+
+  // Properties are sent back to back, each one after CTS of previous command; values equal to reset defaults are skipped
+  type_Property Init_Table[] =
+  {
+    {0x2101, 7500},                        // Audio deviation 75.00kHz
+    {0x2102, 675},                         // MPX pilot deviation 6.75kHz
+    {0x2107, 19000},                       // MPX pilot 19000Hz (19kHz)
+    {0x2105, 0x0000},                      // Unmute audio
+    {0x2106, 0x0001},                      // Audio pre-emphasis 50uS (0x0000 = 75uS, 0x0002 = no pre-emphasis)
+    {0x2200, 0x0001},                      // Audio limiter disabled, Audio Dynamic Range Control enabled
+    {0x2201, (uint16_t)-40},               // Audio Dynamic Range Threshold -40dBFS (max = 0dBFS)
+    {0x2202, 0},                           // Audio Dynamic Range Attack time 0.5mS (max value = 9 -> 5.0mS, stepsize is 0.5mS)
+    {0x2203, 4},                           // Audio Dynamic Range Release time 1S (see p43 of application notes for other values)
+    {0x2204, 15},                          // Audio Dynamic Range Gain 15dB (max=20dB)
+    {0x2205, 102},                         // Audio Limiter Release time 5.01mS (see p44 of application notes for other values)
+    {0x2C01, Cfg_Base.cfg_pi.All},         // RDS PI code
+    {0x2C06, (uint16_t)(0xDD95 + Frequency)}, // RDS AF = output frequency (0xE0E0 = no AF)
+    {0x2C03, (10 << 5) | bit(12) | bit(10) | bit(3)}, // RDS PTY 10 Pop Music, not Compressed, not artificial head, stereo, TP on, TA off, Music
+    {0x2103, 200},                         // RDS deviation 2.00kHz
+    {0x2C02, 0},                           // RDS PS mix, default=3: 0A only when FIFO is empty
+    {0x2100, 0x0007}                       // Enable MPX Stereocoder and RDS encoder, last: PS and RDS settings are ready
+  };
+  Chip.Set_Properties(Init_Table, sizeof(Init_Table) / sizeof(Init_Table[0]));
+  Chip.GPO(0,0,0);                        // Set GPO outputs 1,2 and 3 to low.
+}
+
+// ----------------------------------------------- Loop ------------------------------------------
+void loop() {
+unsigned long Loop_Start = micros(); // for Stats
+
+Transmitters.Poll(); // send queued commands to the chips
+Transmitters.Run(Cfg_Base, Clock, Sweep); // 1A, 4A, 7A and 2A groups into air-time slots
+Port.Drain(); // Serial buffer has only 64 bytes, I2C of groups takes the most time of loop
+if (Sweep.State == SWEEP_DONE) {ShowSweep();} // PI of Config is on air again
+
+//--------------------------------------------------------------------------- TIMERS
+if (((millis() - G_7A_Counter) > (unsigned long)Cfg_Base.cfg_Test_Message_Period) && (Cfg_Base.cfg_Test_Message == ON)) // Send test Message
+   {
+    char Text[11]; // 10 digits
+    Int2STR(Text, G_7A_Counter, 10);
+    Serial.print(F("Debug Messade>>"));
+    Serial.println(Text);
+    Transmitters.Submit (Cfg_Base.cfg_7A_Address, DIG10, Text); 
+    G_7A_Counter = millis();
+   }
+
+
+//----------------------------------------End Timers
+
+switch (Port.Poll()) // commands, never waits for input
+  {
+    case PORT_FRAME: DoFrame(); break;
+    case PORT_LINE:  DoMenu(Port.Line()); break;
+  }
+
+Trace.Drain(); // monitor records in free time of serial port
+Port.Drain();
+Clock.Run(TX, Cfg_Base); // 4A of next minute
+Storage.Run(Cfg_Base); // changed settings to EEPROM
+EncoderStats::Add(Stats.Loop_Time, micros() - Loop_Start);
+
+}// ================================== End Loop
+
+// FUNCTIONS
+
+// --------------------------------- Show Status ------------------------
+void ShowStatus()
+{
+    
+  char Tmp[11]; // for numbers
+  Serial.println(F("---------< Paging LAB * RDS Encoder V1 >----------"));
+  Serial.print(F("[xx]Radio Name: "));
+  Serial.print(Cfg_Base.cfg_Radio_Name1); Serial.print('|');
+  Serial.print(Cfg_Base.cfg_Radio_Name2); Serial.print('|');
+  Serial.print(Cfg_Base.cfg_Radio_Name3); Serial.print('|');
+  Serial.println(Cfg_Base.cfg_Radio_Name4);
+  Serial.print(F("[41]Radio Text: "));
+  Serial.println(Cfg_Base.cfg_2A_Text);
+  Serial.print(F("[42]Radio Text Period:")); Serial.print(Cfg_Base.cfg_2A_Period);
+  Serial.print(F("s A/B:")); Serial.println(Cfg_Base.cfg_2A_ADflag ? F("B") : F("A"));
+  
+  //TIME and Frequency
+  Serial.print(F("[xx]UTC:"));
+  int Year, Month, Day;
+  byte Hour, Minute;
+  Clock.Date(Clock.Seconds(millis()), Year, Month, Day, Hour, Minute);
+  Serial.print(Int2STR(Tmp, Day, 2)); Serial.print('-');
+  Serial.print(Int2STR(Tmp, Month, 2)); Serial.print('-');
+  Serial.print(Int2STR(Tmp, Year, 4)); Serial.print(' ');
+  Serial.print(Int2STR(Tmp, Hour, 2)); Serial.print(':');
+  Serial.print(Int2STR(Tmp, Minute, 2)); Serial.print(' ');
+  Serial.print((Cfg_Base.cfg_Offset.refined.offset_sign == 1) ? F("-") : F("+")); //parce offset sign
+  Serial.print(Int2STR(Tmp, Cfg_Base.cfg_Offset.refined.offset_hour, 2)); //parce offset hour
+  Serial.print((Cfg_Base.cfg_Offset.refined.offset_minute == 1) ? F(":30") : F(":00")); //parce offset minute
+  Int2STR(Tmp, Cfg_Base.cfg_Frequency, 5); //**** FREQUENCY ***** 09080 = 090.8MHz
+  Serial.print(F(" [21]FRQ:"));
+  Serial.write((const uint8_t *)Tmp, 3); Serial.print('.'); Serial.print(Tmp[3]); Serial.println(F("MHz"));
+#if TX_COUNT > 1
+  Int2STR(Tmp, Cfg_Base.cfg_Frequency2, 5);
+  Serial.print(F("[22]FRQ2:"));
+  Serial.write((const uint8_t *)Tmp, 3); Serial.print('.'); Serial.print(Tmp[3]); Serial.print(F("MHz "));
+  Serial.println((Transmitters.Mode == TX_SPREAD) ? F("Spread") : F("Simulcast"));
+#endif
+
+  // Help and monitoring  
+  Serial.print(F("[11]Help [12]Monitor:"));
+  Serial.print((Cfg_Base.cfg_Monitor == ON) ? F("ON") : F("OFF"));
+  Serial.print(F(" [13]Test Message:"));
+  Serial.println((Cfg_Base.cfg_Test_Message == ON) ? F("ON") : F("OFF"));
+  // Country and address  
+  Serial.print(F("[31]Country:")); Serial.print(Int2HEX(Tmp, Cfg_Base.cfg_pi.refined.pi_country, 1));
+  Serial.print(F(" PI:")); Serial.print(Int2HEX(Tmp, Cfg_Base.cfg_pi.All, 4));
+  Serial.print(F(" [32]Address:")); Serial.println(Int2STR(Tmp, Cfg_Base.cfg_7A_Address, 6));
+  Serial.println(F("[33]Country Sweep [34]Sweep Received"));
+  Serial.print(F("[35]Repeats:")); Serial.print(Cfg_Base.cfg_7A_Repeat.Count);
+  Serial.print(F(" [36]Spacing:")); Serial.print(Cfg_Base.cfg_7A_Repeat.Spacing);
+  Serial.print(F("ms [37]Backoff:")); Serial.print(Cfg_Base.cfg_7A_Repeat.Backoff); Serial.println('%');
+  Serial.println(F("[71]Tone [72]Num_10 [73]Num_18 [74]Alphanumeric [75]Num_Var [76]Function"));
+  Serial.println(F("[14]Stats [15]Reset Stats [16]Resync chip"));
+  Serial.println(F("--------------------------------------------------"));
+  
+}
+// =============================================================================================
+
+// --------------------------------- Counters -----------------------------------
+void PrintStat(const __FlashStringHelper *Name, uint32_t Value)
+{
+  Serial.print(Name);
+  Serial.print('=');
+  Serial.println(Value);
+}
+//=================================================================================
+
+void PrintHistogram(const __FlashStringHelper *Name, const type_Histogram &Histogram)
+{
+  Serial.print(Name);
+  Serial.print('=');
+  Serial.print(Histogram.Count);
+  Serial.print(',');
+  Serial.print(Histogram.Max);
+  for (uint8_t i = 0; i < STATS_BUCKETS; i++) {Serial.print(','); Serial.print(Histogram.Bucket[i]);}
+  Serial.println();
+}
+//=================================================================================
+
+void ShowStats()
+// one value in line: "name=value", histogram: "name=count,max,bucket0,...,bucket15" (stats.h)
+{
+  PrintStat(F("i2c_commands"), Stats.I2C_Commands);
+  PrintStat(F("cts_spins"), Stats.CTS_Spins);
+  PrintStat(F("chip_errors"), Transmitters.Errors()); // all chips
+  PrintStat(F("fifo_overflows"), Transmitters.Overflows());
+  PrintStat(F("fifo_underflows"), Transmitters.Underflows());
+  PrintStat(F("sync_missed"), Transmitters.Missed());
+  PrintStat(F("trace_dropped"), Trace.Dropped);
+  PrintStat(F("queue_max"), Stats.Queue_Max);
+  PrintStat(F("groups_saved"), Stats.Groups_Saved);
+  PrintStat(F("repeats"), Stats.Repeats);
+  PrintStat(F("repeats_dropped"), Stats.Repeats_Dropped);
+  PrintStat(F("preemptions"), Stats.Preemptions);
+  PrintStat(F("groups_reloaded"), Stats.Groups_Reloaded);
+  PrintStat(F("queue_waiting"), Transmitters.Count());
+  PrintStat(F("bad_frames"), Port.Bad_Frames);
+  PrintStat(F("boot_ms"), TX.First_Group);
+  Serial.print(F("groups="));
+  for (uint8_t i = 0; i < 16; i++) {if (i) {Serial.print(',');} Serial.print(Stats.Groups[i]);} // by group type 0..15
+  Serial.println();
+  PrintHistogram(F("i2c_us"), Stats.I2C_Time);
+  PrintHistogram(F("page_ms"), Stats.Page_Latency);
+  PrintHistogram(F("urgent_ms"), Stats.Urgent_Latency);
+  PrintHistogram(F("loop_us"), Stats.Loop_Time);
+  PrintHistogram(F("time_offset_ms"), Stats.Time_Offset);
+  Serial.print(F("time_last_ms="));
+  Serial.println(Clock.Offset);
+}
+//=================================================================================
+
+// ------------------- Counters for frame CMD_STATS, return length (0 = no item) --
+uint8_t StatsItem(uint8_t Item, uint8_t *Out)
+{
+const type_Histogram *Histogram = 0;
+
+switch (Item)
+  {
+    case 0:
+      Put32(Out, Stats.I2C_Commands);
+      Put32(Out + 4, Stats.CTS_Spins);
+      Put16(Out + 8, Transmitters.Errors());
+      Put16(Out + 10, Transmitters.Overflows());
+      Put16(Out + 12, Transmitters.Underflows());
+      Put16(Out + 14, Transmitters.Missed());
+      Put16(Out + 16, Trace.Dropped);
+      Out[18] = Stats.Queue_Max;
+      Out[19] = Transmitters.Count();
+      Put16(Out + 20, Port.Bad_Frames);
+      Put16(Out + 22, TX.First_Group);
+      Put32(Out + 24, Stats.Groups_Saved);
+      Put32(Out + 28, Stats.Repeats);
+      Put16(Out + 32, Stats.Repeats_Dropped);
+      Put16(Out + 34, Stats.Preemptions);
+      Put16(Out + 36, Stats.Groups_Reloaded);
+      return 38;
+
+    case 1:
+    case 2:
+      for (uint8_t i = 0; i < 8; i++) {Put32(Out + i * 4, Stats.Groups[(Item - 1) * 8 + i]);}
+      return 32;
+
+    case 3: Histogram = &Stats.I2C_Time; break;
+    case 4: Histogram = &Stats.Page_Latency; break;
+    case 5: Histogram = &Stats.Loop_Time; break;
+    case 6: Histogram = &Stats.Time_Offset; break;
+    case 7: Histogram = &Stats.Urgent_Latency; break;
+    default: return 0;
+  }
+
+Put32(Out, Histogram->Count);
+Put32(Out + 4, Histogram->Max);
+for (uint8_t i = 0; i < STATS_BUCKETS; i++) {Put16(Out + 8 + i * 2, Histogram->Bucket[i]);}
+return 8 + STATS_BUCKETS * 2;
+}
+//=================================================================================
+
+void ResetStats()
+{
+  Stats.Reset();
+  Transmitters.Reset_Counters();
+  Trace.Dropped = 0;
+  Port.Bad_Frames = 0;
+}
+//=================================================================================
+
+// --------------------------------- Text menu ----------------------------------
+void DoMenu(const char *Input)
+{
+byte State = Menu_State;
+Menu_State = 0; // next line is command again
+
+switch (State)
+  {
+    case 0: // command
+      switch (atoi(Input))
+        {
+          case SHOW_STATUS:      ShowStatus(); break;
+          case SHOW_STATS:       ShowStats(); break;
+          case RESET_STATS:      ResetStats(); Serial.println(F("Stats>> Reset")); break;
+          case RESYNC_TX:        for (uint8_t i = 0; i < Transmitters.Lanes; i++) {Transmitters.TX[i]->Resync();} Serial.println(F("TX>> Resync")); break;
+          case SET_MONITOR:      Serial.print(F("Monitor [0/1]>")); Menu_State = SET_MONITOR; break;
+          case SET_TEST_MESSAGE: Serial.print(F("Test Message [0/1]>")); Menu_State = SET_TEST_MESSAGE; break;
+          case SET_FRQ:          Serial.print(F("Frequency [xxx.x]>")); Menu_State = SET_FRQ; break;
+          case SET_FRQ2:         Serial.print(F("Frequency 2 [xxx.x]>")); Menu_State = SET_FRQ2; break;
+          case SET_COUNTRY:      Serial.print(F("Country [xx]>")); Menu_State = SET_COUNTRY; break;
+          case SET_7A_ADDRESS:   Serial.print(F("Address [xxxxxx]>")); Menu_State = SET_7A_ADDRESS; break;
+          case SET_7A_REPEATS:   Serial.print(F("Repeats [0..255]>")); Menu_State = SET_7A_REPEATS; break;
+          case SET_7A_SPACING:   Serial.print(F("Repeat Spacing [ms]>")); Menu_State = SET_7A_SPACING; break;
+          case SET_7A_BACKOFF:   Serial.print(F("Repeat Backoff [%]>")); Menu_State = SET_7A_BACKOFF; break;
+          case SET_2A_TEXT:      Serial.print(F("Radio Text [max=64]>> ")); Menu_State = SET_2A_TEXT; break;
+          case SET_2A_PERIOD:    Serial.print(F("Radio Text Period [s, 0=OFF]>")); Menu_State = SET_2A_PERIOD; break;
+          case SWEEP_7A:         Serial.print(F("Sweep Message [max=80]>> ")); Menu_State = SWEEP_7A; break;
+          case SWEEP_STOP:       if (!Sweep.Stop()) {Serial.println(F("Sweep>> Not running"));} break;
+          case SEND_7A_TONE:     SubmitMessage(TONE, "AA"); break;
+          case SEND_7A_NUM_10:   Serial.print(F("Numeric Message [max=10]>> ")); Menu_State = SEND_7A_NUM_10; break;
+          case SEND_7A_NUM_18:   Serial.print(F("Numeric Message [max=18]>> ")); Menu_State = SEND_7A_NUM_18; break;
+          case SEND_7A_ALPHA:    Serial.print(F("Text Message [max=80]>> ")); Menu_State = SEND_7A_ALPHA; break;
+          case SEND_7A_NUM_VAR:  Serial.print(F("Numeric Message [max=80]>> ")); Menu_State = SEND_7A_NUM_VAR; break;
+          case SEND_7A_FUNC:     Serial.print(F("Function Message [hex, max=80]>> ")); Menu_State = SEND_7A_FUNC; break;
+          default:               Serial.println(F("Command error")); break;
+        }
+      break;
+
+    case SET_FRQ:
+    case SET_FRQ2:
+      if (!SetParam(State, ParseFRQ(Input))) {Serial.println(F("FRQ: Error"));}
+      ShowStatus();
+      break;
+
+    case SET_MONITOR:
+    case SET_TEST_MESSAGE:
+    case SET_COUNTRY:
+    case SET_7A_ADDRESS:
+    case SET_7A_REPEATS:
+    case SET_7A_SPACING:
+    case SET_7A_BACKOFF:
+    case SET_2A_PERIOD:
+      Serial.println(Input);
+      SetParam(State, atol(Input));
+      ShowStatus();
+      break;
+
+    case SET_2A_TEXT:
+      Serial.println(Input);
+      if (!SetRadioText(Input)) {Serial.println(F("Radio Text: Error"));}
+      ShowStatus();
+      break;
+
+    case SWEEP_7A:
+      Serial.println(Input);
+      StartSweep(ALPHA, Input);
+      break;
+
+    case SEND_7A_NUM_10:
+    case SEND_7A_NUM_18:
+    case SEND_7A_ALPHA:
+    case SEND_7A_NUM_VAR:
+    case SEND_7A_FUNC:
+      Serial.println(Input);
+      SubmitMessage(State - SEND_7A_TONE, Input); // menu codes are in order TONE, DIG10, DIG18, ALPHA, VARNUM, FUNC
+      break;
+  }
+}
+//=================================================================================
+
+// ------------------- Frequency from menu: "090.8" = 9080 ----------------------
+uint16_t ParseFRQ(const char *Input)
+{
+uint16_t FRQ = atoi(Input) * 100;
+const char *Dot = strchr(Input, '.');
+
+if (Dot && isdigit(Dot[1]))
+   {
+     FRQ += (Dot[1] - '0') * 10;
+     if (isdigit(Dot[2])) {FRQ += Dot[2] - '0';}
+   }
+return FRQ;
+}
+//=================================================================================
+
+// ------------------- Set parameter from menu or frame, false = wrong value ----
+bool SetParam(byte Param, uint32_t Value)
+{
+switch (Param)
+  {
+    case SET_MONITOR:
+      Cfg_Base.cfg_Monitor = (Value == 0) ? OFF : ON; //save to config
+      break;
+
+    case SET_TEST_MESSAGE:
+      Cfg_Base.cfg_Test_Message = (Value == 0) ? OFF : ON; //save to config
+      break;
+
+    case SET_FRQ:
+      if (Value <= 7600 || Value >= 10800) {return false;}
+      Cfg_Base.cfg_Frequency = Value; //save config
+      TX.Freq(Cfg_Base.cfg_Frequency); //set base frq
+      TX.RDS_AF(Cfg_Base.cfg_Frequency);  //set RDS frq
+      break;
+
+    case SET_FRQ2:
+      if (Value <= 7600 || Value >= 10800 || Transmitters.Lanes < 2) {return false;}
+      Cfg_Base.cfg_Frequency2 = Value;
+      Transmitters.TX[1]->Freq(Value);
+      Transmitters.TX[1]->RDS_AF(Value);
+      break;
+
+    case SET_COUNTRY:
+      if (Value == 0 || Value > 0x0F) {return false;} //validate country code
+      if (Sweep.Active()) {return false;} //PI is swept now
+      Cfg_Base.cfg_pi.refined.pi_country = Value; //save to config
+      for (uint8_t i = 0; i < Transmitters.Lanes; i++) {Transmitters.TX[i]->RDS_PI(Cfg_Base.cfg_pi.All);} //update PI (simulcast chain gets it twice, shadow skips it)
+      break;
+
+    case SET_7A_ADDRESS:
+      if (Value > 999999) {return false;}
+      Cfg_Base.cfg_7A_Address = Value;
+      break;
+
+    case SET_7A_REPEATS:
+      if (Value > 255) {return false;}
+      Cfg_Base.cfg_7A_Repeat.Count = Value;
+      break;
+
+    case SET_7A_SPACING:
+      if (Value > 65535) {return false;}
+      Cfg_Base.cfg_7A_Repeat.Spacing = Value;
+      break;
+
+    case SET_7A_BACKOFF:
+      if (Value > 255) {return false;}
+      Cfg_Base.cfg_7A_Repeat.Backoff = Value;
+      break;
+
+    case SET_2A_PERIOD:
+      if (Value > 255) {return false;}
+      Cfg_Base.cfg_2A_Period = Value;
+      break;
+
+    default:
+      return false;
+  }
+Storage.Changed(); // written when settings are quiet, only changed bytes
+return true;
+}
+//=================================================================================
+
+// ------------------- Radio text from menu or frame, false = too long ----------
+bool SetRadioText(const char *Text)
+{
+if (!RadioTextTable::Set(Cfg_Base, Text)) {return false;} // sequencers send changed segments, all of them for new A/B flag
+Storage.Changed();
+return true;
+}
+//=================================================================================
+
+// --------------------------------- Binary frame -------------------------------
+void DoFrame()
+{
+const uint8_t *Data = Port.Data();
+uint8_t Len = Port.Length();
+uint8_t Out[PROTO_REPLY_MAX];
+
+switch (Data[0])
+  {
+    case CMD_PING:
+      Out[0] = PROTO_VERSION;
+      Port.Reply(CMD_PING, PROTO_OK, Out, 1);
+      break;
+
+    case CMD_STATUS:
+      Put16(Out, Cfg_Base.cfg_Frequency);
+      Put16(Out + 2, Cfg_Base.cfg_pi.All);
+      Put32(Out + 4, Cfg_Base.cfg_7A_Address);
+      Out[8] = Cfg_Base.cfg_Monitor;
+      Out[9] = Cfg_Base.cfg_Test_Message;
+      Out[10] = Transmitters.Count();
+      Out[11] = PAGE_QUEUE_SIZE;
+      Port.Reply(CMD_STATUS, PROTO_OK, Out, 12);
+      break;
+
+    case CMD_TIME:
+      if ((Len != 1) && (Len != 5)) {Port.Reply(CMD_TIME, PROTO_LENGTH); break;}
+      if (Len == 5) // set
+         {
+           if (Get32(Data + 1) < TIME_UNIX_2000) {Port.Reply(CMD_TIME, PROTO_VALUE); break;}
+           Clock.Set(Get32(Data + 1) - TIME_UNIX_2000);
+         }
+      Put32(Out, Clock.Seconds(millis()) + TIME_UNIX_2000);
+      Put16(Out + 4, Clock.Offset);
+      Port.Reply(CMD_TIME, PROTO_OK, Out, 6);
+      break;
+
+    case CMD_SET:
+      if (Len != 6) {Port.Reply(CMD_SET, PROTO_LENGTH); break;}
+      Port.Reply(CMD_SET, SetParam(Data[1], Get32(Data + 2)) ? PROTO_OK : PROTO_VALUE);
+      break;
+
+    case CMD_RT:
+      {
+        char Text[CFG_RT_LEN + 1];
+        uint16_t Mask;
+        if (Len > CFG_RT_LEN + 1) {Port.Reply(CMD_RT, PROTO_LENGTH); break;}
+        memcpy(Text, Data + 1, Len - 1);
+        Text[Len - 1] = 0;
+        Out[0] = RadioTextTable::Changed(Cfg_Base.cfg_2A_Text, Text, Mask);
+        SetRadioText(Text);
+        Out[1] = Cfg_Base.cfg_2A_ADflag;
+        Port.Reply(CMD_RT, PROTO_OK, Out, 2);
+      }
+      break;
+
+    case CMD_STATS:
+      if (Len != 2) {Port.Reply(CMD_STATS, PROTO_LENGTH); break;}
+      Len = StatsItem(Data[1], Out);
+      Port.Reply(CMD_STATS, Len ? PROTO_OK : PROTO_VALUE, Out, Len);
+      break;
+
+    case CMD_STATS_RESET:
+      ResetStats();
+      Port.Reply(CMD_STATS_RESET, PROTO_OK);
+      break;
+
+    case CMD_PAGES:
+    case CMD_PAGES_REPEAT:
+      SubmitPages(Data[0], Data + 1, Len - 1);
+      break;
+
+    case CMD_SWEEP:
+      {
+        const uint8_t *Page = Data + 3; // Countries u16, then page as in CMD_PAGES without Tag
+        if ((Len < 9) || (Len != 9 + Page[5])) {Port.Reply(CMD_SWEEP, PROTO_LENGTH); break;}
+        if ((Page[4] > FUNC) || (Page[5] > PAGE_TEXT_LEN) || (Get32(Page) > 999999)) {Port.Reply(CMD_SWEEP, PROTO_VALUE); break;}
+        char Text[PAGE_TEXT_LEN + 1];
+        memcpy(Text, Page + 6, Page[5]);
+        Text[Page[5]] = 0;
+        Out[0] = Sweep.Start(Get32(Page), Page[4], Text, Get16(Data + 1), Cfg_Base, Pages);
+        Out[1] = Sweep.Groups;
+        Put32(Out + 2, ((uint32_t)Out[0] * Out[1] * RDS_GROUP_TIME_US) / 1000); // 7A air time of all passes
+        Port.Reply(CMD_SWEEP, Out[0] ? PROTO_OK : PROTO_FULL, Out, 6);
+      }
+      break;
+
+    case CMD_SWEEP_STATE:
+      if ((Len != 1) && (Len != 2)) {Port.Reply(CMD_SWEEP_STATE, PROTO_LENGTH); break;}
+      if ((Len == 2) && Data[1]) {Sweep.Stop();} // host: message is received
+      Out[0] = Sweep.State;
+      Out[1] = Sweep.Country;
+      Out[2] = Sweep.Passes;
+      Put32(Out + 3, Sweep.Air_ms());
+      Put32(Out + 7, Sweep.Time_ms());
+      Port.Reply(CMD_SWEEP_STATE, PROTO_OK, Out, 11);
+      break;
+
+    default:
+      Port.Reply(Data[0], PROTO_COMMAND);
+      break;
+  }
+}
+//=================================================================================
+
+// ---------------- Batch of pages from frame, reply for each page --------------
+void SubmitPages(uint8_t Cmd, const uint8_t *Data, uint8_t Len)
+// CMD_PAGES: Tag u16, Address u32, Type u8, Len u8, Text; repeats from Config
+// CMD_PAGES_REPEAT: Tag u16, Address u32, Type u8, Repeats u8, Spacing u16, Backoff u8, Len u8, Text
+{
+uint8_t Pos = 0;
+uint8_t Head = (Cmd == CMD_PAGES_REPEAT) ? 12 : 8; // bytes before Text
+uint8_t Out[5]; // Tag, ID, Groups, Saved
+char Text[PAGE_TEXT_LEN + 1];
+type_Repeat Repeat = Cfg_Base.cfg_7A_Repeat;
+
+while (Pos < Len)
+  {
+    const uint8_t *Page = Data + Pos;
+    uint8_t Text_Len = Page[Head - 1];
+    uint8_t Status = PROTO_OK;
+    Out[2] = 0;
+    Out[3] = 0;
+    Out[4] = 0;
+    
+    if ((Len - Pos < Head) || (Len - Pos < Head + Text_Len)) // page is cut: reply and stop
+       {
+         Put16(Out, (Len - Pos >= 2) ? Get16(Page) : 0);
+         Port.Reply(Cmd, PROTO_LENGTH, Out, 5);
+         return;
+       }
+    Put16(Out, Get16(Page));
+    Pos += Head + Text_Len;
+
+    if (Cmd == CMD_PAGES_REPEAT)
+       {
+         Repeat.Count = Page[7];
+         Repeat.Spacing = Get16(Page + 8);
+         Repeat.Backoff = Page[10];
+       }
+
+    if (((Page[6] & ~PAGE_URGENT) > FUNC) || (Text_Len > PAGE_TEXT_LEN) || (Get32(Page + 2) > 999999)) {Status = PROTO_VALUE;}
+    else
+       {
+         memcpy(Text, Page + Head, Text_Len);
+         Text[Text_Len] = 0;
+         Out[2] = Transmitters.Submit(Get32(Page + 2), Page[6], Text, &Repeat); // A/B flag and call counter are set by queue for each pager
+         if (Out[2] == 0) {Status = PROTO_FULL;}
+         else
+            {
+              Out[3] = Transmitters.Last->Groups;
+              Out[4] = Transmitters.Last->Saved;
+            }
+       }
+    Port.Reply(Cmd, Status, Out, 5);
+  }
+}
+//=================================================================================
+
+//------------------------------- Update radioname and parameters for 0A Group ------------------------------------------------
+void Update_0A(SI4713 &Chip) 
+{ 
+  Chip.RDS_PS(Cfg_Base.cfg_Radio_Name1, 0);               // Set PS Message (max 8 characters) and position number in carousel
+  Chip.RDS_PS(Cfg_Base.cfg_Radio_Name2, 1);               // Set PS Message (max 8 characters) and position number in carousel
+  Chip.RDS_PS(Cfg_Base.cfg_Radio_Name3, 2);               // Set PS Message (max 8 characters) and position number in carousel
+  Chip.RDS_PS(Cfg_Base.cfg_Radio_Name4, 3);               // Set PS Message (max 8 characters) and position number in carousel
+  Chip.RDS_PSCOUNT(Cfg_Base.cfg_0A_slots, Cfg_Base.cfg_0A_speed);                // Number of PS Messages in carousel(4), (min 1, max 12),  and carousel speed (10) (min 1, max 255);
+}
+//=================================================================================
+
+// -------------------------- Same message with each country code --------------
+void StartSweep(byte Type, const char *Text)
+{
+  uint8_t Passes = Sweep.Start(Cfg_Base.cfg_7A_Address, Type, Text, SWEEP_ALL, Cfg_Base, Pages);
+
+  if (Passes == 0)
+     {Serial.println(F("Sweep>> Already running"));}
+  else
+     {
+       Serial.print(F("Sweep>> Passes="));
+       Serial.print(Passes);
+       Serial.print(F(" Groups="));
+       Serial.print(Sweep.Groups);
+       Serial.print(F(" Air="));
+       Serial.print(((uint32_t)Passes * Sweep.Groups * RDS_GROUP_TIME_US) / 1000);
+       Serial.println(F("ms"));
+     }
+}        
+//=================================================================================
+
+void ShowSweep()
+// Result when PI of Config is back on air: country of last complete pass, 7A air time, time from start
+{
+  char Tmp[2];
+  Serial.print(Sweep.Confirmed ? F("Sweep>> Received") : F("Sweep>> Done"));
+  Serial.print(F(" Country="));
+  Serial.print(Int2HEX(Tmp, Sweep.Country, 1));
+  Serial.print(F(" Passes="));
+  Serial.print(Sweep.Passes);
+  Serial.print(F(" Air="));
+  Serial.print(Sweep.Air_ms());
+  Serial.print(F("ms Time="));
+  Serial.print(Sweep.Time_ms());
+  Serial.println(F("ms"));
+  Sweep.State = SWEEP_IDLE;
+}
+//=================================================================================
+
+// -------------------------- Put message to paging queue -----------------------
+void SubmitMessage(byte Type, const char *Text)
+{
+  uint8_t ID = Transmitters.Submit(Cfg_Base.cfg_7A_Address, Type, Text, &Cfg_Base.cfg_7A_Repeat); // A/B flag and call counter are set by queue for each pager
+  
+  if (ID == 0)
+     {Serial.println(F("Message>> Queue is full"));}
+  else
+     {
+       Serial.print(F("Message>> Queued ID="));
+       Serial.print(ID);
+       Serial.print(F(" Waiting="));
+       Serial.print(Transmitters.Count());
+       Serial.print(F(" Groups="));
+       Serial.print(Transmitters.Last->Groups);
+       Serial.print(F(" Saved="));
+       Serial.println(Transmitters.Last->Saved);
+     }
+}        
+//=================================================================================
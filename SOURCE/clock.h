@@ -0,0 +1,158 @@
+/*  UTC time service for RDS Encoder
+ *
+ *  Keeps UTC as seconds from 2000-01-01 (TIME_EPOCH_MJD) and the millis() when that second started.
+ *  Start value: RTC (optional read function) or date and time of Config, later CMD_TIME frame or RTC every TIME_RTC_PERIOD s.
+ *  Sequencer asks for second and minute of each slot, so 1A goes in the first slot of each UTC second and 4A in the first
+ *  slot of each UTC minute: 4A starts 0..1 slot (87.6 ms) after the minute, plus error of FIFO level estimation.
+ *  4A of the next minute is built in idle time (Run() from loop()), the sequencer only copies it.
+ *  On-air start of each 4A is measured from FIFO answers of the chip (TX_RDS_BUFF FIFOUSED, SI4713::RDS_FIFO_UPDATE):
+ *  while the 4A waits in FIFO, Run() asks the chip each TIME_POLL_MS, the start is between the last answer with it
+ *  and the first one without it. Aired() keeps it minus the minute start (Offset, histogram in Stats.Time_Offset).
+ */
+
+// -------------------------------------------------------- TYPE DEFINITIONS
+#define TIME_EPOCH_MJD  51544UL     // 2000-01-01
+#define TIME_UNIX_2000  946684800UL // Unix time of 2000-01-01
+
+typedef bool (*type_RTC_Read)(uint32_t &Seconds); // Read UTC seconds from 2000-01-01, false = RTC is not ready
+//=========================================== END TYPE DEFINITIONS =======================================
+
+class TimeService
+{
+  public:
+    void Begin(Config &Cfg);                   // Start from RTC, else from date and time of Config (UTC)
+    void Set(uint32_t Seconds, uint16_t ms = 0); // Set UTC now: seconds from 2000-01-01 and ms of this second
+    uint32_t Seconds(unsigned long Local);     // UTC second at millis() = Local
+    uint16_t Millis(unsigned long Local);      // ms of this UTC second at millis() = Local
+    void Run(SI4713 &TX, Config &Cfg);         // Idle work: prepare 4A of next minute, read RTC
+    void Group_4A(uint16_t *Group, uint32_t Second, SI4713 &TX, Config &Cfg); // 4A for minute starting at Second
+    void Planned(uint32_t Second);             // 4A of minute Second is written to FIFO, Run() measures its start on air
+    void Aired(unsigned long Air, uint32_t Second); // 4A of minute Second starts on air at millis() = Air
+    void Date(uint32_t Second, int &Year, int &Month, int &Day, byte &Hour, byte &Minute); // Calendar date and time of Second
+
+    int16_t Offset = 0;                        // Last 4A on air minus minute start, ms
+    type_RTC_Read RTC = 0;                     // Optional RTC, f.e. DS1307
+
+  private:
+    void Build_4A(uint16_t *Group, uint32_t Minute, SI4713 &TX, Config &Cfg);
+
+    uint32_t Base = 0;                         // UTC second
+    unsigned long Base_Local = 0;              // millis() when Base second started
+    unsigned long RTC_Local = 0;               // millis() of last RTC read
+    uint32_t Next_Minute = 0;                  // Minute (Second / 60) of Next_4A, 0 = not built
+    uint32_t Planned_Second = 0;               // Minute start of 4A in FIFO, 0 = none
+    uint16_t Next_4A[4];                       // Blocks A, B, C, D
+    uint16_t Next_PI = 0;                      // PI of Next_4A
+};
+// =============================================== End Class ======================================
+
+void TimeService::Begin(Config &Cfg)
+{
+uint32_t RTC_Seconds;
+
+if (RTC && RTC(RTC_Seconds)) {Set(RTC_Seconds);}
+else {Set((ymd_to_mjd(Cfg.cfg_Year, Cfg.cfg_Month, Cfg.cfg_Day) - TIME_EPOCH_MJD) * 86400UL + Cfg.cfg_Hour * 3600UL + Cfg.cfg_Minute * 60UL);}
+RTC_Local = millis();
+}
+//=================================================================================
+
+void TimeService::Set(uint32_t Seconds, uint16_t ms)
+{
+Base = Seconds;
+Base_Local = millis() - ms;
+Next_Minute = 0; // time jump, build 4A again
+}
+//=================================================================================
+
+uint32_t TimeService::Seconds(unsigned long Local)
+{
+long ms = (long)(Local - Base_Local); // slot in the past is negative
+return Base + ((ms >= 0) ? ms / 1000 : -((999 - ms) / 1000));
+}
+//=================================================================================
+
+uint16_t TimeService::Millis(unsigned long Local)
+{
+long ms = (long)(Local - Base_Local) % 1000;
+return (ms >= 0) ? ms : ms + 1000;
+}
+//=================================================================================
+
+void TimeService::Run(SI4713 &TX, Config &Cfg)
+{
+unsigned long Now = millis();
+
+if ((Now - Base_Local) >= 3600000UL) // new base each hour, millis() difference stays far from overflow
+{
+  Base += 3600;
+  Base_Local += 3600000UL;
+}
+
+uint32_t RTC_Seconds;
+if (RTC && ((Now - RTC_Local) >= TIME_RTC_PERIOD * 1000UL)) // correct drift of millis()
+{
+  RTC_Local = Now;
+  if (RTC(RTC_Seconds)) {Set(RTC_Seconds);}
+}
+
+if (TX.Fifo.Left_Ready) // 4A went to air
+{
+  TX.Fifo.Left_Ready = false;
+  if (Planned_Second) {Aired(TX.Fifo.Left, Planned_Second);}
+  Planned_Second = 0;
+}
+else if (Planned_Second && TX.Fifo.In_FIFO && (TX.Pending() == 0) && ((Now - TX.Fifo.Updated) >= TIME_POLL_MS))
+{
+  TX.RDS_FIFO_STATUS(); // answer shows whether 4A is still in FIFO
+}
+
+uint32_t Minute = Seconds(Now) / 60 + 1; // next minute start
+if ((Minute != Next_Minute) || (Next_PI != Cfg.cfg_pi.All))
+{
+  Build_4A(Next_4A, Minute, TX, Cfg);
+  Next_Minute = Minute;
+  Next_PI = Cfg.cfg_pi.All;
+}
+}
+//=================================================================================
+
+void TimeService::Group_4A(uint16_t *Group, uint32_t Second, SI4713 &TX, Config &Cfg)
+{
+uint32_t Minute = Second / 60;
+
+if ((Minute == Next_Minute) && (Next_PI == Cfg.cfg_pi.All)) {memcpy(Group, Next_4A, sizeof(Next_4A));} // prepared in idle time
+else {Build_4A(Group, Minute, TX, Cfg);}
+}
+//=================================================================================
+
+void TimeService::Planned(uint32_t Second)
+{
+Planned_Second = Second;
+}
+//=================================================================================
+
+void TimeService::Aired(unsigned long Air, uint32_t Second)
+{
+Offset = (long)(Air - Base_Local) - (long)(Second - Base) * 1000L;
+EncoderStats::Add(Stats.Time_Offset, abs(Offset));
+}
+//=================================================================================
+
+void TimeService::Date(uint32_t Second, int &Year, int &Month, int &Day, byte &Hour, byte &Minute)
+{
+mjd_to_ymd(TIME_EPOCH_MJD + Second / 86400UL, Year, Month, Day);
+Hour = (Second % 86400UL) / 3600;
+Minute = (Second % 3600) / 60;
+}
+//=================================================================================
+
+void TimeService::Build_4A(uint16_t *Group, uint32_t Minute, SI4713 &TX, Config &Cfg)
+{
+int Year, Month, Day;
+byte Hour, Min;
+
+Date(Minute * 60, Year, Month, Day, Hour, Min);
+TX.RDS_4A_BUILD (Group, Cfg.cfg_pi.All, Cfg.cfg_Bo, Cfg.cfg_TP, Cfg.cfg_PTY, Year, Month, Day, Hour, Min,
+                 Cfg.cfg_Offset.refined.offset_sign, Cfg.cfg_Offset.refined.offset_hour, Cfg.cfg_Offset.refined.offset_minute*30);
+}
+//=================================================================================
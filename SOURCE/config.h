@@ -1,81 +1,175 @@
-//Monitoring and debug
-#define OFF 0
-#define ON 1
-
-#define RESET_TX_PIN 13 //RST pin: 11 (use -1 when using external supervisor)
-
-#define TONE  0 //Tone message
-#define DIG10 1 //10 digits numeric message
-#define DIG18 2 //18 digits numeric message
-#define ALPHA 3 //alpha message
-
-//Timers
-#define G_4A_PERIOD 60000 //default 1 minute = 60000 *DONT CHANGE IT*
-#define G_1A_PERIOD 1000 //default 1 sec = 1000 *DONT CHANGE IT* 
-
-// Menu
-#define SHOW_STATUS          11   // Show Status Command
-#define SET_MONITOR          12   // Set Monitor ON/OFF
-#define SET_TEST_MESSAGE     13   // Set Test Messge ON/OFF
-
-#define SET_FRQ         21   // Set frequency command
-
-#define SET_COUNTRY     31   // Set country code command
-#define SET_7A_ADDRESS  32   // Sep pager`s Address 
-
-#define SEND_7A_TONE    71   // Send Message
-#define SEND_7A_NUM_10  72
-#define SEND_7A_NUM_18  73
-#define SEND_7A_ALPHA   74
-
-// Configuration 
-typedef struct
-    {
-      //Monitor and Test message
-      byte cfg_Monitor = OFF; // Debug Monitor ON/OFF
-      byte cfg_Test_Message = ON; // Send Test Message ON/OFF
-      long cfg_Test_Message_Period = 20000; //repeat test message in milliseconds 20 sec = 20000 Test message send in Numeric 10 digits format = milliseconds from system started
-     
-
-      //Tx Settings
-      uint16_t cfg_Frequency = 9080;    //frequency 90.8 MHz
-      
-      //4A Settings
-      int cfg_Year   = 2024;    // Year
-      int cfg_Month  = 11;      // Month
-      int cfg_Day    = 16;      // Day 
-      int cfg_Hour   = 13;      // Hour  
-      int cfg_Minute = 30;      // Minute 
-      type_Offset cfg_Offset;          //yxxxz   y(offset_sign) -> 0 = '+'; 1 = '-'; xxx = from 0(00 hour) to 15(15 hour); z = 0=00 min, 1=30 min    
-      
-      //0A Settings
-      type_pi cfg_pi;                  // Block A see PI structure above
-      uint8_t  cfg_Bo  = 0;            // 0=A Version (for paging MUST be 0); 1=B Version 
-      uint8_t  cfg_TP  = 0;            // 0=Non Traffic Proggram (default); 1=Non Traffic Proggram (does NOT affect for paging)
-      uint8_t  cfg_PTY = 8;            // Programm Type 8 = Jazz (does NOT affect for paging)
-            
-      //0A Settings - Radio Name
-      String cfg_Radio_Name1 = "Paging  "; // Radioname Slot_1, Max len=8
-      String cfg_Radio_Name2 = "Lab     "; // Radioname Slot_2, 
-      String cfg_Radio_Name3 = "RDS     "; // Radioname Slot_3, 
-      String cfg_Radio_Name4 = "Encoder "; // Radioname Slot_4, 
-      uint8_t cfg_0A_slots  = 4          ; // Number of slots Messages in carousel(4), (min 1, max 12). In this version I use only 4 Slots
-      uint8_t cfg_0A_speed  = 1          ; // and carousel speed (min 1 sec, max sec);
-
-      //2A settings
-      String cfg_2A_Text = "Goog Luck!";   // Radio Text 
-      uint8_t cfg_2A_Period  = 5;          // Duration for send 2A group (Radio Text); 0=Turn off send 2A group
-      byte cfg_2A_ADflag = 0;              //Text A/B flag. I always use 0                     
-
-      //1A Settings
-      byte cfg_1A_Rpc = 6; // Radio Paging Codes (see protocol description bits: xxxyy xxx-group 001=0-99 groups yy-battery saving 
-      uint16_t cfg_1A_Slc = 0x00E4; // Slow Labeling Code must be 00Ex x=0-4 (see Extended Country Code, Annex D, E4=Ukraine) (does NOT affect for paging in National mode)
-      uint16_t cfg_1A_Pinc = 0x1234; // Programm Item Number (does NOT affect for paging)
-
-      //7A Settings
-      byte cfg_7A_ADflag = 0;             //Text A/B flag. If flag changined = new message; if not changed = repeat
-      uint32_t cfg_7A_Address = 100466;   //Pager address ggnnnn gg-group nnnn-number in group //my pagers alpha text = 100466 //finder 100703
-      String cfg_7A_Message ="";          // Current message 
-                  
-    }Config;
-
+//Monitoring and debug
+#define OFF 0
+#define ON 1
+
+#define RESET_TX_PIN 13 //RST pin: 11 (use -1 when using external supervisor)
+#define INT_TX_PIN -1   //GPO2/INT pin of SI4713 for CTS interrupt (use -1 when not connected, CTS is polled over I2C)
+
+//Second transmitter (scheduler.h)
+#ifndef TX_COUNT // host build (HOST/Makefile simulcast, spread) sets both with -D
+#define TX_COUNT       1            //SI4713 chips: 1 or 2
+#define TX_MODE        TX_SIMULCAST //TX_SIMULCAST = same groups on both chips, TX_SPREAD = pages are spread over chips
+#endif
+#define TX2_ADDRESS    0x11         //I2C address of second chip: 0x11 (SEN low), or 0x63 on own bus
+#define TX2_BUS        Wire         //TwoWire of second chip (f.e. Wire1)
+#define TX2_RESET_PIN  12           //RST pin of second chip (-1 = same reset as first chip)
+#define TX2_INT_PIN    -1           //GPO2/INT pin of second chip (-1 = CTS is polled over I2C)
+
+//SI4713 command engine
+#define TX_CMD_QUEUE   6   //commands waiting for the chip (9 bytes each)
+#define TX_CMD_TIMEOUT 300 //max wait for CTS in ms (POWER_UP needs ~110 ms)
+#define TX_RESET_MS    1   //RST low pulse and wait after it, ms (chip needs 100 us)
+#define TX_PS_SHADOW   4   //PS slots kept in shadow (8 bytes each), other slots are always sent
+
+//RDS FIFO
+#define RDS_FIFO_SIZE      54 //TX_RDS_FIFO_SIZE groups: 0=FIFO Disabled, 4, 7, 10-54
+
+//7A Paging
+#define PAGE_QUEUE_SIZE 3 //messages waiting for air time, encoded (107 bytes each)
+#define PAGE_TEXT_LEN  80 //max message length
+#define PAGER_TABLE_SIZE 8 //pagers with own A/B flag state and call counter (8 bytes each), oldest pager is replaced
+
+#define TONE  0 //Tone message
+#define DIG10 1 //10 digits numeric message
+#define DIG18 2 //18 digits numeric message
+#define ALPHA 3 //alpha message
+#define VARNUM 4 //variable-length numeric message (8 digits in each group), DIG10/DIG18/VARNUM are sent in the format with fewest groups
+#define FUNC  5 //variable-length function message (hex digits)
+#define PAGE_URGENT 0x80 //flag in Type of CMD_PAGES: message goes before others and interrupts message on air
+#define PAGE_PREEMPT_GROUPS 4 //urgent message interrupts message on air only when more groups of it are left
+
+//Monitor trace
+#define TRACE_SIZE (SEQ_PLAN + 1) //monitor records waiting for serial port (14 bytes each): largest burst of one planned slot (urgent reload), sequencer waits for this place
+
+//Time (clock.h)
+#define TIME_RTC_PERIOD 3600 //read RTC again after this time, s (when TimeService::RTC is set)
+#define TIME_POLL_MS 5 //FIFO state is asked this often while 4A waits in FIFO: error of measured 4A start on air
+
+//Sequencer
+#define SEQ_LEAD 3 //groups planned ahead in chip FIFO (1 group = 87.6 ms); 1A/4A slot is fixed this time before air
+#define SEQ_PLAN 5 //planned groups kept for reload of FIFO after urgent message (more than SEQ_LEAD)
+
+//Radio text (radiotext.h)
+#define RT_BUSY_SLOWDOWN 4 //refresh of 2A segments goes this many times slower while pages wait
+
+// Serial control port (protocol.h)
+#define PROTO_MENU      ON   //text menu for terminal together with binary frames (OFF = frames only)
+#define PROTO_FRAME_MAX 96   //max CMD+DATA bytes in frame (page of 80 symbols takes 93), RAM = PROTO_FRAME_MAX + 3 bytes; longer text line is cut
+#define PROTO_RX_RING   64   //received bytes moved out of Serial buffer (64 bytes on AVR), frame + 4 bytes must fit in both
+#define PROTO_LINE_GAP  50   //ms without input: end of text line, incomplete frame is dropped
+#define PROTO_VERSION   1
+
+#define CMD_PING   0x01 //frame commands
+#define CMD_STATUS 0x02
+#define CMD_SET    0x03
+#define CMD_STATS  0x04
+#define CMD_STATS_RESET 0x05
+#define CMD_TIME   0x06
+#define CMD_RT     0x07 //radio text
+#define CMD_PAGES  0x10
+#define CMD_SWEEP  0x11 //country sweep (sweep.h)
+#define CMD_SWEEP_STATE 0x12
+#define CMD_PAGES_REPEAT 0x13 //pages with own repeat policy
+#define CMD_TRACE  0x20 //monitor record from encoder (trace.h)
+
+#define PROTO_OK      0 //reply status
+#define PROTO_CRC     1
+#define PROTO_LENGTH  2
+#define PROTO_COMMAND 3
+#define PROTO_VALUE   4
+#define PROTO_FULL    5
+
+// Config in EEPROM (storage.h)
+#define CFG_EEPROM_ADDR 0 //start of config image
+#define CFG_SAVE_DELAY  10000 //ms without new change before Config is written
+#define CFG_VERSION     3 //change when fields of Config change, image with other version is not loaded
+#define CFG_RT_LEN      64 //max Radio Text length
+
+// Menu
+#define SHOW_STATUS          11   // Show Status Command
+#define SET_MONITOR          12   // Set Monitor ON/OFF
+#define SET_TEST_MESSAGE     13   // Set Test Messge ON/OFF
+#define SHOW_STATS           14   // Show counters
+#define RESET_STATS          15   // Reset counters
+#define RESYNC_TX            16   // Send all settings to the chip again
+
+#define SET_FRQ         21   // Set frequency command
+#define SET_FRQ2        22   // Frequency of second transmitter
+
+#define SET_COUNTRY     31   // Set country code command
+#define SET_7A_ADDRESS  32   // Sep pager`s Address 
+#define SWEEP_7A        33   // Send message with each country code
+#define SWEEP_STOP      34   // Message is received, stop sweep
+#define SET_7A_REPEATS  35   // Repeats of each message
+#define SET_7A_SPACING  36   // Time between repeats, ms
+#define SET_7A_BACKOFF  37   // Next spacing in % of last one
+
+#define SET_2A_TEXT     41   // Radio text
+#define SET_2A_PERIOD   42   // Refresh of radio text, s
+
+#define SEND_7A_TONE    71   // Send Message
+#define SEND_7A_NUM_10  72
+#define SEND_7A_NUM_18  73
+#define SEND_7A_ALPHA   74
+#define SEND_7A_NUM_VAR 75
+#define SEND_7A_FUNC    76
+
+// Repeat policy of paging message (paging.h)
+typedef struct
+{
+  uint8_t Count;       // Repeats after first airing, 0 = no repeats
+  uint16_t Spacing;    // ms from end of airing to next repeat
+  uint8_t Backoff;     // Next spacing in % of last one: 100 = same, 200 = doubles (0 = 100)
+} type_Repeat;
+
+// Configuration: plain fields only, the whole struct is copied to/from EEPROM (storage.h)
+typedef struct
+    {
+      //Monitor and Test message
+      byte cfg_Monitor = OFF; // Debug Monitor ON/OFF
+      byte cfg_Test_Message = ON; // Send Test Message ON/OFF
+      long cfg_Test_Message_Period = 20000; //repeat test message in milliseconds 20 sec = 20000 Test message send in Numeric 10 digits format = milliseconds from system started
+     
+
+      //Tx Settings
+      uint16_t cfg_Frequency = 9080;    //frequency 90.8 MHz
+      uint16_t cfg_Frequency2 = 10120;  //second transmitter (TX_COUNT 2) 101.2 MHz
+      
+      //4A Settings
+      int cfg_Year   = 2024;    // Year
+      int cfg_Month  = 11;      // Month
+      int cfg_Day    = 16;      // Day 
+      int cfg_Hour   = 13;      // Hour  
+      int cfg_Minute = 30;      // Minute 
+      type_Offset cfg_Offset;          //yxxxz   y(offset_sign) -> 0 = '+'; 1 = '-'; xxx = from 0(00 hour) to 15(15 hour); z = 0=00 min, 1=30 min    
+      
+      //0A Settings
+      type_pi cfg_pi;                  // Block A see PI structure above
+      uint8_t  cfg_Bo  = 0;            // 0=A Version (for paging MUST be 0); 1=B Version 
+      uint8_t  cfg_TP  = 0;            // 0=Non Traffic Proggram (default); 1=Non Traffic Proggram (does NOT affect for paging)
+      uint8_t  cfg_PTY = 8;            // Programm Type 8 = Jazz (does NOT affect for paging)
+            
+      //0A Settings - Radio Name
+      char cfg_Radio_Name1[9] = "Paging  "; // Radioname Slot_1, Max len=8
+      char cfg_Radio_Name2[9] = "Lab     "; // Radioname Slot_2, 
+      char cfg_Radio_Name3[9] = "RDS     "; // Radioname Slot_3, 
+      char cfg_Radio_Name4[9] = "Encoder "; // Radioname Slot_4, 
+      uint8_t cfg_0A_slots  = 4          ; // Number of slots Messages in carousel(4), (min 1, max 12). In this version I use only 4 Slots
+      uint8_t cfg_0A_speed  = 1          ; // and carousel speed (min 1 sec, max sec);
+
+      //2A settings
+      char cfg_2A_Text[CFG_RT_LEN + 1] = "Goog Luck!"; // Radio Text 
+      uint8_t cfg_2A_Period  = 5;          // Whole Radio Text is sent again once in this time, s; 0=Turn off send 2A group
+      byte cfg_2A_ADflag = 0;              //Text A/B flag, toggles for each new text (radiotext.h)
+
+      //1A Settings
+      byte cfg_1A_Rpc = 6; // Radio Paging Codes (see protocol description bits: xxxyy xxx-group 001=0-99 groups yy-battery saving; yy=00 pagers always listen, else message is sent in 6 s interval of pager (paging.h)
+      uint16_t cfg_1A_Slc = 0x00E4; // Slow Labeling Code must be 00Ex x=0-4 (see Extended Country Code, Annex D, E4=Ukraine) (does NOT affect for paging in National mode)
+      uint16_t cfg_1A_Pinc = 0x1234; // Programm Item Number (does NOT affect for paging)
+
+      //7A Settings
+      uint32_t cfg_7A_Address = 100466;   //Pager address ggnnnn gg-group nnnn-number in group //my pagers alpha text = 100466 //finder 100703
+      type_Repeat cfg_7A_Repeat = {0, 10000, 100}; //Repeats of messages from menu and CMD_PAGES: count, spacing ms, backoff %
+                  
+    }Config;
+
@@ -0,0 +1,349 @@
+/*  Paging queue for RDS Encoder
+ *
+ *  Pending 7A messages for many pagers. Each message has own address, type and text.
+ *  A/B flag is kept per pager: new message inverts flag of this pager, repeat of the last message keeps it.
+ *  Repeat = same type, length and CRC32 of text as the last message of the pager (NewMessage(), also for the sweep).
+ *  NextGroup() gives groups of waiting messages one by one, the sequencer puts them into free air-time slots.
+ *
+ *  Repeats (type_Repeat): aired message goes back to the end of the queue and waits Spacing ms, each next spacing
+ *  is Backoff % of the last one, so repeats go between new messages. Repeat keeps A/B flag and has repeat flag in X1X2
+ *  (alpha and variable-length messages), call counter of the pager goes up only for new message, so pager sees gaps.
+ *  Message is encoded once in Submit() and only the encoded blocks are kept (no text), repeats send them again,
+ *  only X1X2 byte of address group is set when it is sent.
+ *  When queue is full, new message takes place of a waiting repeat. New message to a pager ends repeats of its
+ *  older message (pager would take a late repeat with the old A/B flag for a new message).
+ *
+ *  Battery saving (1A Radio Paging Codes, Annex M): each minute (4A) has 10 intervals of 6 seconds,
+ *  pager with address ggnnnn listens only in interval = last digit of group code gg, starting from 1A of this interval.
+ *  Message is started only when whole message fits into the interval of its pager, other messages can go first.
+ *  Messages of one pager are never reordered: A/B flag and call counter are given in Submit(), so a later message
+ *  which goes first would look like a repeat to the pager.
+ *
+ *  Urgent message (Type | PAGE_URGENT) goes before all other messages whose pagers are awake. When a message is
+ *  on air with more than PAGE_PREEMPT_GROUPS groups left, the urgent message interrupts it: the interrupted message
+ *  starts again from its address group after the urgent one, Preempted tells the sequencer which groups to drop from FIFO.
+ *
+ *  Numeric message is queued in the format with fewest groups (SI4713::RDS_7A_FORMAT): DIG10 for short numbers,
+ *  variable-length numeric above 18 digits. Groups and Saved tell the result for the last Submit().
+ */
+
+#define PAGING_INTERVAL_MS 6000UL // battery saving interval
+
+// -------------------------------------------------------- TYPE DEFINITIONS
+/**
+ * Pending message
+ */
+typedef struct
+{
+  uint32_t Address;               // Pager address ggnnnn
+  uint8_t ID;                     // Message ID, 1..255
+  uint8_t ABflag : 1;             // Text A/B flag for this message
+  uint8_t Call : 4;               // Call counter of pager for this message, 0..15
+  uint8_t Repeat : 1;                // Pager had this message before: repeat flag from first airing
+  uint8_t Urgent : 1;                // PAGE_URGENT: first in queue, interrupts other messages
+  uint8_t Started : 1;               // Address group was on air (latency is counted once)
+  uint8_t Repeats;                // Repeats left
+  uint8_t Backoff;                // Next spacing in %
+  uint32_t Spacing;               // ms from end of last airing to next one
+  uint8_t Airings;                // Times on air
+  unsigned long Aired;            // millis() at end of last airing
+  unsigned long Submitted;        // millis() of Submit(), for Stats
+  type_7A_Page Encoded;           // Message encoded once in Submit(), type is numeric format as sent
+} type_Page;
+
+/**
+ * A/B flag and call counter of one pager
+ */
+typedef struct
+{
+  uint32_t Address = 0;           // Pager address, 0 = free place
+  uint32_t Digest = 0;            // CRC32 of last message text
+  uint8_t Len = 0;                // Text length of last message
+  uint8_t Type : 3;               // Type of last message (as encoded), same type, length and digest = repeat
+  uint8_t ABflag : 1;             // Last sent A/B flag
+  uint8_t Call : 4;               // Call counter of last message
+  uint8_t Age = 0;                // 0 = used last, replace oldest pager when table is full
+} type_Pager;
+//=========================================== END TYPE DEFINITIONS =======================================
+
+class PagingQueue
+{
+  public:
+    uint8_t Submit(uint32_t Address, byte Type, const char *Text, const type_Repeat *Repeat = 0); // Add message to queue, return message ID (0 = queue is full)
+    bool NextGroup(uint16_t *Group, SI4713 &TX, Config &Cfg, uint32_t Slot_Time); // Next group {A,B,C,D} for slot starting at Slot_Time ms (from minute start), false = nothing to send
+    uint8_t Count();                                                // Messages in queue
+    bool Knows(uint32_t Address);                                   // Pager is in pager table (scheduler.h keeps pager on its transmitter)
+    void Numbering(uint8_t First_ID, uint8_t ID_Step);              // Message IDs First_ID, First_ID + ID_Step, ... (IDs of several queues differ)
+    bool Busy() {return Head_Group != 0;}                           // First message is half sent
+    bool NewMessage(uint32_t Address, byte Type, const char *Text, uint8_t &ABflag, uint8_t &Call); // A/B flag and call counter for message to Address, false = repeat
+    static bool PagerAwake(uint32_t Address, byte Rpc, uint32_t Slot_Time, uint8_t Groups); // Message fits into battery saving interval of pager
+    uint8_t Group_ID = 0;                                           // Message ID of last group from NextGroup()
+    uint8_t Group_Flags = 0;                                        // TRACE_LAST: last group was end of message
+    uint8_t Preempted = 0;                                          // ID of message interrupted by urgent one in NextGroup(), 0 = none
+    uint8_t Groups = 0;                                             // Groups of last submitted message
+    uint8_t Saved = 0;                                              // Groups saved by format of last submitted message
+    
+  private:
+    bool Due(const type_Page &Page);                                // Message is new or its spacing is over
+    bool Ready(uint8_t i, SI4713 &TX, Config &Cfg, uint32_t Slot_Time); // Message i of queue can start in this slot
+    bool Preempt(SI4713 &TX, Config &Cfg, uint32_t Slot_Time);     // Urgent message can start: interrupt message on air
+    void Aired();                                                   // First message is on air: remove it or wait for repeat at the end
+    bool DropRepeat(uint32_t Address = 0);                          // Remove oldest waiting repeat (of pager Address, 0 = any), false = no repeats
+    bool Waiting(uint32_t Address);                                 // Queue has a message to pager Address
+
+    type_Page Queue[PAGE_QUEUE_SIZE];
+    uint8_t Head = 0;
+    uint8_t Pending = 0;
+    uint8_t Head_Group = 0;         // Next group of first message
+    uint8_t Next_ID = 1;
+    uint8_t First_ID = 1;
+    uint8_t ID_Step = 1;
+    type_Pager Pagers[PAGER_TABLE_SIZE];
+};
+// =============================================== End Class ======================================
+
+uint8_t PagingQueue::Submit(uint32_t Address, byte Type, const char *Text, const type_Repeat *Repeat)
+{
+while (DropRepeat(Address)) {} // older message of pager is not repeated after this one
+if ((Pending >= PAGE_QUEUE_SIZE) && !DropRepeat()) {return 0;} // queue is full
+
+type_Page &Page = Queue[(Head + Pending) % PAGE_QUEUE_SIZE];
+
+Page.Urgent = (Type & PAGE_URGENT) != 0;
+Type &= ~PAGE_URGENT;
+Page.Address = Address;
+SI4713::RDS_7A_COMPILE(Page.Encoded, Type, Address, Text); // text is not kept
+
+Groups = Page.Encoded.Groups;
+uint8_t Asked = SI4713::RDS_7A_GROUPS(Type, strnlen(Text, PAGE_TEXT_LEN));
+Saved = (Asked > Groups) ? Asked - Groups : 0;
+Stats.Groups_Saved += Saved;
+
+uint8_t ABflag, Call;
+Page.Repeat = !NewMessage(Address, Page.Encoded.Type, Text, ABflag, Call); // same text with other type is new message
+Page.ABflag = ABflag;
+Page.Call = Call;
+Page.Repeats = Repeat ? Repeat->Count : 0;
+Page.Spacing = Repeat ? Repeat->Spacing : 0;
+Page.Backoff = (Repeat && Repeat->Backoff) ? Repeat->Backoff : 100;
+Page.Airings = 0;
+Page.Started = false;
+
+Page.Submitted = millis();
+Page.ID = Next_ID;
+Next_ID += ID_Step;
+if (Next_ID <= ID_Step) {Next_ID = First_ID;} // wrap, 0 = error
+
+Pending++;
+if (Pending > Stats.Queue_Max) {Stats.Queue_Max = Pending;}
+return Page.ID;
+}
+//=================================================================================
+
+bool PagingQueue::NextGroup(uint16_t *Group, SI4713 &TX, Config &Cfg, uint32_t Slot_Time)
+{
+if (Pending == 0) {return false;}
+if (Head_Group != 0) {Preempt(TX, Cfg, Slot_Time);}
+
+if (Head_Group == 0) // new message: take first urgent message whose pager is awake now, then first other one
+{
+  uint8_t i = 0;
+  while ((i < Pending) && !(Queue[(Head + i) % PAGE_QUEUE_SIZE].Urgent && Ready(i, TX, Cfg, Slot_Time))) {i++;}
+  if (i == Pending)
+  {
+    i = 0;
+    while ((i < Pending) && !Ready(i, TX, Cfg, Slot_Time)) {i++;}
+  }
+  if (i == Pending) {return false;} // all pagers sleep or wait for repeat
+
+  for (; i > 0; i--) // move message to head, order of other messages is kept
+  {
+    type_Page tmp_Page = Queue[(Head + i) % PAGE_QUEUE_SIZE];
+    Queue[(Head + i) % PAGE_QUEUE_SIZE] = Queue[(Head + i - 1) % PAGE_QUEUE_SIZE];
+    Queue[(Head + i - 1) % PAGE_QUEUE_SIZE] = tmp_Page;
+  }
+}
+
+type_Page &Page = Queue[Head];
+
+SI4713::RDS_7A_GROUP(Group, Page.Encoded, Head_Group, Cfg.cfg_pi.All, Cfg.cfg_Bo, Cfg.cfg_TP, Cfg.cfg_PTY, Page.ABflag);
+if (Head_Group == 0) // address group
+   {
+     SI4713::RDS_7A_X1X2(Group, Page.Encoded.Type, Page.Call, Page.Repeat || (Page.Airings > 0));
+     uint32_t Latency = millis() + TX.RDS_FIFO_USED() * (RDS_GROUP_TIME_US / 1000) - Page.Submitted; // first group goes to air after groups in FIFO
+     if (Page.Airings > 0) {Stats.Repeats++;}
+     else if (!Page.Started) // interrupted message is counted at its first start
+        {
+          EncoderStats::Add(Stats.Page_Latency, Latency);
+          if (Page.Urgent) {EncoderStats::Add(Stats.Urgent_Latency, Latency);}
+        }
+     Page.Started = true;
+   }
+Head_Group++;
+Group_ID = Page.ID;
+Group_Flags = 0;
+
+if (Head_Group >= Page.Encoded.Groups) // last group of message
+{
+  Group_Flags = TRACE_LAST;
+  Head_Group = 0;
+  Aired();
+}
+
+return true;
+}
+//=================================================================================
+
+void PagingQueue::Aired()
+{
+type_Page Page = Queue[Head];
+Head = (Head + 1) % PAGE_QUEUE_SIZE;
+Pending--;
+if (Page.Repeats == 0) {return;}
+if (Waiting(Page.Address)) {Stats.Repeats_Dropped++; return;} // newer message of pager is queued
+
+if (Page.Airings > 0) {Page.Spacing = (Page.Spacing * Page.Backoff) / 100;} // spacing after first airing is as set
+Page.Airings++;
+Page.Repeats--;
+Page.Aired = millis();
+Queue[(Head + Pending) % PAGE_QUEUE_SIZE] = Page; // new messages go first
+Pending++;
+}
+//=================================================================================
+
+bool PagingQueue::Due(const type_Page &Page)
+{
+return (Page.Airings == 0) || ((millis() - Page.Aired) >= Page.Spacing);
+}
+//=================================================================================
+
+bool PagingQueue::Ready(uint8_t i, SI4713 &TX, Config &Cfg, uint32_t Slot_Time)
+{
+const type_Page &Page = Queue[(Head + i) % PAGE_QUEUE_SIZE];
+for (uint8_t j = 0; j < i; j++) {if (Queue[(Head + j) % PAGE_QUEUE_SIZE].Address == Page.Address) {return false;}} // older message of pager goes first
+return Due(Page) && PagerAwake(Page.Address, Cfg.cfg_1A_Rpc, Slot_Time, Page.Encoded.Groups);
+}
+//=================================================================================
+
+bool PagingQueue::Preempt(SI4713 &TX, Config &Cfg, uint32_t Slot_Time)
+{
+type_Page &Page = Queue[Head];
+if (Page.Urgent) {return false;} // urgent messages don't interrupt each other
+if (Page.Encoded.Groups - Head_Group <= PAGE_PREEMPT_GROUPS) {return false;} // ends soon
+
+for (uint8_t i = 1; i < Pending; i++)
+{
+  if (Queue[(Head + i) % PAGE_QUEUE_SIZE].Urgent && Ready(i, TX, Cfg, Slot_Time)) // not for pager of message on air
+  {
+    Preempted = Page.ID;
+    Head_Group = 0; // sent again from address group, A/B flag and call counter stay
+    Stats.Preemptions++;
+    return true;
+  }
+}
+return false;
+}
+//=================================================================================
+
+bool PagingQueue::DropRepeat(uint32_t Address)
+{
+for (uint8_t i = Busy() ? 1 : 0; i < Pending; i++) // message on air stays
+{
+  const type_Page &Page = Queue[(Head + i) % PAGE_QUEUE_SIZE];
+  if ((Page.Airings == 0) || (Address && (Page.Address != Address))) {continue;}
+
+  for (; i < Pending - 1; i++) // close the gap, order of other messages is kept
+  {
+    Queue[(Head + i) % PAGE_QUEUE_SIZE] = Queue[(Head + i + 1) % PAGE_QUEUE_SIZE];
+  }
+  Pending--;
+  Stats.Repeats_Dropped++;
+  return true;
+}
+return false;
+}
+//=================================================================================
+
+bool PagingQueue::Waiting(uint32_t Address)
+{
+for (uint8_t i = 0; i < Pending; i++) {if (Queue[(Head + i) % PAGE_QUEUE_SIZE].Address == Address) {return true;}}
+return false;
+}
+//=================================================================================
+
+uint8_t PagingQueue::Count()
+{
+return Pending;
+}
+//=================================================================================
+
+bool PagingQueue::Knows(uint32_t Address)
+{
+for (uint8_t i = 0; i < PAGER_TABLE_SIZE; i++) {if (Pagers[i].Address == Address) {return true;}}
+return false;
+}
+//=================================================================================
+
+void PagingQueue::Numbering(uint8_t First_ID, uint8_t ID_Step)
+{
+this->First_ID = First_ID;
+this->ID_Step = ID_Step;
+Next_ID = First_ID;
+}
+//=================================================================================
+
+bool PagingQueue::PagerAwake(uint32_t Address, byte Rpc, uint32_t Slot_Time, uint8_t Groups)
+{
+if ((Rpc & 0x03) == 0) {return true;} // battery saving is OFF, pagers always listen
+
+uint32_t Start = ((Address / 10000) % 10) * PAGING_INTERVAL_MS; // interval of group code gg
+uint32_t Time = Slot_Time % 60000UL; // from minute start
+uint32_t Need = ((Groups + Groups / 10 + 1) * RDS_GROUP_TIME_US) / 1000; // message + 1A groups between its groups
+
+return (Time > Start) && ((Time + Need) <= (Start + PAGING_INTERVAL_MS)); // first slot of interval is 1A
+}
+//=================================================================================
+
+bool PagingQueue::NewMessage(uint32_t Address, byte Type, const char *Text, uint8_t &ABflag, uint8_t &Call)
+// Repeat only when type, length and CRC32 of text are the same (CRC16 alone: "B885" and "H660" collide)
+{
+type_Pager *Pager = 0;
+uint8_t Len = strnlen(Text, PAGE_TEXT_LEN); // as encoded
+uint32_t Digest = CRC32(Text, Len);
+
+for (uint8_t i = 0; i < PAGER_TABLE_SIZE; i++) // search pager, all other pagers become older
+{
+  if (Pagers[i].Address == Address) {Pager = &Pagers[i];}
+  else if (Pagers[i].Age < 255) {Pagers[i].Age++;}
+}
+
+if (Pager == 0) // new pager, take free place or oldest pager
+{
+  Pager = &Pagers[0];
+  for (uint8_t i = 1; i < PAGER_TABLE_SIZE; i++)
+  {
+    if (Pager->Address == 0) {break;}
+    if ((Pagers[i].Address == 0) || (Pagers[i].Age > Pager->Age)) {Pager = &Pagers[i];}
+  }
+  Pager->Address = Address;
+  Pager->Digest = Digest ^ 0xFFFFFFFFUL; // first message is always new
+  Pager->ABflag = 0;
+  Pager->Call = 0x0F; // first message has call 0
+}
+
+Pager->Age = 0;
+bool New = (Pager->Digest != Digest) || (Pager->Len != Len) || (Pager->Type != Type);
+if (New) // new message: invert A/B flag, next call
+   {
+     Pager->ABflag = Pager->ABflag ? 0 : 1;
+     Pager->Call = (Pager->Call + 1) & 0x0F;
+     Pager->Digest = Digest;
+     Pager->Len = Len;
+     Pager->Type = Type;
+   }
+
+ABflag = Pager->ABflag;
+Call = Pager->Call;
+return New;
+}
+//=================================================================================
@@ -0,0 +1,189 @@
+/*  Serial control port for RDS Encoder
+ *
+ *  Input is parsed byte by byte in loop(), nothing waits for the next byte. Serial receive buffer of AVR core has
+ *  only 64 bytes (5.6 bytes/ms at 57600), so Drain() moves them to own ring of PROTO_RX_RING bytes on each Poll()
+ *  and between long steps of loop(): no pass of loop() may take longer than 64 bytes (11 ms). Gateway sends the next
+ *  frame only after reply, so Serial buffer and ring together always have place for a whole frame (PROTO_FRAME_MAX + 4).
+ *  Two kinds of input on the same port:
+ *  - Binary frame (paging gateway, HOST/gateway): SYNC LEN CMD DATA... CRC_LO CRC_HI
+ *      SYNC = 0xA5, LEN = bytes of CMD + DATA (1..PROTO_FRAME_MAX), CRC = CRC16 of LEN, CMD and DATA.
+ *      Numbers in DATA are little endian. Each command is one frame with all arguments.
+ *      Reply: SYNC LEN CMD|0x80 STATUS DATA... CRC, bad frame is answered with CMD = PROTO_NAK|0x80.
+ *      Text output (monitor, status) can be between frames: gateway looks for SYNC with right CRC.
+ *  - Text line (terminal menu, PROTO_MENU ON): ends with CR/LF or PROTO_LINE_GAP ms pause ("No line Ending").
+ *      SYNC byte can't be in typed command, so the first byte of input selects the kind.
+ *
+ *  Commands (see config.h):
+ *  - CMD_PING   -> PROTO_VERSION
+ *  - CMD_STATUS -> Frequency u16, PI u16, Address u32, Monitor u8, Test Message u8, Waiting u8, Queue size u8
+ *  - CMD_SET    Param u8 (menu code: SET_MONITOR, SET_TEST_MESSAGE, SET_FRQ, SET_FRQ2, SET_COUNTRY, SET_7A_ADDRESS,
+ *               SET_7A_REPEATS, SET_7A_SPACING, SET_7A_BACKOFF, SET_2A_PERIOD), Value u32
+ *  - CMD_STATS  Item u8 -> counters (stats.h), all u32 unless noted:
+ *               0: I2C commands, CTS spins, chip errors u16, FIFO overflows u16, FIFO underflows u16,
+ *                  1A/4A misses u16, trace dropped u16, queue max u8, waiting u8, bad frames u16,
+ *                  boot to first RDS group ms u16, 7A groups saved by numeric format, repeats sent, repeats dropped u16,
+ *                  preemptions u16, groups reloaded u16
+ *               1: groups of type 0..7, 2: groups of type 8..15
+ *               3: I2C time (us), 4: page latency (ms), 5: loop time (us), 6: 4A offset from minute start (ms),
+ *                  7: urgent page latency (ms):
+ *                  count, max, 16 buckets u16 (relative: halved together when one is full)
+ *  - CMD_STATS_RESET -> counters are 0
+ *  - CMD_TIME   [Unix time u32 to set UTC] -> UTC now (Unix time u32), last 4A on air minus minute start (ms, i16)
+ *  - CMD_RT     Text[0..64] -> changed segments u8, A/B flag u8 (radiotext.h: only changed 2A segments are sent,
+ *               all of them with new A/B flag for a new text)
+ *  - CMD_PAGES  one or more pages: Tag u16, Address u32, Type u8 (TONE..FUNC, | PAGE_URGENT), Len u8, Text[Len]
+ *               -> one reply for each page: Tag u16, ID u8, Groups u8, Saved u8 (STATUS = PROTO_FULL when queue is full)
+ *               repeats of each page as set by SET_7A_REPEATS/SPACING/BACKOFF (paging.h)
+ *  - CMD_PAGES_REPEAT as CMD_PAGES with own repeats: Tag u16, Address u32, Type u8, Repeats u8, Spacing ms u16,
+ *               Backoff % u8, Len u8, Text[Len]
+ *  - CMD_SWEEP  Countries u16 (bit n = country n, 0 = 1..F), Address u32, Type u8, Len u8, Text[Len]
+ *               -> Passes u8, Groups u8 (in each pass), 7A air time of all passes ms u32 (STATUS = PROTO_FULL when sweep runs)
+ *  - CMD_SWEEP_STATE [Stop u8: 1 = message is received] -> State u8 (sweep.h), Country u8 (last complete pass), Passes u8,
+ *               7A air time ms u32, time from start ms u32
+ *  - CMD_TRACE  sent by encoder without request: monitor record (trace.h)
+ */
+
+// -------------------------------------------------------- TYPE DEFINITIONS
+#define PORT_NONE  0 // nothing complete yet
+#define PORT_FRAME 1 // binary frame is ready: Data(), Length()
+#define PORT_LINE  2 // text line is ready: Line()
+
+#define PROTO_SYNC 0xA5
+#define PROTO_NAK  0x7F // reply CMD for frame with bad CRC or length
+#define PROTO_REPLY_MAX 40 // max DATA bytes in reply
+
+// little endian fields of frame
+inline uint16_t Get16(const uint8_t *p) {return p[0] | ((uint16_t)p[1] << 8);}
+inline uint32_t Get32(const uint8_t *p) {return Get16(p) | ((uint32_t)Get16(p + 2) << 16);}
+inline void Put16(uint8_t *p, uint16_t Value) {p[0] = lowByte(Value); p[1] = highByte(Value);}
+inline void Put32(uint8_t *p, uint32_t Value) {Put16(p, Value); Put16(p + 2, Value >> 16);}
+//=========================================== END TYPE DEFINITIONS =======================================
+
+class ControlPort
+{
+  public:
+    uint8_t Poll();                                        // Parse received bytes, return PORT_NONE/PORT_FRAME/PORT_LINE
+    void Drain();                                          // Move bytes of Serial receive buffer to ring, never waits
+    const uint8_t *Data() {return Buf + 1;}                // Frame: CMD and DATA
+    uint8_t Length() {return Buf[0];}                      // Frame: bytes of CMD and DATA
+    const char *Line() {return (const char *)Buf;}         // Text line without CR/LF
+    static void Reply(uint8_t Cmd, uint8_t Status, const uint8_t *Reply_Data = 0, uint8_t Len = 0); // Send reply frame for Cmd
+    uint16_t Bad_Frames = 0;                               // Frames with bad CRC or length
+
+  private:
+    uint8_t Accept(uint8_t Byte);                          // One received byte, return PORT_xxx
+
+    uint8_t Rx[PROTO_RX_RING];                             // Received bytes not parsed yet
+    uint8_t Rx_Head = 0;                                   // Oldest byte in Rx
+    uint8_t Rx_Count = 0;                                  // Bytes in Rx
+    uint8_t Buf[PROTO_FRAME_MAX + 3];                      // Frame: LEN, CMD, DATA, CRC; or text line
+    uint8_t Pos = 0;                                       // Bytes in Buf
+    uint8_t State = 0;                                     // Parser state, see Accept()
+    unsigned long Last_Byte = 0;                           // millis() of last received byte
+};
+// =============================================== End Class ======================================
+
+#define PARSE_IDLE 0 // waiting for SYNC or first symbol of line
+#define PARSE_LEN  1
+#define PARSE_DATA 2 // CMD, DATA and CRC
+#define PARSE_LINE 3
+
+uint8_t ControlPort::Poll()
+{
+uint8_t Event = PORT_NONE;
+
+Drain();
+while ((Event == PORT_NONE) && (Rx_Count > 0)) // one event for each call, rest waits in ring
+{
+  Event = Accept(Rx[Rx_Head]);
+  Rx_Head = (Rx_Head + 1) % PROTO_RX_RING;
+  Rx_Count--;
+}
+
+if ((Event == PORT_NONE) && (State != PARSE_IDLE) && ((millis() - Last_Byte) > PROTO_LINE_GAP)) // pause in input
+{
+  if ((State == PARSE_LINE) && (Pos > 0))
+     {
+       Buf[Pos] = 0;
+       Event = PORT_LINE;
+     }
+  else if (State != PARSE_LINE) {Bad_Frames++;} // frame is not complete, wait for next SYNC
+  State = PARSE_IDLE;
+}
+
+return Event;
+}
+//=================================================================================
+
+void ControlPort::Drain()
+{
+while ((Rx_Count < PROTO_RX_RING) && (Serial.available() > 0)) // full ring: rest waits in Serial buffer
+{
+  Rx[(Rx_Head + Rx_Count) % PROTO_RX_RING] = Serial.read();
+  Rx_Count++;
+  Last_Byte = millis();
+}
+}
+//=================================================================================
+
+uint8_t ControlPort::Accept(uint8_t Byte)
+{
+switch (State)
+{
+  case PARSE_IDLE:
+    Pos = 0;
+    if (Byte == PROTO_SYNC) {State = PARSE_LEN;}
+    else if (PROTO_MENU == ON) {State = PARSE_LINE; return Accept(Byte);}
+    break;
+
+  case PARSE_LEN:
+    if ((Byte == 0) || (Byte > PROTO_FRAME_MAX)) // wrong length: SYNC was not start of frame
+       {
+         Bad_Frames++;
+         Reply(PROTO_NAK, PROTO_LENGTH);
+         State = PARSE_IDLE;
+         break;
+       }
+    Buf[Pos++] = Byte;
+    State = PARSE_DATA;
+    break;
+
+  case PARSE_DATA:
+    Buf[Pos++] = Byte;
+    if (Pos < Buf[0] + 3) {break;} // LEN, CMD+DATA, CRC
+    State = PARSE_IDLE;
+    if (CRC16(Buf, Buf[0] + 1) == Get16(Buf + Buf[0] + 1)) {return PORT_FRAME;}
+    Bad_Frames++;
+    Reply(PROTO_NAK, PROTO_CRC);
+    break;
+
+  case PARSE_LINE:
+    if ((Byte == '\r') || (Byte == '\n'))
+       {
+         State = PARSE_IDLE;
+         if (Pos == 0) {break;} // empty line or LF after CR
+         Buf[Pos] = 0;
+         return PORT_LINE;
+       }
+    if (Pos < PROTO_FRAME_MAX) {Buf[Pos++] = Byte;} // longer line is cut
+    break;
+}
+
+return PORT_NONE;
+}
+//=================================================================================
+
+void ControlPort::Reply(uint8_t Cmd, uint8_t Status, const uint8_t *Reply_Data, uint8_t Len)
+{
+uint8_t Out[PROTO_REPLY_MAX + 6]; // SYNC, LEN, CMD, STATUS, DATA, CRC
+
+if (Len > PROTO_REPLY_MAX) {Len = PROTO_REPLY_MAX;}
+Out[0] = PROTO_SYNC;
+Out[1] = Len + 2;
+Out[2] = Cmd | 0x80;
+Out[3] = Status;
+if (Len) {memcpy(Out + 4, Reply_Data, Len);}
+Put16(Out + Len + 4, CRC16(Out + 1, Len + 3));
+Serial.write(Out, Len + 6);
+}
+//=================================================================================
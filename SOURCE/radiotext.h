@@ -0,0 +1,121 @@
+/*  Radio text (2A) as a table of segments
+ *
+ *  Text of up to 64 symbols goes in 16 segments of 4 symbols, each segment is one 2A group with its number.
+ *  Receiver keeps segments of the same A/B flag and puts each new one in its place, so after a change only the
+ *  segments which differ are sent, first free slots after paging. A/B flag toggles only for a new text
+ *  (shorter, or more than half of segments changed): receiver clears its display and all segments are sent again.
+ *  Set() decides it once in Config (cfg_2A_ADflag is kept in EEPROM with text), each sequencer lane has own table
+ *  and finds changed segments when Config text differs from its copy.
+ *
+ *  Between changes the whole text is sent again once each cfg_2A_Period seconds for receivers tuned in later,
+ *  one segment at a time spread over the period (not a burst of 16 groups). While paging queue has messages or
+ *  country sweep runs this refresh goes RT_BUSY_SLOWDOWN times slower.
+ */
+
+class RadioTextTable
+{
+  public:
+    static bool Set(Config &Cfg, const char *Text);                  // New radio text in Config, A/B flag toggles for new text, false = too long
+    static uint8_t Changed(const char *Old, const char *New, uint16_t &Mask); // Segments of New which differ from Old, bit n of Mask = segment n
+    bool NextGroup(uint16_t *Group, SI4713 &TX, Config &Cfg, bool Busy); // 2A group for free slot, false = nothing is due
+
+    uint8_t Group_Flags = 0;       // TRACE_LAST: group ends update or refresh cycle
+    uint8_t Segments = 0;          // Segments of text
+
+  private:
+    void Sync(Config &Cfg);        // Take changes of Config text
+
+    char Text[CFG_RT_LEN + 1];     // Text of table
+    uint8_t ABflag = 0xFF;         // A/B flag of table, 0xFF = table is empty
+    uint16_t Dirty = 0;            // Bit n = segment n changed and not sent yet
+    uint8_t Refresh = 0;           // Next segment of refresh cycle
+    unsigned long Refresh_Time = 0; // millis() of last refresh group
+};
+// =============================================== End Class ======================================
+
+bool RadioTextTable::Set(Config &Cfg, const char *Text)
+{
+uint8_t Len = strlen(Text);
+if (Len > CFG_RT_LEN) {return false;}
+
+uint16_t Mask;
+uint8_t Count = Changed(Cfg.cfg_2A_Text, Text, Mask);
+uint8_t Old_Segments = (strlen(Cfg.cfg_2A_Text) + 3) / 4;
+uint8_t New_Segments = (Len + 3) / 4;
+
+if ((New_Segments < Old_Segments) || (Count * 2 > New_Segments)) {Cfg.cfg_2A_ADflag ^= 1;} // new text: receivers clear old segments
+strcpy(Cfg.cfg_2A_Text, Text);
+return true;
+}
+//=================================================================================
+
+uint8_t RadioTextTable::Changed(const char *Old, const char *New, uint16_t &Mask)
+// Segments are compared as sent: ' ' after end of text
+{
+uint8_t Old_Len = strlen(Old), New_Len = strlen(New);
+uint8_t Count = 0;
+Mask = 0;
+
+for (uint8_t Pos = 0; Pos < New_Len; Pos++)
+{
+  char Was = (Pos < Old_Len) ? Old[Pos] : ' ';
+  if ((Was != New[Pos]) && !bitRead(Mask, Pos / 4)) {bitSet(Mask, Pos / 4); Count++;}
+}
+for (uint8_t Pos = New_Len; Pos < ((New_Len + 3) / 4) * 4; Pos++) // padding of last segment
+{
+  if ((Pos < Old_Len) && (Old[Pos] != ' ') && !bitRead(Mask, Pos / 4)) {bitSet(Mask, Pos / 4); Count++;}
+}
+return Count;
+}
+//=================================================================================
+
+void RadioTextTable::Sync(Config &Cfg)
+{
+if (ABflag != Cfg.cfg_2A_ADflag) // new text or first call: all segments
+   {
+     ABflag = Cfg.cfg_2A_ADflag;
+     strcpy(Text, Cfg.cfg_2A_Text);
+     Segments = (strlen(Text) + 3) / 4;
+     Dirty = (1UL << Segments) - 1;
+     Refresh = 0;
+   }
+else if (strcmp(Text, Cfg.cfg_2A_Text) != 0) // same A/B flag: changed segments
+   {
+     uint16_t Mask;
+     Changed(Text, Cfg.cfg_2A_Text, Mask);
+     strcpy(Text, Cfg.cfg_2A_Text);
+     Segments = (strlen(Text) + 3) / 4;
+     Dirty = (Dirty | Mask) & ((1UL << Segments) - 1);
+     if (Refresh >= Segments) {Refresh = 0;}
+   }
+}
+//=================================================================================
+
+bool RadioTextTable::NextGroup(uint16_t *Group, SI4713 &TX, Config &Cfg, bool Busy)
+{
+Sync(Cfg);
+if ((Cfg.cfg_2A_Period == 0) || (Segments == 0)) {return false;} // 2A is OFF
+
+uint8_t Segment = 0;
+if (Dirty) // changed segments first, in order
+   {
+     while (!bitRead(Dirty, Segment)) {Segment++;}
+     bitClear(Dirty, Segment);
+     Group_Flags = Dirty ? 0 : TRACE_LAST;
+     Refresh_Time = millis(); // refresh goes on after a pause
+   }
+else // refresh: whole text once in cfg_2A_Period
+   {
+     unsigned long Interval = (Cfg.cfg_2A_Period * 1000UL) / Segments;
+     if (Busy) {Interval *= RT_BUSY_SLOWDOWN;}
+     if ((millis() - Refresh_Time) < Interval) {return false;}
+     Refresh_Time = millis();
+     Segment = Refresh;
+     Refresh = (Refresh + 1) % Segments;
+     Group_Flags = (Refresh == 0) ? TRACE_LAST : 0;
+   }
+
+TX.RDS_2A_BUILD (Group, Cfg.cfg_pi.All, Cfg.cfg_Bo, Cfg.cfg_TP, Cfg.cfg_PTY, ABflag, Text, Segment);
+return true;
+}
+//=================================================================================
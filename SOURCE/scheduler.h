@@ -0,0 +1,163 @@
+/*  Several SI4713 transmitters driven by one scheduler
+ *
+ *  Each transmitter is a lane: chip (own I2C address and bus), paging queue and group sequencer.
+ *  - TX_SIMULCAST: only lane 0 plans groups, each group goes to the FIFO of every chip in the same slot
+ *    (SI4713::Simulcast chain), PI too. Message is encoded once, pager hears it on each frequency.
+ *  - TX_SPREAD: each lane plans own groups (1A/4A/2A on each chip), pages are spread over lanes:
+ *    pager stays on the lane which knows it (A/B flag and call counter are kept in that queue),
+ *    new pager goes to the lane with fewest waiting messages. Country sweep runs on lane 0.
+ *  Poll() gives each chip its next command before waiting for any of them, so I2C busy time of one chip
+ *  overlaps with the others.
+ */
+
+// -------------------------------------------------------- TYPE DEFINITIONS
+#define TX_MAX 2 // transmitters
+
+#define TX_SIMULCAST 0 // same groups on all chips
+#define TX_SPREAD    1 // own groups and pages on each chip
+//=========================================== END TYPE DEFINITIONS =======================================
+
+class TxScheduler
+{
+  public:
+    bool Add(SI4713 &TX, PagingQueue &Pages, GroupSequencer &Sequencer); // New lane, false = TX_MAX lanes
+    void Begin(uint8_t Mode);                                  // TX_SIMULCAST/TX_SPREAD, call after Init() of all chips
+    void Poll();                                               // Send queued commands to all chips
+    uint8_t Run(Config &Cfg, TimeService &Clock, CountrySweep &Sweep); // Plan groups of all lanes, return number of sent groups
+    uint8_t Submit(uint32_t Address, byte Type, const char *Text, const type_Repeat *Repeat = 0); // Message to lane of pager, return message ID (0 = queue is full)
+    uint8_t Count();                                           // Messages waiting in all queues
+    uint16_t Errors();                                         // Sums of chip counters
+    uint16_t Overflows();
+    uint16_t Underflows();
+    uint16_t Missed();
+    void Reset_Counters();
+
+    uint8_t Lanes = 0;
+    uint8_t Mode = TX_SIMULCAST;
+    SI4713 *TX[TX_MAX];
+    PagingQueue *Pages[TX_MAX];
+    GroupSequencer *Sequencer[TX_MAX];
+    PagingQueue *Last = 0;                                     // Queue of last Submit(): Groups, Saved
+
+#if TX_COUNT > 1
+  private:
+    CountrySweep Idle_Sweep;                                   // Lanes without sweep
+#endif
+};
+// =============================================== End Class ======================================
+
+bool TxScheduler::Add(SI4713 &TX, PagingQueue &Pages, GroupSequencer &Sequencer)
+{
+if (Lanes >= TX_MAX) {return false;}
+
+this->TX[Lanes] = &TX;
+this->Pages[Lanes] = &Pages;
+this->Sequencer[Lanes] = &Sequencer;
+Lanes++;
+if (Last == 0) {Last = &Pages;}
+return true;
+}
+//=================================================================================
+
+void TxScheduler::Begin(uint8_t Mode)
+{
+this->Mode = Mode;
+
+for (uint8_t i = 0; i < Lanes; i++)
+{
+  TX[i]->Simulcast = ((Mode == TX_SIMULCAST) && (i + 1 < Lanes)) ? TX[i + 1] : 0;
+  TX[i]->Trace_Flags = ((Mode == TX_SPREAD) && (i > 0)) ? TRACE_TX2 : 0;
+  Pages[i]->Numbering(i + 1, Lanes); // IDs of lanes differ in replies and trace
+  Sequencer[i]->Begin();
+}
+}
+//=================================================================================
+
+void TxScheduler::Poll()
+{
+for (uint8_t i = 0; i < Lanes; i++) {TX[i]->Poll();}
+}
+//=================================================================================
+
+uint8_t TxScheduler::Run(Config &Cfg, TimeService &Clock, CountrySweep &Sweep)
+{
+if (Mode == TX_SIMULCAST)
+{
+  for (uint8_t i = 1; i < Lanes; i++) {if (TX[i]->Pending() >= TX_CMD_QUEUE) {return 0;}} // slowest chip sets the pace
+  return Sequencer[0]->Run(*TX[0], Cfg, *Pages[0], Clock, Sweep);
+}
+
+uint8_t Sent = Sequencer[0]->Run(*TX[0], Cfg, *Pages[0], Clock, Sweep);
+#if TX_COUNT > 1
+for (uint8_t i = 1; i < Lanes; i++) {Sent += Sequencer[i]->Run(*TX[i], Cfg, *Pages[i], Clock, Idle_Sweep);}
+#endif
+return Sent;
+}
+//=================================================================================
+
+uint8_t TxScheduler::Submit(uint32_t Address, byte Type, const char *Text, const type_Repeat *Repeat)
+{
+PagingQueue *Queue = Pages[0];
+
+if (Mode == TX_SPREAD)
+{
+  for (uint8_t i = 1; i < Lanes; i++) {if (Pages[i]->Count() < Queue->Count()) {Queue = Pages[i];}} // fewest waiting
+  for (uint8_t i = 0; i < Lanes; i++) {if (Pages[i]->Knows(Address)) {Queue = Pages[i]; break;}} // pager stays on its lane
+}
+
+Last = Queue;
+return Queue->Submit(Address, Type, Text, Repeat);
+}
+//=================================================================================
+
+uint8_t TxScheduler::Count()
+{
+uint8_t Waiting = 0;
+for (uint8_t i = 0; i < Lanes; i++) {Waiting += Pages[i]->Count();}
+return Waiting;
+}
+//=================================================================================
+
+uint16_t TxScheduler::Errors()
+{
+uint16_t Sum = 0;
+for (uint8_t i = 0; i < Lanes; i++) {Sum += TX[i]->Errors;}
+return Sum;
+}
+//=================================================================================
+
+uint16_t TxScheduler::Overflows()
+{
+uint16_t Sum = 0;
+for (uint8_t i = 0; i < Lanes; i++) {Sum += TX[i]->Fifo.Overflows;}
+return Sum;
+}
+//=================================================================================
+
+uint16_t TxScheduler::Underflows()
+{
+uint16_t Sum = 0;
+for (uint8_t i = 0; i < Lanes; i++) {Sum += TX[i]->Fifo.Underflows;}
+return Sum;
+}
+//=================================================================================
+
+uint16_t TxScheduler::Missed()
+{
+uint16_t Sum = 0;
+for (uint8_t i = 0; i < Lanes; i++) {Sum += Sequencer[i]->Missed;}
+return Sum;
+}
+//=================================================================================
+
+void TxScheduler::Reset_Counters()
+{
+for (uint8_t i = 0; i < Lanes; i++)
+{
+  TX[i]->Errors = 0;
+  TX[i]->Fifo.Overflows = 0;
+  TX[i]->Fifo.Underflows = 0;
+  Sequencer[i]->Missed = 0;
+}
+}
+//=================================================================================
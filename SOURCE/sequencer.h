@@ -0,0 +1,228 @@
+/*  RDS group sequencer
+ *
+ *  RDS sends 1187.5 bit/s = 11.4 groups per second, one group = 104 bits = 87.58 ms = one air-time slot.
+ *  Sequencer plans each slot before it goes to air: the group written now will go to air after all groups in chip FIFO,
+ *  so its slot = current slot + FIFO level + 1 (group in progress).
+ *
+ *  Slot priorities (seconds and minutes of UTC from clock.h, not from Begin()):
+ *  - first slot of each second: 1A (paging synchronization)
+ *  - first slot of each minute: 4A (date and time) instead of 1A, prepared by TimeService in idle time
+ *  - other slots: 7A from paging queue (when pager is awake, see paging.h) or from country sweep (sweep.h),
+ *    then 2A radio text: changed segments, else refresh when it is due (radiotext.h)
+ *  - nothing to send: FIFO stays empty and chip sends PS (0A) groups, see RDS_PS_MIX(0)
+ *
+ *  FIFO is kept SEQ_LEAD groups ahead, so timing doesn't depend on how long loop() takes.
+ *  With monitor ON a slot is planned only when the trace ring has place for all its records (trace.h).
+ *  Country sweep stops writing while FIFO drains before PI changes, block A of all groups is PI on air.
+ *
+ *  Urgent message (paging.h) which interrupts a message on air doesn't wait behind its groups in FIFO:
+ *  FIFO is emptied (MTBUFF) and the last planned groups which are not on air yet are written again (FIFO level
+ *  from a fresh answer of the chip, slot clock of the sequencer can be one slot behind the air clock of the chip),
+ *  each in its own slot, so 1A/4A timing and 2A segment order stay. Slots of the interrupted message get urgent groups;
+ *  when paging has nothing for such a slot it gets a 2A segment, else its old group again (pager ignores 7A groups
+ *  without address group, the interrupted message starts again from its address group). No slot is left out.
+ */
+
+#define SEQ_SLOT_NUM 1664 // Slot length = 104 / 1187.5 s = 1664 / 19 ms
+#define SEQ_SLOT_DEN 19
+
+// -------------------------------------------------------- TYPE DEFINITIONS
+typedef struct
+{
+  uint32_t Slot;               // Air-time slot
+  uint16_t Group[4];           // Blocks A, B, C, D as written
+  uint8_t ID;                  // Paging queue ID, 0 = not a queued message
+  uint8_t Flags;               // For monitor trace
+} type_Planned;
+//=========================================== END TYPE DEFINITIONS =======================================
+
+class GroupSequencer
+{
+  public:
+    void Begin();                                              // Start slot clock, call at the end of setup()
+    uint8_t Run(SI4713 &TX, Config &Cfg, PagingQueue &Pages, TimeService &Clock, CountrySweep &Sweep); // Plan groups for next slots, return number of sent groups
+    uint32_t Slot();                                           // Slot going to air now
+    uint16_t Missed = 0;                                       // 1A/4A which were not sent in the first slot of their second
+
+  private:
+    uint32_t SlotStart(uint32_t Slot);                         // Start time of slot from Begin(), ms
+    uint32_t MinuteTime(uint32_t Slot, TimeService &Clock);    // Start of slot from minute start, ms
+    void Remember(uint32_t Slot, const uint16_t *Group, uint8_t ID, uint8_t Flags); // Keep planned group for Reload()
+    bool Reload(SI4713 &TX, Config &Cfg, PagingQueue &Pages, TimeService &Clock, CountrySweep &Sweep,
+                uint16_t *Group, uint8_t &ID, uint8_t &Flags, uint32_t Next); // Urgent message: FIFO again without interrupted message
+    type_Planned &Planned(uint8_t i) {return Plan[(Plan_Head + i) % SEQ_PLAN];} // i = 0: oldest
+
+    unsigned long Epoch = 0;     // millis() of slot 0
+    uint32_t Last_Slot = 0;      // Slot of last planned group
+    uint32_t Last_Second = 0;    // Second of last planned 1A/4A
+    RadioTextTable RT;              // 2A segments of this lane
+    type_Planned Plan[SEQ_PLAN]; // Last planned groups
+    uint8_t Plan_Head = 0;
+    uint8_t Plan_Used = 0;
+};
+// =============================================== End Class ======================================
+
+void GroupSequencer::Begin()
+{
+  Epoch = millis();
+  Last_Slot = 0;
+  Last_Second = 0;
+  Plan_Used = 0;
+}
+//=================================================================================
+
+uint32_t GroupSequencer::Slot()
+{
+  unsigned long ms = millis() - Epoch;
+  return (ms / SEQ_SLOT_NUM) * SEQ_SLOT_DEN + ((ms % SEQ_SLOT_NUM) * SEQ_SLOT_DEN) / SEQ_SLOT_NUM;
+}
+//=================================================================================
+
+uint32_t GroupSequencer::SlotStart(uint32_t Slot)
+{
+  return (Slot / SEQ_SLOT_DEN) * SEQ_SLOT_NUM + ((Slot % SEQ_SLOT_DEN) * SEQ_SLOT_NUM + SEQ_SLOT_DEN - 1) / SEQ_SLOT_DEN; // round up: slot starts inside this ms
+}
+//=================================================================================
+
+uint32_t GroupSequencer::MinuteTime(uint32_t Slot, TimeService &Clock)
+{
+  unsigned long Start = Epoch + SlotStart(Slot);
+  return (Clock.Seconds(Start) % 60) * 1000UL + Clock.Millis(Start);
+}
+//=================================================================================
+
+uint8_t GroupSequencer::Run(SI4713 &TX, Config &Cfg, PagingQueue &Pages, TimeService &Clock, CountrySweep &Sweep)
+{
+uint8_t Sent = 0;
+
+while ((TX.RDS_FIFO_USED() < SEQ_LEAD) && (TX.Pending() < TX_CMD_QUEUE)) // don't wait for the chip
+{
+  if (Sweep.Hold(TX, Cfg, Pages.Busy())) {break;} // PI changes when FIFO is empty
+  if (Cfg.cfg_Monitor && (Trace.Free() < SEQ_PLAN + 1)) {break;} // monitor: place for records of Reload() first, Trace.Drain() makes it
+  bool Sweeping = Sweep.Active() && !Pages.Busy(); // paging queue waits for country sweep
+  uint32_t Next = Slot() + TX.RDS_FIFO_USED() + 1; // slot of next written group
+  if (Next <= Last_Slot) {Next = Last_Slot + 1;} // FIFO level is estimation, never plan one slot twice
+
+  unsigned long Start = Epoch + SlotStart(Next); // millis() of slot start
+  uint32_t Second = Clock.Seconds(Start);
+  uint16_t Group[4]; // blocks A, B, C, D
+  uint8_t ID = 0, Flags = 0; // for monitor trace
+
+  if (Second != Last_Second) // new second: sync group
+  {
+    if (Next > 0 && Clock.Seconds(Epoch + SlotStart(Next - 1)) == Second) {Missed++;} // not first slot of this second
+    Last_Second = Second;
+
+    if ((Second % 60) == 0) // new minute
+       {
+         Clock.Group_4A(Group, Second, TX, Cfg);
+         Clock.Planned(Second); // start on air is measured from FIFO answers of the chip
+       }
+    else 
+       {
+         TX.RDS_1A_BUILD (Group, Cfg.cfg_pi.All, Cfg.cfg_Bo, Cfg.cfg_TP, Cfg.cfg_PTY, Cfg.cfg_1A_Rpc, Cfg.cfg_1A_Slc, Cfg.cfg_1A_Pinc);
+       }
+  }
+  else if (Sweeping ? Sweep.NextGroup(Group, TX, Cfg, (Second % 60) * 1000UL + Clock.Millis(Start))
+                    : Pages.NextGroup(Group, TX, Cfg, (Second % 60) * 1000UL + Clock.Millis(Start))) // paging
+  {
+    ID = Sweeping ? 0 : Pages.Group_ID;
+    Flags = Sweeping ? Sweep.Group_Flags : Pages.Group_Flags;
+    if (Pages.Preempted && !Reload(TX, Cfg, Pages, Clock, Sweep, Group, ID, Flags, Next)) {break;} // urgent message
+  }
+  else if (RT.NextGroup(Group, TX, Cfg, Pages.Count() || Sweep.Active())) {Flags = RT.Group_Flags;} // radio text
+  else {break;} // nothing to send now
+
+  Group[0] = Sweep.PI(Group[0]); // chip sends PI property as block A
+  TX.RDS_SEND_GROUP(Group, Cfg.cfg_Monitor, ID, Flags);
+  Remember(Next, Group, ID, Flags);
+  Last_Slot = Next;
+  Sent++;
+}
+
+return Sent;
+}
+//=================================================================================
+
+void GroupSequencer::Remember(uint32_t Slot, const uint16_t *Group, uint8_t ID, uint8_t Flags)
+{
+if (Plan_Used < SEQ_PLAN) {Plan_Used++;} else {Plan_Head = (Plan_Head + 1) % SEQ_PLAN;} // oldest is on air
+type_Planned &Entry = Planned(Plan_Used - 1);
+Entry.Slot = Slot;
+memcpy(Entry.Group, Group, 8);
+Entry.ID = ID;
+Entry.Flags = Flags;
+}
+//=================================================================================
+
+bool GroupSequencer::Reload(SI4713 &TX, Config &Cfg, PagingQueue &Pages, TimeService &Clock, CountrySweep &Sweep,
+                            uint16_t *Group, uint8_t &ID, uint8_t &Flags, uint32_t Next)
+// Input: Group/ID/Flags = first group of urgent message for slot Next; output: group for slot Next, false = none
+{
+uint8_t Dropped = Pages.Preempted;
+bool Found = false;
+Pages.Preempted = 0;
+
+TX.Flush(); // FIFO level from a fresh answer: estimate between answers can be one group high
+TX.RDS_FIFO_STATUS();
+TX.Flush();
+uint8_t In_FIFO = TX.RDS_FIFO_USED();
+uint8_t First = (In_FIFO < Plan_Used) ? Plan_Used - In_FIFO : 0; // groups in FIFO are the last planned ones, older are on air
+for (uint8_t i = First; i < Plan_Used; i++) {if (Planned(i).ID == Dropped) {Found = true;}}
+if (!Found) {return true;} // no group of interrupted message in FIFO
+
+uint16_t Carry[4];
+uint8_t Carry_ID = ID, Carry_Flags = Flags;
+bool Have = true;
+memcpy(Carry, Group, 8);
+
+TX.RDS_FIFO_CLEAR();
+for (uint8_t i = First; i < Plan_Used; i++)
+{
+  type_Planned &Entry = Planned(i);
+  if (Entry.ID != Dropped) // 1A/4A/2A and other messages: same group in same slot, monitor has it already
+     {
+       TX.RDS_SEND_GROUP(Entry.Group, 0, Entry.ID, Entry.Flags);
+       Stats.Groups_Reloaded++;
+       continue;
+     }
+
+  if (!Have)
+     {
+       Have = Pages.NextGroup(Carry, TX, Cfg, MinuteTime(Entry.Slot, Clock));
+       Carry_ID = Pages.Group_ID;
+       Carry_Flags = Pages.Group_Flags;
+     }
+  if (!Have && RT.NextGroup(Carry, TX, Cfg, true)) // slot must not stay empty, else later groups go one slot earlier
+     {
+       Have = true;
+       Carry_ID = 0;
+       Carry_Flags = RT.Group_Flags;
+     }
+  if (!Have) // old group of interrupted message, it is in monitor trace already
+     {
+       TX.RDS_SEND_GROUP(Entry.Group, 0, Entry.ID, Entry.Flags);
+       Stats.Groups_Reloaded++;
+       continue;
+     }
+
+  Carry[0] = Sweep.PI(Carry[0]);
+  TX.RDS_SEND_GROUP(Carry, Cfg.cfg_Monitor, Carry_ID, Carry_Flags);
+  memcpy(Entry.Group, Carry, 8);
+  Entry.ID = Carry_ID;
+  Entry.Flags = Carry_Flags;
+  Have = false;
+}
+
+if (!Have)
+   {
+     Have = Pages.NextGroup(Carry, TX, Cfg, MinuteTime(Next, Clock));
+     Carry_ID = Pages.Group_ID;
+     Carry_Flags = Pages.Group_Flags;
+   }
+memcpy(Group, Carry, 8);
+ID = Carry_ID;
+Flags = Carry_Flags;
+return Have;
+}
+//=================================================================================
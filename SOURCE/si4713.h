@@ -1,1111 +1,1578 @@
-/*  Full option SI4713 library with advanced RDS and MPX settings
- *   
- *  v1.0 - Sjef Verhoeven PE5PVB
- *  *  Website: https://www.pe5pvb.nl/
- *  Github:  https://github.com/PE5PVB
- * 
- *  v2.0 - Added functions for 1A, 4A, 7A Groups   
- *  
-*/
-
-#include <Wire.h>
-#include "tools.h" // some tools for project
-
-// -------------------------------------------------------- TYPE DEFINITIONS
-/**
- * Type Block Converts 16 bits word to two bytes
- */
-typedef union
-{
-    struct
-    {
-      uint8_t LowByte;
-      uint8_t HighByte;
-    } refined;
-    uint16_t raw;
-} Block;
-
-
-/**
- * Group 4A ( RDS Date and Time)
- *
- * To make it compatible with 8, 16 and 32 bits platforms and avoid Crosses boundary, it was necessary to
- * use uint32_t data type.
- */
-typedef union
-{
-    struct
-    {
-        uint32_t offset : 5;       // Local Time Offset from 0 to 15:30
-        uint32_t offset_sense : 1; // Local Offset Sign ( 0 = + , 1 = - )
-        uint32_t minute : 6;       // UTC Minutes - 2 bits less significant (void “Crosses boundary”).
-        uint32_t hour : 5;         // UTC Hours - 4 bits less significant (void “Crosses boundary”)
-        uint32_t mjd : 17;         // Modified Julian Day 
-        uint32_t spr : 3;          // Spare bits
-        uint32_t pty : 5;          // PTY, program type, 01000(8d) = Science
-        uint32_t TP : 1;           // Traffic Programm bit, 0=Non TP, 1=TP
-        uint32_t Bo : 1;           // RDS Version, 0=A, 1=B
-        uint32_t type : 4;         // Group type 4=Date and Time
-        uint32_t pid : 16;           // Programm Identification
-     } refined;
-  
-    uint16_t raw[4]; // 4 16 bit words for blocks A,B,C,D 
-    
-} type_4A;
-
-/**
- * Group 2A ( RDS Radio Text)
- *
- * To make it compatible with 8, 16 and 32 bits platforms and avoid Crosses boundary, it was necessary to
- * use uint32_t data type.
- */
-typedef union
-{
-    struct
-    {
-        uint32_t text2 : 16;       // 3 and 4 symbols 
-        uint32_t text1 : 16;       // 1 and 2 symbols  
-        uint32_t counter : 4;      // Message blocks counter,  
-        uint32_t ABflag : 1;       // Text A/B flag. I haven't studied this flag, I always use 0
-        uint32_t pty : 5;          // PTY, program type, 01000(8d) = Science
-        uint32_t TP : 1;           // Traffic Programm bit, 0=Non TP, 1=TP
-        uint32_t Bo : 1;           // RDS Version, 0=A, 1=B
-        uint32_t type : 4;         // Group type 4=Date and Time
-        uint32_t pid : 16;         // Programm Identification
-     } refined;
-  
-    uint16_t raw[4]; // 4 16 bit words for blocks A,B,C,D 
-    
-} type_2A;
-//--------------------------------------------------
-
-/**
- * Group 1A ( RDS Programm Item Number and slow labeling Codes)
- * 
- * Use for pafing synchronization, must be send each second 
- *
- * To make it compatible with 8, 16 and 32 bits platforms and avoid Crosses boundary, it was necessary to
- * use uint32_t data type.
- */
-typedef union
-{
-    struct
-    {
-        uint32_t pinc : 16;        // Programme Item Number Code (see 3.2.1.7) 
-        uint32_t slc : 16;         // Slow Labeling Code (see 3.1.5.2) 
-        uint32_t rpc : 5;          // Radio Paging Codes (see Annex M)
-        uint32_t pty : 5;          // PTY, program type, 01000(8d) = Science
-        uint32_t TP : 1;           // Traffic Programm bit, 0=Non TP, 1=TP
-        uint32_t Bo : 1;           // RDS Version, 0=A, 1=B
-        uint32_t type : 4;         // Group type 4=Date and Time
-        uint32_t pid : 16;         // Programm Identification
-     } refined;
-  
-    uint16_t raw[4]; // 4 16 bit words for blocks A,B,C,D 
-    
-} type_1A;
-
-/**
- * Group 7A ( RDS Paging)
- *
- * To make it compatible with 8, 16 and 32 bits platforms and avoid Crosses boundary, it was necessary to
- * use uint32_t data type.
- */
-typedef union
-{
-    struct
-    {
-        uint32_t data : 16;        // address or data 
-        uint32_t address: 16;      // address or data  
-        uint32_t psac : 4;         // Paging Segment Address Code (have 4 variants for Tone/10/18/Alpha  
-        uint32_t ABflag : 1;       // Text A/B flag. For new message A/B flag must be changed from 0 to 1, or from 0 to 1
-        
-        uint32_t pty : 5;          // PTY, program type, 01000(8d) = Science
-        uint32_t TP : 1;           // Traffic Programm bit, 0=Non TP, 1=TP
-        uint32_t Bo : 1;           // RDS Version, 0=A, 1=B
-        uint32_t type : 4;         // Group type 7A paging
-        uint32_t pid : 16;         // Programm Identification
-     } refined;
-  
-    uint16_t raw[4]; // 4 16 bit words for blocks A,B,C,D 
-    
-} type_7A;
-//--------------------------------------------------
-
-/**
- * Group 7A ( RDS Paging) Adress Block C,D
- *
- * To make it compatible with 8, 16 and 32 bits platforms and avoid Crosses boundary, it was necessary to
- * use uint32_t data type.
- */
-typedef union
-{
-    struct
-    {
-        uint32_t d_2 : 4;        // 2 symbol 
-        uint32_t d_1 : 4;        // 1 symbol 
-        uint32_t a_6 : 4;         // 6 digit  
-        uint32_t a_5 : 4;         // 5 digit  
-        uint32_t a_4 : 4;         // 4 digit  
-        uint32_t a_3 : 4;         // 3 digit  
-        uint32_t a_2 : 4;         // 2 digit  
-        uint32_t a_1 : 4;         // 1 digit  
-     } refined;
-  
-    uint16_t raw[2]; // 2 16 bit words for blocks C,D 
-    
-} type_7A_adress;
-
-/**
- * Group 7A ( RDS Paging) Adress Block D FOR ALPHA
- * 
- */
-typedef union
-{
-    struct
-    {
-        uint8_t data_hi : 4;        // High Bits 
-        uint8_t data_lo : 4;        // Low Bits 
-     } refined;
-  
-    uint8_t raw; // 2 16 bit words for blocks C,D 
-    
-} type_7A_AplusD;
-
-/**
- * Group 7A ( RDS Paging) Last byte in D Block for alpha messages (page 114)
- * For future, not used now 
- */
-typedef union
-{
-    struct
-    {
-        uint8_t CallCounter        : 4;    // Use for check missing messages 
-        uint8_t RepeatFlag         : 1;    // Repeated Message
-        uint8_t InternationalFlag  : 1;    // 0=National; 1=International
-        uint8_t MessageType        : 2;    // 00=Alpha; 01=Variable Length Numeric Message; 10=Reserved ; 11=Variable-length function message
-    } refined;
-  
-    uint8_t raw; //  
-    
-} type_7A_X1X2;
-
-//-----------------------------------------------------------------------------------------------
-// PI (programm_identification) union 
-// 0x62E7 6=Country Ukraine; 2=National Network; E7=Programm Reference Number (Jazz FM)
-// Country code (CC) is important !!! See in RDS Protocol Annex D and description of EEPROM DUMP
-// Also you can try CC from 1 to F, or use Internetional Mode if pager supports this Mode
-typedef union
-{
-    struct
-    {
-        uint8_t pi_prn     : 8; // Programm Reference Number (does NOT affect for paging)
-        uint8_t pi_area    : 4; // Programm Area Coverage (does NOT affect for paging)
-        uint8_t pi_country : 4; // Country Code ! IMPORTANT ! 
-     } refined;
-    uint16_t All; // PI Structure, RDS block A
-} type_pi;
-//============================================================================================
-
-// UTC Offset union ---------------------------------------------------------------------------
-typedef union
-{
-    struct
-    {
-        uint8_t offset_minute : 1; // 0-00, 1-30
-        uint8_t offset_hour   : 4; // 0-00, FF-15
-        uint8_t offset_sign   : 1; // 0-"+", 1-"-"
-     } refined;
-    uint8_t All; // Offset for 4A group 
-} type_Offset;
-//================================
-
-#include "config.h" //Settings
-//=========================================== END TYPE DEFINITIONS =======================================
-
-uint8_t buf[10];
-uint16_t component;
-uint16_t acomp;
-uint16_t misc;
-int addr;
-uint8_t GPO;
-
-class SI4713
-{
-  public:
-    void Init(uint8_t RST, uint16_t clk, uint8_t address);
-    void Output(uint8_t level, uint8_t cap);
-    void Freq(uint16_t freq);
-    void RDS_PI(uint16_t RDSPI);
-    void RDS_PTY(uint8_t RDSPTY);
-    void RDS_COMP(bool ONOFF);
-    void RDS_ART(bool ONOFF);
-    void RDS_MS(bool ONOFF);
-    void RDS_TP(bool ONOFF);
-    void RDS_TA(bool ONOFF);
-    void RDS_AF(uint16_t AF);
-    void RDS_PS(String PS, uint8_t number);
-    void RDS_RT(String RT);
-    void RDS_PS_MIX(uint16_t PS_MIX); // Sets the ratio of RDS PS (group 0A) and circular buffer/FIFO groups.
-
-    void RDS_MUSP(bool ONOFF);
-    void RDS_PSCOUNT(uint8_t count, uint8_t speed);
-    void RDS_Enable(bool ONOFF);
-    void MPX_Enable(bool ONOFF);
-    void Audio_Mute(bool ONOFF);
-    void MPX_Deviation(uint16_t dev);
-    void RDS_Deviation(uint16_t dev);
-    void Audio_PreEmphasis(uint16_t emp);
-    void MPX_Freq(uint16_t freq);
-    void Audio_Limiter(bool ONOFF);
-    void Audio_AGC(bool ONOFF);
-    void Audio_Comp_Threshold(int16_t threshold);
-    void Audio_Comp_Attack(uint16_t attack);
-    void Audio_Comp_Release(uint16_t rel);
-    void Audio_Comp_Gain(uint16_t gain);
-    void Audio_Limiter_Release(uint16_t rel);
-    void Audio_Deviation(uint16_t dev);
-    void ASQ(bool &overmod, int8_t &inlevel);
-    void Rev(uint8_t &pn, uint8_t &chiprev);
-    void GPO(bool GPO1, bool GPO2, bool GPO3);
-
-    // PLAB Updates
-    void RDS_SEND_BUFFER (Block A, Block B, Block C, Block D, String Group, byte Monitor); //send RDS buffer 
-    void RDS_4A_TIME (uint16_t rds_pi, byte Bo, byte TP, byte PTY, uint16_t Year, byte Month, byte Day, byte Hour, byte Minute, byte O_Sign, byte O_Hour, byte O_Minute, byte Monitor); // Send 4A/4B group: Date and Time
-    void RDS_2A_RT   (uint16_t rds_pi, byte Bo, byte TP, byte PTY, byte ABflag, String RT, byte Monitor); //Send RadioText (old RDS_RT)
-    void RDS_1A_PIN (uint16_t rds_pi, byte Bo, byte TP, byte PTY, byte rpc, uint16_t slc, uint16_t pinc, byte Monitor);  //Send 1A group PIN ans SLC
-    void RDS_7A_PAGING (uint16_t rds_pid, byte Bo, byte TP, byte PTY, byte ABflag, byte Type, uint32_t Address, String M_Text, byte Monitor); //Send Message
-    // End PLAB 
-
-  private:
-    bool WriteBuffer(uint8_t len);
-    bool ReadBuffer(uint8_t len);
-    bool Set_Property(uint16_t arg1, uint16_t arg2);
-};
-// =============================================== End Class ======================================
-
-bool SI4713::ReadBuffer(uint8_t len)
-{
-}
-
-bool SI4713::WriteBuffer(uint8_t len)
-{
-  Wire.beginTransmission(addr);
-  for (uint8_t i = 0; i < len; i++) {
-    Wire.write(buf[i]);
-    if (buf[i] < 0x10) {
-    }
-  }
-  Wire.endTransmission();
-  delay(54);
-  Wire.requestFrom(addr, 1);
-  while (bitRead(Wire.read(), 7) != 1) {}
-}
-
-bool SI4713::Set_Property(uint16_t arg1, uint16_t arg2)
-{
-  buf[0] = 0x12;
-  buf[1] = 0x00;
-  buf[2] = highByte(arg1);
-  buf[3] = lowByte(arg1);
-  buf[4] = highByte(arg2);
-  buf[5] = lowByte(arg2);
-  WriteBuffer(6);
-}
-
-void SI4713::Output(uint8_t level, uint8_t cap)
-{
-  buf[0] = 0x31;
-  buf[1] = 0x00;
-  buf[2] = 0x00;
-  buf[3] = level;
-  buf[4] = cap;
-  WriteBuffer(5);
-}
-
-void SI4713::Freq(uint16_t freq)
-{
-  buf[0] = 0x30;
-  buf[1] = 0x00;
-  buf[2] = highByte(freq);
-  buf[3] = lowByte(freq);
-  WriteBuffer(4);
-}
-
-void SI4713::RDS_PI(uint16_t RDSPI)
-{
-  Set_Property(0x2c01, RDSPI);
-}
-
-void SI4713::RDS_PSCOUNT(uint8_t count, uint8_t speed)
-{
-  Set_Property(0x2c05, count);
-  Set_Property(0x2c04, speed);
-}
-
-void SI4713::RDS_PTY(uint8_t RDSPTY)
-{
-  bitWrite(misc, 5, bitRead(RDSPTY, 0));
-  bitWrite(misc, 6, bitRead(RDSPTY, 1));
-  bitWrite(misc, 7, bitRead(RDSPTY, 2));
-  bitWrite(misc, 8, bitRead(RDSPTY, 3));
-  bitWrite(misc, 9, bitRead(RDSPTY, 4));
-  Set_Property(0x2c03, misc);
-}
-
-void SI4713::RDS_COMP(bool ONOFF)
-{
-  if (ONOFF == true) {
-    bitWrite(misc, 14, 1);
-  } else {
-    bitWrite(misc, 14, 0);
-  }
-  Set_Property(0x2c03, misc);
-}
-
-void SI4713::RDS_ART(bool ONOFF)
-{
-  if (ONOFF == true) {
-    bitWrite(misc, 13, 1);
-  } else {
-    bitWrite(misc, 13, 0);
-  }
-  Set_Property(0x2c03, misc);
-}
-
-void SI4713::RDS_MS(bool ONOFF)
-{
-  if (ONOFF == true) {
-    bitWrite(misc, 12, 1);
-  } else {
-    bitWrite(misc, 12, 0);
-  }
-  Set_Property(0x2c03, misc);
-}
-
-void SI4713::RDS_TP(bool ONOFF)
-{
-  if (ONOFF == true) {
-    bitWrite(misc, 10, 1);
-  } else {
-    bitWrite(misc, 10, 0);
-  }
-  Set_Property(0x2c03, misc);
-}
-
-void SI4713::RDS_TA(bool ONOFF)
-{
-  if (ONOFF == true) {
-    bitWrite(misc, 4, 1);
-  } else {
-    bitWrite(misc, 4, 0);
-  }
-  Set_Property(0x2c03, misc);
-}
-
-void SI4713::RDS_AF(uint16_t AF)
-{
-  if (AF == 0) {
-    Set_Property(0x2c06, 0xe0e0);
-  } else {
-    Set_Property(0x2c06, 0xdd95 + AF);
-  }
-}
-
-void SI4713::RDS_MUSP(bool ONOFF)
-{
-  if (ONOFF == true) {
-    bitWrite(misc, 3, 1);
-  } else {
-    bitWrite(misc, 3, 0);
-  }
-  Set_Property(0x2c03, misc);
-}
-
-void SI4713::RDS_Enable(bool ONOFF)
-{
-  if (ONOFF == true) {
-    bitWrite(component, 2, 1);
-  } else {
-    bitWrite(component, 2, 0);
-  }
-  Set_Property(0x2100, component);
-}
-
-void SI4713::Audio_Comp_Threshold(int16_t threshold)
-{
-  Set_Property(0x2201, threshold);
-}
-
-void SI4713::Audio_Comp_Attack(uint16_t attack)
-{
-  Set_Property(0x2202, attack);
-}
-
-void SI4713::Audio_Comp_Release(uint16_t rel)
-{
-  Set_Property(0x2203, rel);
-}
-
-void SI4713::Audio_Comp_Gain(uint16_t gain)
-{
-  Set_Property(0x2204, gain);
-}
-
-void SI4713::Audio_Limiter_Release(uint16_t rel)
-{
-  Set_Property(0x2205, rel);
-}
-
-void SI4713::Audio_Limiter(bool ONOFF)
-{
-  if (ONOFF == true) {
-    bitWrite(acomp, 1, 1);
-  } else {
-    bitWrite(acomp, 1, 0);
-  }
-  Set_Property(0x2200, acomp);
-}
-
-void SI4713::Audio_AGC(bool ONOFF)
-{
-  if (ONOFF == true) {
-    bitWrite(acomp, 0, 1);
-  } else {
-    bitWrite(acomp, 0, 0);
-  }
-  Set_Property(0x2200, acomp);
-}
-
-void SI4713::MPX_Enable(bool ONOFF)
-{
-  if (ONOFF == true) {
-    bitWrite(component, 0, 1);
-    bitWrite(component, 1, 1);
-  } else {
-    bitWrite(component, 0, 0);
-    bitWrite(component, 1, 0);
-  }
-  Set_Property(0x2100, component);
-}
-
-void SI4713::Audio_Mute(bool ONOFF)
-{
-  if (ONOFF == false) {
-    Set_Property(0x2105, 0x0000);
-  } else {
-    Set_Property(0x2105, 0x0003);
-  }
-}
-
-void SI4713::Audio_PreEmphasis(uint16_t emp)
-{
-  if (emp == 0) {
-    Set_Property(0x2106, 0x0002);
-  } else if (emp == 75) {
-    Set_Property(0x2106, 0x0000);
-  } else if (emp == 50) {
-    Set_Property(0x2106, 0x0001);
-  }
-}
-
-void SI4713::MPX_Freq(uint16_t freq)
-{
-  Set_Property(0x2107, freq);
-}
-
-void SI4713::MPX_Deviation(uint16_t dev)
-{
-  Set_Property(0x2102, dev);
-}
-
-void SI4713::RDS_Deviation(uint16_t dev)
-{
-  Set_Property(0x2103, dev);
-}
-
-void SI4713::Audio_Deviation(uint16_t dev)
-{
-  Set_Property(0x2101, dev);
-}
-
-void SI4713::GPO(bool GPO1, bool GPO2, bool GPO3)
-{
-  buf[0] = 0x81;
-  if (GPO1 == true)
-  {
-    bitWrite(buf[1], 1, 1);
-  } else {
-    bitWrite(buf[1], 1, 0);
-  }
-  if (GPO2 == true)
-  {
-    bitWrite(buf[1], 2, 1);
-  } else {
-    bitWrite(buf[1], 2, 0);
-  }
-  if (GPO3 == true)
-  {
-    bitWrite(buf[1], 3, 1);
-  } else {
-    bitWrite(buf[1], 3, 0);
-  }
-  WriteBuffer(2);
-
-}
-
-void SI4713::RDS_PS(String PS, uint8_t number)
-{
-  char PSArray[9];
-  for (uint8_t i = 0; i < 9; i++) {
-    PSArray[i] = 0x20;
-  }
-  PS.toCharArray(PSArray, 9);
-  for (uint8_t i = 0; i < 8; i++) {
-    if (PSArray[i] == 0x00)
-    {
-      PSArray[i] = 0x20;
-    }
-  }
-  buf[0] = 0x36;
-  if (number > 0) {
-    buf[1] = number * 2;
-  } else {
-    buf[1] = 0x00;
-  }
-  buf[2] = PSArray[0];
-  buf[3] = PSArray[1];
-  buf[4] = PSArray[2];
-  buf[5] = PSArray[3];
-  WriteBuffer(6);
-  buf[0] = 0x36;
-  if (number > 0) {
-    buf[1] = (number * 2) + 1;
-  } else {
-    buf[1] = 0x01;
-  }
-  buf[2] = PSArray[4];
-  buf[3] = PSArray[5];
-  buf[4] = PSArray[6];
-  buf[5] = PSArray[7];
-  WriteBuffer(6);
-}
-
-void SI4713::RDS_RT(String RT) //Old functıon. I use new TX.RDS_2A_PAGING
-{
-  char RTArray[32];
-  for (uint8_t i = 0; i < 32; i++) {
-    RTArray[i] = 0x20;
-  }
-
-  RT.toCharArray(RTArray, 32);
-  for (uint8_t i = 0; i < 32; i++) {
-    if (RTArray[i] == 0x00)
-    {
-      RTArray[i] = 0x20;
-    }
-  }
-  uint8_t counter = 0;
-  for (uint8_t i = 0; i < 8; i++) {
-    buf[0] = 0x35;
-    if (i == 0) {
-      buf[1] = 0x84; //source  value = 0x06 cirlcle buffer clear and start
-    } else {
-      buf[1] = 0x84; //Source  value = 0x04 cirlcle buffer
-    }
-    buf[2] = 0x20;
-    buf[3] = i;
-    buf[4] = RTArray[0 + counter];
-    buf[5] = RTArray[1 + counter];
-    buf[6] = RTArray[2 + counter];
-    buf[7] = RTArray[3 + counter];
-    WriteBuffer(8);
-    counter += 4;
-  }
-}
-
-void SI4713::Init(uint8_t RST, uint16_t clk, uint8_t address)
-{
-  addr = address;           // Copy I2C address
-  pinMode(RST, OUTPUT);     // Send RST
-  digitalWrite(RST, HIGH);
-  delay(100); //source 50
-  digitalWrite(RST, LOW);
-  delay(100); //source 50
-  digitalWrite(RST, HIGH);
-  Wire.begin();
-  Wire.beginTransmission(addr);
-  Wire.write(0x01);
-  Wire.write(0x12);
-  Wire.write(0x50);
-  Wire.endTransmission();
-  buf[0] = 0x80;
-  buf[1] = 0x0e;
-  WriteBuffer(2);
-  Set_Property(0x0201, clk);
-  Set_Property(0x2300, 0x0007); // Enable ASQ Interrupts
-  Set_Property(0x2C07, 0x0036); // Property 0x2C07. TX_RDS_FIFO_SIZE 0=FIFO Disabled, 4, 7, 10–54 
-  
-}
-
-void SI4713::ASQ(bool &overmod, int8_t &inlevel)
-{
-  buf[0] = 0x34;
-  buf[1] = 0x00;
-  WriteBuffer(2);
-  uint8_t resp[5];
-  uint8_t len = 5;
-  Wire.requestFrom(0x63, 5);
-  if (Wire.available() == len) {
-    for (uint16_t i = 0; i < len; i++) {
-      resp[i] = Wire.read();
-    }
-    overmod = bitRead(resp[1], 2);
-    inlevel = resp[4];
-    buf[0] = 0x34;
-    buf[1] = 0x01;
-    WriteBuffer(2);
-    return overmod, inlevel;
-  }
-}
-
-void SI4713::Rev(uint8_t &pn, uint8_t &chiprev)
-{
-  buf[0] = 0x10;
-  WriteBuffer(1);
-  uint8_t resp[9];
-  uint8_t len = 9;
-  Wire.requestFrom(0x63, 9);
-  if (Wire.available() == len) {
-    for (uint16_t i = 0; i < len; i++) {
-      resp[i] = Wire.read();
-    }
-    pn = resp[1];
-    chiprev = resp[8];
-  }
-  return pn, chiprev;
-}
-
-// ------------------  Paging LAB  ---------------------------------
-void SI4713::RDS_PS_MIX(uint16_t PS_MIX) //TX_RDS_PS_MIX 0=Only send RDS PS if RDS Group Buffer is empty; 3=defaul 50% time
-{
- Set_Property(0x2c02, PS_MIX);
-}
-//=======================================================================================================
-
-void SI4713::RDS_1A_PIN(uint16_t rds_pi, byte Bo, byte TP, byte PTY, byte rpc, uint16_t slc, uint16_t pinc, byte Monitor )
-// Innput: PI, Bo, TP, PTY, RPC, SLC, PINC, Monitor
-// Monitor: 1-Output full info, 0-Output only "T"
-{
-type_1A Sync; // create 1A group union for send 
-Block block_A, block_B, block_C, block_D; // create 2 bytes blocks for send
-
-Sync.refined.pinc = pinc; //  
-Sync.refined.slc = slc; //  
-Sync.refined.rpc = rpc; //  
-Sync.refined.pty = PTY; //set PTY as Jazz channel; Does not matter
-Sync.refined.TP = TP;  //set TP; Does not matter
-Sync.refined.Bo = Bo; // Must be 0 = Version A 
-Sync.refined.type = 1; //Must be 1
-Sync.refined.pid = rds_pi; // PI Programm identification
-
-// Fill RDS Group
-block_A.raw = Sync.raw[3];
-block_B.raw = Sync.raw[2]; 
-block_C.raw = Sync.raw[1]; 
-block_D.raw = Sync.raw[0]; 
-
-RDS_SEND_BUFFER (block_A, block_B, block_C, block_D, "1A", Monitor); 
-
-    if (Monitor) //Output log
-    {Serial.println("RPC=" + Int2STR(rpc,2) + " ECC=" + Int2HEX(block_C.refined.LowByte,2) + " PINC=" + Int2HEX(pinc,4));    }
-    else 
-    {
-      //Serial.print(".");
-    }
-
-}
-//=====================================================================================================================================
-
-void SI4713::RDS_7A_PAGING (uint16_t rds_pid, byte Bo, byte TP, byte PTY, byte ABflag, byte Type, uint32_t Address, String M_Text, byte Monitor)
-// Input: PI, Bo, TP, PTY, Text A/B flag, Type, Message
-// Monitor: 1-Output full info, 0-Output only "T"
-{
-
-type_7A Message; // create 7A group union for send Radio Text
-Block block_A, block_B, block_C, block_D; // create 2 bytes blocks for send
-
-// fill Radio Text Static fields 
-Message.refined.ABflag = ABflag; //see notes  
-Message.refined.pty = PTY; //set PTY as Jazz channel; Does not matter
-Message.refined.TP = TP;  //set TP; Does not matter
-Message.refined.Bo = Bo; // Must be 0 = Version A 
-Message.refined.type = 7; //Must be 7
-Message.refined.pid = rds_pid; // PI Programm identification
-
-// Calculate groups qty
-int RDSCounter = 0; // groups inside 24 symbols packet
-int psacCounter = 0; //
-bool AddressFlag = 1; // Set Flag to 1 for send addres group
-
-String Text = M_Text; // source text
-
-if (Text.length() == 0) {Text=" ";} //check for zero
-
-switch (Type) { //prepare counters and input string 
-
-     case TONE: //Tone Message
-          Text = "89"; // any data
-          RDSCounter = 1;
-          psacCounter = 0; //Radio Paging Code
-          break;
-
-     case DIG10: //10 digits Numeric Message
-          while ((Text.length() % 10) != 0) //fill up to 10 symbols
-                {
-                  Text = Text + ":"; // 
-                }
-          RDSCounter = 2;
-          psacCounter = 2; //psac offset
-          break;
-
-     case DIG18: //18 digits Numeric Message
-          while ((Text.length() % 18) != 0) //fill up to 18 symbols
-                {
-                  Text = Text + ":"; // 
-                }
-          RDSCounter = 3;
-          psacCounter = 4; //psac offset
-          break;
-
-      case ALPHA: //Alpha Message
-          //Serial.print(Text.length());
-          while (((Text.length()) % 4) != 0) //fill up to 4 symbols block
-                {
-                  Text = Text + " "; //  
-                }
-          //Serial.print(Text.length());       
-          RDSCounter = (Text.length()) / 4;
-          psacCounter = 8; //psac offset
-          break;
-      }
-// End of prepare counters
-
-//---------------------------------------- Start Main Cycle
-for (int i=0; i<RDSCounter; i++)
-{
-type_7A_adress tmp_CD; //union for adress c and d blocks
-String tmp_Adress = Int2STR(Address,6); // 
-
-if (Type != ALPHA) // non alpha messages
-{
-// Create and send address group
-if ((psacCounter == 0) || (psacCounter == 2) || (psacCounter == 4)) // check for address group
-{
-
-// Create address
-tmp_CD.refined.a_1 = int(tmp_Adress.charAt(0));
-tmp_CD.refined.a_2 = int(tmp_Adress.charAt(1));
-tmp_CD.refined.a_3 = int(tmp_Adress.charAt(2));
-tmp_CD.refined.a_4 = int(tmp_Adress.charAt(3));
-tmp_CD.refined.a_5 = int(tmp_Adress.charAt(4));
-tmp_CD.refined.a_6 = int(tmp_Adress.charAt(5));
-
-//Create data 
-tmp_CD.refined.d_1 = int(Text.charAt(0));
-tmp_CD.refined.d_2 = int(Text.charAt(1));
-
-//upload address and data to Message Structure
-Message.refined.address = tmp_CD.raw[1];
-Message.refined.data = tmp_CD.raw[0];
-
-//Define start counter for Paging Segment Address Code 
-Message.refined.psac = psacCounter ; 
-
-// Fill RDS Group
-block_A.raw = Message.raw[3];
-block_B.raw = Message.raw[2]; 
-block_C.raw = Message.raw[1]; 
-block_D.raw = Message.raw[0]; 
-
-RDS_SEND_BUFFER (block_A, block_B, block_C, block_D, "7A", Monitor); 
-if (Monitor) {Serial.println();}
-i++; //next group
-psacCounter++; //next group
-if (Type == TONE) {break;} // interrupt for TONE type message
-} //End of send address group non aplha 
-
-// Prepare and send data groups
-// fill data
-tmp_CD.refined.a_1 = int(Text.charAt((i-1)*8+2));
-tmp_CD.refined.a_2 = int(Text.charAt((i-1)*8+3));
-tmp_CD.refined.a_3 = int(Text.charAt((i-1)*8+4));
-tmp_CD.refined.a_4 = int(Text.charAt((i-1)*8+5));
-tmp_CD.refined.a_5 = int(Text.charAt((i-1)*8+6));
-tmp_CD.refined.a_6 = int(Text.charAt((i-1)*8+7));
-tmp_CD.refined.d_1 = int(Text.charAt((i-1)*8+8));
-tmp_CD.refined.d_2 = int(Text.charAt((i-1)*8+9));
-
-//upload address and data to Message Structure
-Message.refined.address = tmp_CD.raw[1];
-Message.refined.data = tmp_CD.raw[0];
-
-//Define start counter for Paging Segment Address Code 
-Message.refined.psac = psacCounter ; 
-
-// Fill RDS Group
-block_A.raw = Message.raw[3];
-block_B.raw = Message.raw[2]; 
-block_C.raw = Message.raw[1]; 
-block_D.raw = Message.raw[0]; 
-
-RDS_SEND_BUFFER (block_A, block_B, block_C, block_D, "7A", Monitor); 
-if (Monitor) {Serial.println();}
-psacCounter++; //next group
-} //End of NON ALPHA Message
-
-if (Type == ALPHA) // alpha messages ----------------------------------------------------------- ALPHA
-{
-// Create and send address group 
-if (AddressFlag == 1) // check for address group
-{
-AddressFlag = 0; //reset addres group flag
-
-// Create address
-tmp_CD.refined.a_1 = int(tmp_Adress.charAt(0));
-tmp_CD.refined.a_2 = int(tmp_Adress.charAt(1));
-tmp_CD.refined.a_3 = int(tmp_Adress.charAt(2));
-tmp_CD.refined.a_4 = int(tmp_Adress.charAt(3));
-tmp_CD.refined.a_5 = int(tmp_Adress.charAt(4));
-tmp_CD.refined.a_6 = int(tmp_Adress.charAt(5));
-
-//Create data 
-tmp_CD.refined.d_1 = 0x0; //any data
-tmp_CD.refined.d_2 = 0x0; //any data
-
-//upload address and data to Message Structure
-Message.refined.address = tmp_CD.raw[1];
-Message.refined.data = tmp_CD.raw[0];
-
-//Define start counter for Paging Segment Address Code 
-Message.refined.psac = psacCounter ; 
-
-// Fill RDS Group
-block_A.raw = Message.raw[3];
-block_B.raw = Message.raw[2]; 
-block_C.raw = Message.raw[1]; 
-block_D.raw = Message.raw[0]; 
-
-RDS_SEND_BUFFER (block_A, block_B, block_C, block_D, "7A", Monitor); 
-if (Monitor) {Serial.println();}
-psacCounter++; //next group
-} //End of send address group non aplha   
-
-// prepare data
-type_7A_AplusD tmp_D;
-tmp_D.raw = Text.charAt((i)*4);
-tmp_CD.refined.a_1 = tmp_D.refined.data_lo; //symbol 1 in block
-tmp_CD.refined.a_2 = tmp_D.refined.data_hi;
-
-tmp_D.raw = Text.charAt((i)*4+1);
-tmp_CD.refined.a_3 = tmp_D.refined.data_lo; //symbol 2 in block
-tmp_CD.refined.a_4 = tmp_D.refined.data_hi;
-
-tmp_D.raw = Text.charAt((i)*4+2);
-tmp_CD.refined.a_5 = tmp_D.refined.data_lo; //symbol 3 in block
-tmp_CD.refined.a_6 = tmp_D.refined.data_hi;
-
-tmp_D.raw = Text.charAt((i)*4+3);
-tmp_CD.refined.d_1 = tmp_D.refined.data_lo; //symbol 4 in block
-tmp_CD.refined.d_2 = tmp_D.refined.data_hi;
-
-//upload address and data to Message Structure
-Message.refined.address = tmp_CD.raw[1];
-Message.refined.data = tmp_CD.raw[0];
-
-//Counter for Paging Segment Address Code 
-if (i == (RDSCounter - 1)) //last packet
-    {
-       Message.refined.psac = 0xF; // Last packet
-    } 
-else 
-    {
-       Message.refined.psac = psacCounter ; // not last packet
-    }  
-
-// Fill RDS Group
-block_A.raw = Message.raw[3];
-block_B.raw = Message.raw[2]; 
-block_C.raw = Message.raw[1]; 
-block_D.raw = Message.raw[0]; 
-
-RDS_SEND_BUFFER (block_A, block_B, block_C, block_D, "7A", Monitor); 
-if (Monitor) {Serial.println();}
-
-if (psacCounter == 0xE) //last group for 24 symbols group
-   {
-    psacCounter = 9; // reset psac for new 24 symbol group
-   } 
-else
-   {psacCounter++;} //next group
-
-} //End of ALPHA Message
-
-} //End of main cycle 
-
-    if (Monitor) //Output log
-    {
-      Serial.println("Sent 7A: " + Text);
-    }
-
-}
-//======================================= END 7A================================================================
-
-
-void SI4713::RDS_4A_TIME (uint16_t rds_pid, byte Bo, byte TP, byte PTY, uint16_t Year, byte Month, byte Day, byte Hour, byte Minute, byte O_Sign, byte O_Hour, byte O_Minute, byte Monitor) 
-// Input: PI, Bo, TP, PTY, Year, Month, Day, Hour, Minute, Offset sign, Offset hour, Offset minute
-// Monitor: 1-Output full info, 0-Output only "T"
-{
-long Current_MJD = ymd_to_mjd (Year, Month, Day); // Date as Modified Julian Date 60586=03/10/2024
-
-//Start Calculate offset
-int Offset = 0;
-if (O_Hour <= 15)
-{
-  Offset = O_Hour * 2; 
-}
-if (O_Minute == 30)
-{
-  Offset = Offset + 1; 
-}
-//End Calculate offset
-
-type_4A DateTime; // create 4A group union for send Date and Time
-Block block_A, block_B, block_C, block_D; // create 2 bytes block for send
-
-// fill DateTime Union 
-DateTime.refined.offset = Offset; //0x1C=14:00; //
-DateTime.refined.offset_sense = O_Sign; // Set offset sign bit
-DateTime.refined.hour = Hour; // Set Time: hour
-DateTime.refined.minute = Minute; // Set Time: minutes
-DateTime.refined.mjd = Current_MJD; // Set Date
-DateTime.refined.spr = 0; //Always 0; Does not matter, spare bits
-DateTime.refined.pty = PTY; //set PTY as Scientist channel; Does not matter
-DateTime.refined.TP = TP;  //set TP; Does not matter
-DateTime.refined.Bo = Bo; // Must be 0 = Version A 
-DateTime.refined.type = 4; //Must be 4
-DateTime.refined.pid = rds_pid; // PI Programm identification
-
-// Fill RDS Group
-block_A.raw = DateTime.raw[3];
-block_B.raw = DateTime.raw[2]; 
-block_C.raw = DateTime.raw[1]; 
-block_D.raw = DateTime.raw[0]; 
-
-RDS_SEND_BUFFER (block_A, block_B, block_C, block_D, "4A", Monitor); 
-    
-    if (Monitor) //Output log
-    {
-      
-      char Output [17]; //tmp string for Date Time Offset
-      char O_sign_s[2] = {'+', NULL}; //1='-', 0='+'
-      
-      if (O_Sign == 1) //Check Offset Sign
-      {
-      O_sign_s[0] = '-'; //Set offset sign 
-      }
-
-      sprintf(Output, "%02d-%02d-%4d %02d:%02d %1s%02d:%02d", Day, Month, Year, Hour, Minute, O_sign_s, O_Hour, O_Minute);
-      Serial.println(Output);
-    
-    }
-}
-//=======================================================================================================
-
-// -----------------------------------  New functıon for senf 2A Group
-void SI4713::RDS_2A_RT (uint16_t rds_pid, byte Bo, byte TP, byte PTY, byte ABflag, String RT, byte Monitor)
-// Input: PI, Bo, TP, PTY, Text A/B flag, Radio Text
-// Monitor: 1-Output full info, 0-Output only "T"
-{
-type_2A RadioText; // create 2A group union for send Radio Text
-Block block_A, block_B, block_C, block_D; // create 2 bytes blocks for send
-
-String Text = RT; // source text
-
-while ((Text.length() % 4) != 0) //fill up to blocks with 4 symbols
-    {
-      Text = Text + " ";
-    }
-
-// fill Radio Text Static fields 
-RadioText.refined.ABflag = 0; //Always 0; see comments in typedef type_2A_group  
-RadioText.refined.pty = PTY; //set PTY as Jazz channel; Does not matter
-RadioText.refined.TP = TP;  //set TP; Does not matter
-RadioText.refined.Bo = Bo; // Must be 0 = Version A 
-RadioText.refined.type = 2; //Must be 2
-RadioText.refined.pid = rds_pid; // PI Programm identification
-
-int RDSCounter = Text.length()/4; //Total packets for 2A groups 
-
-for (int i=0; i<RDSCounter; i++)
-{
-
-RadioText.refined.counter = i; //Counter
-
-Block tmp; //for Block C and D data filling
-char Symbol = Text[i*4];
-
-tmp.refined.HighByte = Symbol; // WORK !!!
-Symbol = Text[i*4+1];
-tmp.refined.LowByte = Symbol; 
-RadioText.refined.text1 = tmp.raw; // 1 and 2 char 
-
-Symbol = Text[i*4+2];
-tmp.refined.HighByte = Symbol; // WORK !!!
-Symbol = Text[i*4+3];
-tmp.refined.LowByte = Symbol; 
-RadioText.refined.text2 = tmp.raw; // 3 and 4 char 
-
-// Fill RDS Group
-block_A.raw = RadioText.raw[3];
-block_B.raw = RadioText.raw[2]; 
-block_C.raw = RadioText.raw[1]; 
-block_D.raw = RadioText.raw[0]; 
-
-RDS_SEND_BUFFER (block_A, block_B, block_C, block_D, "2A", Monitor); 
-
-if (Monitor) //Output log
-    {
-      Serial.println(Text.substring(i*4,i*4+4));
-    }
-}
-// End of cycle
-
-    if (Monitor) //Output log
-    {
-      Serial.println("Sent 2A: " + Text);
-    }
-}
-//=====================================================================================================================================
-
-// --------------------------       Send RDS packet --------------------------------------------
-void SI4713::RDS_SEND_BUFFER (Block A, Block B, Block C, Block D, String Group, byte Monitor) 
-{
-// Fill chip buffer for send RDS group
-buf[0] = 0x35; //Create buffer TX_RDS_BUFF
-buf[1] = 0x84; //Set FIFO and LDBUFF 0x84
-buf[2] = B.refined.HighByte; //;
-buf[3] = B.refined.LowByte; //;
-buf[4] = C.refined.HighByte; //;
-buf[5] = C.refined.LowByte; //;
-buf[6] = D.refined.HighByte; //
-buf[7] = D.refined.LowByte;  //
-
-WriteBuffer(8);
-
-    if (Monitor) //Output log
-    {
-      Serial.print("Tx " + Group + ": " + Int2HEX (A.raw, 4) + " " + Int2HEX (B.raw, 4) + " " + Int2HEX (C.raw, 4) + " " + Int2HEX (D.raw, 4) +" : ");
-    }
-}
-//=======================================================================================================
\ No newline at end of file
+/*  Full option SI4713 library with advanced RDS and MPX settings
+ *   
+ *  v1.0 - Sjef Verhoeven PE5PVB
+ *  *  Website: https://www.pe5pvb.nl/
+ *  Github:  https://github.com/PE5PVB
+ * 
+ *  v2.0 - Added functions for 1A, 4A, 7A Groups   
+ *  
+ *  Each SI4713 object has own I2C address, bus (TwoWire), command buffer and shadow, so several chips
+ *  can work together (scheduler.h).
+*/
+
+#include <Wire.h>
+#include "tools.h" // some tools for project
+
+// -------------------------------------------------------- TYPE DEFINITIONS
+/**
+ * Type Block Converts 16 bits word to two bytes
+ */
+typedef union
+{
+    struct
+    {
+      uint8_t LowByte;
+      uint8_t HighByte;
+    } refined;
+    uint16_t raw;
+} Block;
+
+
+/**
+ * Group 4A ( RDS Date and Time)
+ *
+ * Fields are split on 16 bits words: bitfield can't cross boundary of uint16_t, so the layout
+ * is the same on 8 bits (AVR) and 32/64 bits platforms (host build).
+ */
+typedef union
+{
+    struct
+    {
+        uint16_t offset : 5;       // Local Time Offset from 0 to 15:30
+        uint16_t offset_sense : 1; // Local Offset Sign ( 0 = + , 1 = - )
+        uint16_t minute : 6;       // UTC Minutes
+        uint16_t hour_lo : 4;      // UTC Hours - 4 bits less significant (block D)
+        uint16_t hour_hi : 1;      // UTC Hours - 1 bit most significant (block C)
+        uint16_t mjd_lo : 15;      // Modified Julian Day - 15 bits less significant (block C)
+        uint16_t mjd_hi : 2;       // Modified Julian Day - 2 bits most significant (block B)
+        uint16_t spr : 3;          // Spare bits
+        uint16_t pty : 5;          // PTY, program type, 01000(8d) = Science
+        uint16_t TP : 1;           // Traffic Programm bit, 0=Non TP, 1=TP
+        uint16_t Bo : 1;           // RDS Version, 0=A, 1=B
+        uint16_t type : 4;         // Group type 4=Date and Time
+        uint16_t pid : 16;         // Programm Identification
+     } refined;
+  
+    uint16_t raw[4]; // 4 16 bit words for blocks A,B,C,D 
+    
+} type_4A;
+
+/**
+ * Group 2A ( RDS Radio Text)
+ *
+ * To make it compatible with 8, 16 and 32 bits platforms and avoid Crosses boundary, it was necessary to
+ * use uint32_t data type.
+ */
+typedef union
+{
+    struct
+    {
+        uint32_t text2 : 16;       // 3 and 4 symbols 
+        uint32_t text1 : 16;       // 1 and 2 symbols  
+        uint32_t counter : 4;      // Message blocks counter,  
+        uint32_t ABflag : 1;       // Text A/B flag. Receiver clears radio text when it changes (radiotext.h)
+        uint32_t pty : 5;          // PTY, program type, 01000(8d) = Science
+        uint32_t TP : 1;           // Traffic Programm bit, 0=Non TP, 1=TP
+        uint32_t Bo : 1;           // RDS Version, 0=A, 1=B
+        uint32_t type : 4;         // Group type 4=Date and Time
+        uint32_t pid : 16;         // Programm Identification
+     } refined;
+  
+    uint16_t raw[4]; // 4 16 bit words for blocks A,B,C,D 
+    
+} type_2A;
+//--------------------------------------------------
+
+/**
+ * Group 1A ( RDS Programm Item Number and slow labeling Codes)
+ * 
+ * Use for pafing synchronization, must be send each second 
+ *
+ * To make it compatible with 8, 16 and 32 bits platforms and avoid Crosses boundary, it was necessary to
+ * use uint32_t data type.
+ */
+typedef union
+{
+    struct
+    {
+        uint32_t pinc : 16;        // Programme Item Number Code (see 3.2.1.7) 
+        uint32_t slc : 16;         // Slow Labeling Code (see 3.1.5.2) 
+        uint32_t rpc : 5;          // Radio Paging Codes (see Annex M)
+        uint32_t pty : 5;          // PTY, program type, 01000(8d) = Science
+        uint32_t TP : 1;           // Traffic Programm bit, 0=Non TP, 1=TP
+        uint32_t Bo : 1;           // RDS Version, 0=A, 1=B
+        uint32_t type : 4;         // Group type 4=Date and Time
+        uint32_t pid : 16;         // Programm Identification
+     } refined;
+  
+    uint16_t raw[4]; // 4 16 bit words for blocks A,B,C,D 
+    
+} type_1A;
+
+/**
+ * Group 7A ( RDS Paging)
+ *
+ * To make it compatible with 8, 16 and 32 bits platforms and avoid Crosses boundary, it was necessary to
+ * use uint32_t data type.
+ */
+typedef union
+{
+    struct
+    {
+        uint32_t data : 16;        // address or data 
+        uint32_t address: 16;      // address or data  
+        uint32_t psac : 4;         // Paging Segment Address Code (have 4 variants for Tone/10/18/Alpha  
+        uint32_t ABflag : 1;       // Text A/B flag. For new message A/B flag must be changed from 0 to 1, or from 0 to 1
+        
+        uint32_t pty : 5;          // PTY, program type, 01000(8d) = Science
+        uint32_t TP : 1;           // Traffic Programm bit, 0=Non TP, 1=TP
+        uint32_t Bo : 1;           // RDS Version, 0=A, 1=B
+        uint32_t type : 4;         // Group type 7A paging
+        uint32_t pid : 16;         // Programm Identification
+     } refined;
+  
+    uint16_t raw[4]; // 4 16 bit words for blocks A,B,C,D 
+    
+} type_7A;
+//--------------------------------------------------
+
+/**
+ * Group 7A ( RDS Paging) Adress Block C,D
+ *
+ * To make it compatible with 8, 16 and 32 bits platforms and avoid Crosses boundary, it was necessary to
+ * use uint32_t data type.
+ */
+typedef union
+{
+    struct
+    {
+        uint32_t d_2 : 4;        // 2 symbol 
+        uint32_t d_1 : 4;        // 1 symbol 
+        uint32_t a_6 : 4;         // 6 digit  
+        uint32_t a_5 : 4;         // 5 digit  
+        uint32_t a_4 : 4;         // 4 digit  
+        uint32_t a_3 : 4;         // 3 digit  
+        uint32_t a_2 : 4;         // 2 digit  
+        uint32_t a_1 : 4;         // 1 digit  
+     } refined;
+  
+    uint16_t raw[2]; // 2 16 bit words for blocks C,D 
+    
+} type_7A_adress;
+
+/**
+ * Group 7A ( RDS Paging) Adress Block D FOR ALPHA
+ * 
+ */
+typedef union
+{
+    struct
+    {
+        uint8_t data_hi : 4;        // High Bits 
+        uint8_t data_lo : 4;        // Low Bits 
+     } refined;
+  
+    uint8_t raw; // 2 16 bit words for blocks C,D 
+    
+} type_7A_AplusD;
+
+/**
+ * Group 7A ( RDS Paging) Last byte in D Block of address group for alpha and variable-length messages (page 114)
+ * MessageType selects how next groups are read: 4 symbols (alpha) or 8 digits (variable-length numeric/function)
+ */
+typedef union
+{
+    struct
+    {
+        uint8_t CallCounter        : 4;    // Use for check missing messages 
+        uint8_t RepeatFlag         : 1;    // Repeated Message
+        uint8_t InternationalFlag  : 1;    // 0=National; 1=International
+        uint8_t MessageType        : 2;    // 00=Alpha; 01=Variable Length Numeric Message; 10=Reserved ; 11=Variable-length function message
+    } refined;
+  
+    uint8_t raw; //  
+    
+} type_7A_X1X2;
+
+//-----------------------------------------------------------------------------------------------
+// PI (programm_identification) union 
+// 0x62E7 6=Country Ukraine; 2=National Network; E7=Programm Reference Number (Jazz FM)
+// Country code (CC) is important !!! See in RDS Protocol Annex D and description of EEPROM DUMP
+// Also you can try CC from 1 to F, or use Internetional Mode if pager supports this Mode
+typedef union
+{
+    struct
+    {
+        uint8_t pi_prn     : 8; // Programm Reference Number (does NOT affect for paging)
+        uint8_t pi_area    : 4; // Programm Area Coverage (does NOT affect for paging)
+        uint8_t pi_country : 4; // Country Code ! IMPORTANT ! 
+     } refined;
+    uint16_t All; // PI Structure, RDS block A
+} type_pi;
+//============================================================================================
+
+// UTC Offset union ---------------------------------------------------------------------------
+typedef union
+{
+    struct
+    {
+        uint8_t offset_minute : 1; // 0-00, 1-30
+        uint8_t offset_hour   : 4; // 0-00, FF-15
+        uint8_t offset_sign   : 1; // 0-"+", 1-"-"
+     } refined;
+    uint8_t All; // Offset for 4A group 
+} type_Offset;
+//================================
+
+#include "config.h" //Settings
+#include "protocol.h" //serial control port: binary frames and text menu
+#include "trace.h" //monitor records
+#include "stats.h" //counters
+//=========================================== END TYPE DEFINITIONS =======================================
+
+// Command engine errors (SI4713::LastError)
+#define TX_OK          0 // No errors
+#define TX_ERR_TIMEOUT 1 // No CTS during TX_CMD_TIMEOUT
+#define TX_ERR_CMD     2 // Chip set ERR bit in status
+#define TX_ERR_BUS     3 // I2C error (NACK or no data)
+#define TX_ERR_QUEUE   4 // Command queue is full during TX_CMD_TIMEOUT, or command is longer than a queue entry
+#define TX_ERR_FIFO    5 // RDS FIFO stays full during TX_CMD_TIMEOUT, group is not loaded
+
+// RDS FIFO state from TX_RDS_BUFF response
+typedef struct
+{
+  uint8_t Used = 0;          // Groups in chip FIFO (FIFOUSED)
+  uint8_t Avail = RDS_FIFO_SIZE; // Free places in chip FIFO (FIFOAVAIL)
+  uint8_t Queued = 0;        // Groups in command queue, not loaded to chip yet
+  uint8_t Cleared = 0;       // Queued groups before MTBUFF, they are emptied with FIFO
+  uint8_t Clearing = 0;      // MTBUFF in command queue: answers before it show old FIFO
+  uint16_t Overflows = 0;    // Groups rejected because FIFO was full
+  uint16_t Underflows = 0;   // FIFO ran empty (FIFOMT)
+  unsigned long Updated = 0; // Time of last response, millis()
+  uint8_t Watch = 0;         // 4A group: LDBUFF answers up to its own, 0 = none queued
+  uint8_t Behind = 0;        // Groups loaded after 4A while it is in FIFO
+  bool In_FIFO = false;      // 4A is in FIFO, answers show when it goes to air
+  bool Left_Ready = false;   // Left is new (TimeService::Run takes it)
+  unsigned long Seen = 0;    // millis() of last answer with 4A in FIFO
+  unsigned long Left = 0;    // millis() when 4A went to air: middle between last answer with it and first without it
+} type_RDS_FIFO;
+
+#define RDS_GROUP_TIME_US 87579UL // Air time of one group: 104 bits at 1187.5 bit/s
+
+// Encoded 7A message: blocks C and D of each group, blocks A and B are added when a group is sent (RDS_7A_GROUP)
+#define PAGE_MAX_GROUPS 21 // Alpha message 80 symbols = address group + 20 groups with 4 symbols
+
+typedef struct
+{
+  uint8_t Type;       // TONE/DIG10/DIG18/ALPHA/VARNUM/FUNC, numeric as sent (RDS_7A_FORMAT)
+  uint8_t Groups = 0; // Groups in message, 0 = empty
+  uint16_t Data[PAGE_MAX_GROUPS][2]; // Blocks C, D for each group
+} type_7A_Page;
+
+// Queued chip command
+typedef struct
+{
+  uint8_t len;      // Command length
+  uint8_t data[8];  // Command and arguments, max TX_RDS_BUFF = 8 bytes
+} type_Command;
+
+// Property and value for SI4713::Set_Properties
+typedef struct
+{
+  uint16_t Property; // SET_PROPERTY number
+  uint16_t Value;
+} type_Property;
+
+// Properties known to the driver with values after reset/POWER_UP (AN332), first values of shadow for fresh chip
+const type_Property TX_Defaults[] PROGMEM =
+{
+  {0x0001, 0x0000}, // GPO_IEN
+  {0x0201, 0x8000}, // REFCLK_FREQ 32768 Hz
+  {0x2100, 0x0003}, // TX_COMPONENT_ENABLE: pilot and L-R, RDS off
+  {0x2101, 0x1AA9}, // TX_AUDIO_DEVIATION 68.25 kHz
+  {0x2102, 0x02A3}, // TX_PILOT_DEVIATION 6.75 kHz
+  {0x2103, 0x00C8}, // TX_RDS_DEVIATION 2.00 kHz
+  {0x2104, 0x327C}, // TX_LINE_INPUT_LEVEL
+  {0x2105, 0x0000}, // TX_LINE_INPUT_MUTE
+  {0x2106, 0x0000}, // TX_PREEMPHASIS 75 us
+  {0x2107, 0x4A38}, // TX_PILOT_FREQUENCY 19000 Hz
+  {0x2200, 0x0002}, // TX_ACOMP_ENABLE: limiter on, AGC off
+  {0x2201, 0xFFD8}, // TX_ACOMP_THRESHOLD -40 dBFS
+  {0x2202, 0x0000}, // TX_ACOMP_ATTACK_TIME 0.5 ms
+  {0x2203, 0x0004}, // TX_ACOMP_RELEASE_TIME 1 s
+  {0x2204, 0x000F}, // TX_ACOMP_GAIN 15 dB
+  {0x2205, 0x0066}, // TX_LIMITER_RELEASE_TIME 5.01 ms
+  {0x2300, 0x0000}, // TX_ASQ_INTERRUPT_SOURCE
+  {0x2C00, 0x0000}, // TX_RDS_INTERRUPT_SOURCE
+  {0x2C01, 0x40A7}, // TX_RDS_PI
+  {0x2C02, 0x0003}, // TX_RDS_PS_MIX
+  {0x2C03, 0x1008}, // TX_RDS_PS_MISC
+  {0x2C04, 0x0003}, // TX_RDS_PS_REPEAT_COUNT
+  {0x2C05, 0x0001}, // TX_RDS_PS_MESSAGE_COUNT
+  {0x2C06, 0xE0E0}, // TX_RDS_PS_AF: no AF
+  {0x2C07, 0x0000}, // TX_RDS_FIFO_SIZE: FIFO off
+};
+#define TX_PROPERTIES (sizeof(TX_Defaults) / sizeof(TX_Defaults[0])) // max 32: bits of SI4713::Known
+
+class SI4713
+{
+  public:
+    void Init(uint8_t RST, uint16_t clk, uint8_t address, TwoWire &Bus = Wire, int8_t INT_Pin = INT_TX_PIN); // Chip on Bus at address, INT_Pin = GPO2/INT for CTS (-1 = poll CTS)
+    uint8_t Set_Properties(const type_Property *Table, uint8_t Count); // Queue properties back to back, skip values the chip has; return number of sent properties
+    void Resync();                 // Send again all values of shadow (chip was reset or its state is not sure)
+    unsigned long First_Group = 0; // millis() from boot when first RDS group was loaded to FIFO, 0 = not yet
+    void Output(uint8_t level, uint8_t cap);
+    void Freq(uint16_t freq);
+    void RDS_PI(uint16_t RDSPI);
+    void RDS_PTY(uint8_t RDSPTY);
+    void RDS_COMP(bool ONOFF);
+    void RDS_ART(bool ONOFF);
+    void RDS_MS(bool ONOFF);
+    void RDS_TP(bool ONOFF);
+    void RDS_TA(bool ONOFF);
+    void RDS_AF(uint16_t AF);
+    void RDS_PS(const char *PS, uint8_t number);
+    void RDS_RT(const char *RT);
+    void RDS_PS_MIX(uint16_t PS_MIX); // Sets the ratio of RDS PS (group 0A) and circular buffer/FIFO groups.
+
+    void RDS_MUSP(bool ONOFF);
+    void RDS_PSCOUNT(uint8_t count, uint8_t speed);
+    void RDS_Enable(bool ONOFF);
+    void MPX_Enable(bool ONOFF);
+    void Audio_Mute(bool ONOFF);
+    void MPX_Deviation(uint16_t dev);
+    void RDS_Deviation(uint16_t dev);
+    void Audio_PreEmphasis(uint16_t emp);
+    void MPX_Freq(uint16_t freq);
+    void Audio_Limiter(bool ONOFF);
+    void Audio_AGC(bool ONOFF);
+    void Audio_Comp_Threshold(int16_t threshold);
+    void Audio_Comp_Attack(uint16_t attack);
+    void Audio_Comp_Release(uint16_t rel);
+    void Audio_Comp_Gain(uint16_t gain);
+    void Audio_Limiter_Release(uint16_t rel);
+    void Audio_Deviation(uint16_t dev);
+    bool ASQ(bool &overmod, int8_t &inlevel); // Overmodulation and input level, false = no answer (outputs are 0)
+    bool Rev(uint8_t &pn, uint8_t &chiprev);  // Part number and chip revision, false = no answer (outputs are 0)
+    void GPO(bool GPO1, bool GPO2, bool GPO3);
+
+    // PLAB Updates
+    void RDS_SEND_BUFFER (Block A, Block B, Block C, Block D, byte Monitor); //send RDS buffer 
+    void RDS_FIFO_STATUS (); // Request FIFO state, answer will be in Fifo
+    uint8_t RDS_FIFO_USED (); // Groups in chip FIFO now (last answer minus aired groups plus queued)
+    void RDS_FIFO_CLEAR (); // Empty FIFO (MTBUFF), groups not on air yet are dropped
+    type_RDS_FIFO Fifo; // Last known FIFO state
+    void RDS_4A_TIME (uint16_t rds_pi, byte Bo, byte TP, byte PTY, uint16_t Year, byte Month, byte Day, byte Hour, byte Minute, byte O_Sign, byte O_Hour, byte O_Minute, byte Monitor); // Send 4A/4B group: Date and Time
+    void RDS_2A_RT   (uint16_t rds_pi, byte Bo, byte TP, byte PTY, byte ABflag, const char *RT, byte Monitor); //Send RadioText (old RDS_RT)
+    void RDS_1A_PIN (uint16_t rds_pi, byte Bo, byte TP, byte PTY, byte rpc, uint16_t slc, uint16_t pinc, byte Monitor);  //Send 1A group PIN ans SLC
+    void RDS_4A_BUILD (uint16_t *Group, uint16_t rds_pi, byte Bo, byte TP, byte PTY, uint16_t Year, byte Month, byte Day, byte Hour, byte Minute, byte O_Sign, byte O_Hour, byte O_Minute); // Encode 4A group without sending
+    uint8_t RDS_2A_BUILD (uint16_t *Group, uint16_t rds_pi, byte Bo, byte TP, byte PTY, byte ABflag, const char *RT, uint8_t Segment); // Encode one 2A segment without sending, return segments in text
+    void RDS_1A_BUILD (uint16_t *Group, uint16_t rds_pi, byte Bo, byte TP, byte PTY, byte rpc, uint16_t slc, uint16_t pinc); // Encode 1A group without sending
+    bool RDS_SEND_GROUP (const uint16_t *Group, byte Monitor, uint8_t ID = 0, uint8_t Flags = 0); // Send encoded group {A,B,C,D}; ID and Flags go to monitor trace, false = not loaded
+    void RDS_7A_PAGING (uint16_t rds_pid, byte Bo, byte TP, byte PTY, byte ABflag, byte Type, uint32_t Address, const char *M_Text, byte Monitor); //Send Message
+    static void RDS_7A_COMPILE (type_7A_Page &Page, byte Type, uint32_t Address, const char *M_Text); //Encode Message once: blocks C and D of all groups
+    static void RDS_7A_GROUP (uint16_t *Group, const type_7A_Page &Page, uint8_t i, uint16_t rds_pid, byte Bo, byte TP, byte PTY, byte ABflag); //Group i {A,B,C,D} of encoded Message
+    static uint8_t RDS_7A_GROUPS (byte Type, uint8_t Len); //Groups in Message
+    static byte RDS_7A_FORMAT (byte Type, uint8_t Len); //Numeric format with fewest groups for Len digits (other types are not changed)
+    static void RDS_7A_X1X2 (uint16_t *Group, byte Type, uint8_t Call, bool Repeat); //Call counter and repeat flag in address group of encoded Message
+    // End PLAB 
+
+    // Command engine
+    bool Poll();                  // Service command queue, call it from loop() as often as possible; true = chip is busy
+    bool Flush();                 // Wait until all queued commands are done; false = some command failed
+    uint8_t Pending();            // Commands in queue (including command in progress)
+    uint8_t LastError = TX_OK;    // Last command error (TX_ERR_xxx)
+    uint16_t Errors = 0;          // Failed commands since start
+    SI4713 *Simulcast = 0;        // Next chip which gets the same FIFO groups and PI (scheduler.h)
+    uint8_t Trace_Flags = 0;      // Added to flags of monitor records: TRACE_TX2 for second transmitter
+
+  private:
+    bool WriteBuffer(uint8_t len);  // Put command from buf into queue, don't wait for the chip
+    bool WriteCommand(uint8_t len); // Send command from buf and wait for CTS (use when response is needed)
+    bool ReadBuffer(uint8_t len);
+    bool Set_Property(uint16_t arg1, uint16_t arg2);
+    bool CheckCTS();                // Check CTS of command in progress
+    void RDS_FIFO_UPDATE();         // Parse TX_RDS_BUFF response from resp
+    bool RDS_LOAD_BUFFER(const uint16_t *Group); // Load group {A,B,C,D} to FIFO, wait when FIFO is full (max TX_CMD_TIMEOUT), false = not loaded
+    void RDS_BUFF_DONE(uint8_t Flags); // TX_RDS_BUFF with Flags is done or failed: queued groups and MTBUFF
+    static uint8_t NumericDigit(const char *Text, uint8_t Len, uint8_t Pos);
+    static uint8_t FunctionDigit(const char *Text, uint8_t Len, uint8_t Pos);
+    static uint8_t AlphaSymbol(const char *Text, uint8_t Len, uint8_t Pos);
+    void StartCommand();            // Send first command from queue to the chip
+
+    type_Command CmdQueue[TX_CMD_QUEUE]; // Commands waiting for the chip, CmdQueue[CmdHead] is in progress when CmdBusy
+    uint8_t CmdHead = 0;
+    uint8_t CmdCount = 0;
+    bool CmdBusy = false;
+    unsigned long CmdStart = 0;     // Time when command in progress was sent
+    unsigned long CmdStart_us = 0;  // The same in us, for Stats
+    void Failed(uint8_t Error);     // Count command error, forget shadow after bus, CTS or chip errors: chip state is not sure
+    int8_t Property_Index(uint16_t Property); // Place of property in TX_Defaults[] and Shadow[], -1 = not shadowed
+    void PS_Write(uint8_t PSID, uint32_t Text); // Send 4 symbols of PS to TX_RDS_PS register PSID
+
+    // Shadow of the chip: last written values, only changed values go to the bus
+    uint16_t Shadow[TX_PROPERTIES];  // Property values in TX_Defaults[] order
+    uint32_t Known = 0;              // Bit for each valid Shadow[]
+    uint32_t PS_Shadow[TX_PS_SHADOW * 2]; // TX_RDS_PS registers (4 symbols each) of first PS slots
+    uint8_t PS_Known = 0;            // Bit for each valid PS_Shadow[]
+    uint16_t Freq_Shadow = 0;        // TX_TUNE_FREQ, 0 = unknown
+    uint16_t Output_Shadow = 0xFFFF; // TX_TUNE_POWER level and capacitor, 0xFFFF = unknown
+
+    // Transport and command buffer of this chip
+    TwoWire *Bus = &Wire;
+    uint8_t addr = 0x63;             // I2C address: 0x63 (SEN high) or 0x11 (SEN low)
+    int8_t INT_Pin = -1;             // GPO2/INT pin, -1 = CTS is polled over I2C
+    uint8_t buf[10];                 // Command being built
+    uint8_t resp[16];                // Last answer
+    uint16_t component;              // TX_COMPONENT_ENABLE bits
+    uint16_t acomp;                  // TX_ACOMP_ENABLE bits
+    uint16_t misc;                   // TX_RDS_PS_MISC bits
+};
+// =============================================== End Class ======================================
+
+bool SI4713::ReadBuffer(uint8_t len)
+{
+  if (Bus->requestFrom(addr, len) != len) {return false;}
+  for (uint8_t i = 0; i < len; i++) {
+    resp[i] = Bus->read();
+  }
+  return true;
+}
+
+bool SI4713::WriteBuffer(uint8_t len)
+{
+  if (len > sizeof(CmdQueue[0].data)) // longer than a queue entry, buf is bigger
+  {
+    Failed(TX_ERR_QUEUE);
+    return false;
+  }
+  unsigned long Start = millis();
+  while (CmdCount >= TX_CMD_QUEUE) // queue is full, wait for free place
+  {
+    Poll();
+    if ((millis() - Start) > TX_CMD_TIMEOUT)
+    {
+      Failed(TX_ERR_QUEUE);
+      return false;
+    }
+  }
+  type_Command &Cmd = CmdQueue[(CmdHead + CmdCount) % TX_CMD_QUEUE];
+  Cmd.len = len;
+  memcpy(Cmd.data, buf, len);
+  CmdCount++;
+  Poll(); // start now if chip is free
+  return true;
+}
+
+bool SI4713::WriteCommand(uint8_t len)
+{
+  uint16_t Before = Errors;
+  if (!WriteBuffer(len)) {return false;}
+  Flush();
+  return Errors == Before;
+}
+
+bool SI4713::Poll()
+{
+  if (CmdBusy)
+  {
+    if (!CheckCTS()) {return true;} // command in progress
+    CmdBusy = false;
+    CmdHead = (CmdHead + 1) % TX_CMD_QUEUE; // command done
+    CmdCount--;
+  }
+  if (CmdCount > 0) {StartCommand();}
+  return CmdCount > 0;
+}
+
+bool SI4713::Flush()
+{
+  uint16_t Before = Errors;
+  while (Poll()) {} // every command has own timeout
+  return Errors == Before;
+}
+
+uint8_t SI4713::Pending()
+{
+  return CmdCount;
+}
+
+void SI4713::StartCommand()
+{
+  type_Command &Cmd = CmdQueue[CmdHead];
+  Bus->beginTransmission(addr);
+  Bus->write(Cmd.data, Cmd.len);
+  if (Bus->endTransmission() != 0) // NACK, drop command
+  {
+    Failed(TX_ERR_BUS);
+    if (Cmd.data[0] == 0x35) {RDS_BUFF_DONE(Cmd.data[1]);}
+    CmdHead = (CmdHead + 1) % TX_CMD_QUEUE;
+    CmdCount--;
+    return;
+  }
+  CmdStart = millis();
+  CmdStart_us = micros();
+  CmdBusy = true;
+}
+
+bool SI4713::CheckCTS()
+{
+  if ((INT_Pin >= 0) && (digitalRead(INT_Pin) == HIGH) && ((millis() - CmdStart) <= TX_CMD_TIMEOUT)) {return false;} // INT not active, don't load I2C bus
+  bool RdsBuff = (CmdQueue[CmdHead].data[0] == 0x35); // TX_RDS_BUFF answers with FIFO state
+  if (!ReadBuffer(RdsBuff ? 6 : 1)) // no answer, drop command
+  {
+    Failed(TX_ERR_BUS);
+    if (RdsBuff) {RDS_BUFF_DONE(CmdQueue[CmdHead].data[1]);}
+    return true;
+  }
+  if (bitRead(resp[0], 7) == 1) // CTS, command done
+  {
+    Stats.I2C_Commands++;
+    EncoderStats::Add(Stats.I2C_Time, micros() - CmdStart_us);
+    if (bitRead(resp[0], 6) == 1) // ERR
+    {
+      Failed(TX_ERR_CMD);
+    }
+    if (RdsBuff) {RDS_FIFO_UPDATE();}
+    if (RdsBuff && (First_Group == 0) && bitRead(CmdQueue[CmdHead].data[1], 2)) {First_Group = millis();} // boot time
+    return true;
+  }
+  if ((millis() - CmdStart) > TX_CMD_TIMEOUT) // chip doesn't answer, drop command
+  {
+    Failed(TX_ERR_TIMEOUT);
+    if (RdsBuff) {RDS_BUFF_DONE(CmdQueue[CmdHead].data[1]);}
+    return true;
+  }
+  Stats.CTS_Spins++;
+  return false;
+}
+
+void SI4713::Failed(uint8_t Error)
+{
+  LastError = Error;
+  Errors++;
+  if ((Error != TX_ERR_BUS) && (Error != TX_ERR_TIMEOUT) && (Error != TX_ERR_CMD)) {return;} // nothing went to the chip, shadow stays true
+  Known = 0; // NACK, no CTS or ERR: chip state is not sure
+  PS_Known = 0;
+  Freq_Shadow = 0;
+  Output_Shadow = 0xFFFF;
+}
+
+bool SI4713::Set_Property(uint16_t arg1, uint16_t arg2)
+{
+  int8_t d = Property_Index(arg1);
+  if ((d >= 0) && bitRead(Known, d) && (Shadow[d] == arg2)) {return true;} // chip has this value
+  buf[0] = 0x12;
+  buf[1] = 0x00;
+  buf[2] = highByte(arg1);
+  buf[3] = lowByte(arg1);
+  buf[4] = highByte(arg2);
+  buf[5] = lowByte(arg2);
+  if (!WriteBuffer(6)) {return false;}
+  if (d >= 0)
+  {
+    Shadow[d] = arg2;
+    bitSet(Known, d);
+  }
+  return true;
+}
+
+void SI4713::Output(uint8_t level, uint8_t cap)
+{
+  if (Output_Shadow == word(level, cap)) {return;}
+  buf[0] = 0x31;
+  buf[1] = 0x00;
+  buf[2] = 0x00;
+  buf[3] = level;
+  buf[4] = cap;
+  if (WriteBuffer(5)) {Output_Shadow = word(level, cap);}
+}
+
+void SI4713::Freq(uint16_t freq)
+{
+  if (Freq_Shadow == freq) {return;}
+  buf[0] = 0x30;
+  buf[1] = 0x00;
+  buf[2] = highByte(freq);
+  buf[3] = lowByte(freq);
+  if (WriteBuffer(4)) {Freq_Shadow = freq;}
+}
+
+void SI4713::RDS_PI(uint16_t RDSPI)
+{
+  Set_Property(0x2c01, RDSPI);
+  if (Simulcast) {Simulcast->RDS_PI(RDSPI);} // block A is the same on all chips
+}
+
+void SI4713::RDS_PSCOUNT(uint8_t count, uint8_t speed)
+{
+  Set_Property(0x2c05, count);
+  Set_Property(0x2c04, speed);
+}
+
+void SI4713::RDS_PTY(uint8_t RDSPTY)
+{
+  bitWrite(misc, 5, bitRead(RDSPTY, 0));
+  bitWrite(misc, 6, bitRead(RDSPTY, 1));
+  bitWrite(misc, 7, bitRead(RDSPTY, 2));
+  bitWrite(misc, 8, bitRead(RDSPTY, 3));
+  bitWrite(misc, 9, bitRead(RDSPTY, 4));
+  Set_Property(0x2c03, misc);
+}
+
+void SI4713::RDS_COMP(bool ONOFF)
+{
+  if (ONOFF == true) {
+    bitWrite(misc, 14, 1);
+  } else {
+    bitWrite(misc, 14, 0);
+  }
+  Set_Property(0x2c03, misc);
+}
+
+void SI4713::RDS_ART(bool ONOFF)
+{
+  if (ONOFF == true) {
+    bitWrite(misc, 13, 1);
+  } else {
+    bitWrite(misc, 13, 0);
+  }
+  Set_Property(0x2c03, misc);
+}
+
+void SI4713::RDS_MS(bool ONOFF)
+{
+  if (ONOFF == true) {
+    bitWrite(misc, 12, 1);
+  } else {
+    bitWrite(misc, 12, 0);
+  }
+  Set_Property(0x2c03, misc);
+}
+
+void SI4713::RDS_TP(bool ONOFF)
+{
+  if (ONOFF == true) {
+    bitWrite(misc, 10, 1);
+  } else {
+    bitWrite(misc, 10, 0);
+  }
+  Set_Property(0x2c03, misc);
+}
+
+void SI4713::RDS_TA(bool ONOFF)
+{
+  if (ONOFF == true) {
+    bitWrite(misc, 4, 1);
+  } else {
+    bitWrite(misc, 4, 0);
+  }
+  Set_Property(0x2c03, misc);
+}
+
+void SI4713::RDS_AF(uint16_t AF)
+{
+  if (AF == 0) {
+    Set_Property(0x2c06, 0xe0e0);
+  } else {
+    Set_Property(0x2c06, 0xdd95 + AF);
+  }
+}
+
+void SI4713::RDS_MUSP(bool ONOFF)
+{
+  if (ONOFF == true) {
+    bitWrite(misc, 3, 1);
+  } else {
+    bitWrite(misc, 3, 0);
+  }
+  Set_Property(0x2c03, misc);
+}
+
+void SI4713::RDS_Enable(bool ONOFF)
+{
+  if (ONOFF == true) {
+    bitWrite(component, 2, 1);
+  } else {
+    bitWrite(component, 2, 0);
+  }
+  Set_Property(0x2100, component);
+}
+
+void SI4713::Audio_Comp_Threshold(int16_t threshold)
+{
+  Set_Property(0x2201, threshold);
+}
+
+void SI4713::Audio_Comp_Attack(uint16_t attack)
+{
+  Set_Property(0x2202, attack);
+}
+
+void SI4713::Audio_Comp_Release(uint16_t rel)
+{
+  Set_Property(0x2203, rel);
+}
+
+void SI4713::Audio_Comp_Gain(uint16_t gain)
+{
+  Set_Property(0x2204, gain);
+}
+
+void SI4713::Audio_Limiter_Release(uint16_t rel)
+{
+  Set_Property(0x2205, rel);
+}
+
+void SI4713::Audio_Limiter(bool ONOFF)
+{
+  if (ONOFF == true) {
+    bitWrite(acomp, 1, 1);
+  } else {
+    bitWrite(acomp, 1, 0);
+  }
+  Set_Property(0x2200, acomp);
+}
+
+void SI4713::Audio_AGC(bool ONOFF)
+{
+  if (ONOFF == true) {
+    bitWrite(acomp, 0, 1);
+  } else {
+    bitWrite(acomp, 0, 0);
+  }
+  Set_Property(0x2200, acomp);
+}
+
+void SI4713::MPX_Enable(bool ONOFF)
+{
+  if (ONOFF == true) {
+    bitWrite(component, 0, 1);
+    bitWrite(component, 1, 1);
+  } else {
+    bitWrite(component, 0, 0);
+    bitWrite(component, 1, 0);
+  }
+  Set_Property(0x2100, component);
+}
+
+void SI4713::Audio_Mute(bool ONOFF)
+{
+  if (ONOFF == false) {
+    Set_Property(0x2105, 0x0000);
+  } else {
+    Set_Property(0x2105, 0x0003);
+  }
+}
+
+void SI4713::Audio_PreEmphasis(uint16_t emp)
+{
+  if (emp == 0) {
+    Set_Property(0x2106, 0x0002);
+  } else if (emp == 75) {
+    Set_Property(0x2106, 0x0000);
+  } else if (emp == 50) {
+    Set_Property(0x2106, 0x0001);
+  }
+}
+
+void SI4713::MPX_Freq(uint16_t freq)
+{
+  Set_Property(0x2107, freq);
+}
+
+void SI4713::MPX_Deviation(uint16_t dev)
+{
+  Set_Property(0x2102, dev);
+}
+
+void SI4713::RDS_Deviation(uint16_t dev)
+{
+  Set_Property(0x2103, dev);
+}
+
+void SI4713::Audio_Deviation(uint16_t dev)
+{
+  Set_Property(0x2101, dev);
+}
+
+void SI4713::GPO(bool GPO1, bool GPO2, bool GPO3)
+{
+  buf[0] = 0x81;
+  if (GPO1 == true)
+  {
+    bitWrite(buf[1], 1, 1);
+  } else {
+    bitWrite(buf[1], 1, 0);
+  }
+  if (GPO2 == true)
+  {
+    bitWrite(buf[1], 2, 1);
+  } else {
+    bitWrite(buf[1], 2, 0);
+  }
+  if (GPO3 == true)
+  {
+    bitWrite(buf[1], 3, 1);
+  } else {
+    bitWrite(buf[1], 3, 0);
+  }
+  WriteBuffer(2);
+
+}
+
+void SI4713::RDS_PS(const char *PS, uint8_t number)
+{
+  char PSArray[9];
+  for (uint8_t i = 0; i < 9; i++) {
+    PSArray[i] = 0x20;
+  }
+  for (uint8_t i = 0; i < 8 && PS[i] != 0x00; i++) {
+    PSArray[i] = PS[i];
+  }
+  for (uint8_t Half = 0; Half < 2; Half++) { // TX_RDS_PS register = 4 symbols
+    uint8_t PSID = (number * 2) + Half;
+    const char *Text = PSArray + (Half * 4);
+    uint32_t Value = ((uint32_t)word(Text[0], Text[1]) << 16) | word(Text[2], Text[3]);
+    if ((PSID < TX_PS_SHADOW * 2) && bitRead(PS_Known, PSID) && (PS_Shadow[PSID] == Value)) {continue;} // chip has this text
+    PS_Write(PSID, Value);
+  }
+}
+
+void SI4713::PS_Write(uint8_t PSID, uint32_t Text)
+{
+  buf[0] = 0x36;
+  buf[1] = PSID;
+  buf[2] = Text >> 24;
+  buf[3] = Text >> 16;
+  buf[4] = Text >> 8;
+  buf[5] = Text;
+  if (WriteBuffer(6) && (PSID < TX_PS_SHADOW * 2))
+  {
+    PS_Shadow[PSID] = Text;
+    bitSet(PS_Known, PSID);
+  }
+}
+
+void SI4713::RDS_RT(const char *RT) //Old functıon. I use new TX.RDS_2A_PAGING
+{
+  char RTArray[32];
+  for (uint8_t i = 0; i < 32; i++) {
+    RTArray[i] = 0x20;
+  }
+  for (uint8_t i = 0; i < 31 && RT[i] != 0x00; i++) {
+    RTArray[i] = RT[i];
+  }
+  uint8_t counter = 0;
+  for (uint8_t i = 0; i < 8; i++) {
+    buf[0] = 0x35;
+    if (i == 0) {
+      buf[1] = 0x84; //source  value = 0x06 cirlcle buffer clear and start
+    } else {
+      buf[1] = 0x84; //Source  value = 0x04 cirlcle buffer
+    }
+    buf[2] = 0x20;
+    buf[3] = i;
+    buf[4] = RTArray[0 + counter];
+    buf[5] = RTArray[1 + counter];
+    buf[6] = RTArray[2 + counter];
+    buf[7] = RTArray[3 + counter];
+    WriteBuffer(8);
+    counter += 4;
+  }
+}
+
+void SI4713::Init(uint8_t RST, uint16_t clk, uint8_t address, TwoWire &Bus, int8_t INT_Pin)
+{
+  addr = address;           // Copy I2C address
+  this->Bus = &Bus;
+  this->INT_Pin = INT_Pin;
+  Known = 0;                // RST = -1: chip keeps its properties, shadow is empty and all of them are sent
+  PS_Known = 0;
+  Freq_Shadow = 0;
+  Output_Shadow = 0xFFFF;
+  if (RST != 0xFF)          // Send RST, POWER_UP below waits for oscillator with CTS
+  {
+    pinMode(RST, OUTPUT);
+    digitalWrite(RST, LOW);
+    delay(TX_RESET_MS);
+    digitalWrite(RST, HIGH);
+    delay(TX_RESET_MS);
+    for (uint8_t d = 0; d < TX_PROPERTIES; d++) {Shadow[d] = pgm_read_word(&TX_Defaults[d].Value);} // fresh chip
+    Known = (TX_PROPERTIES < 32) ? bit(TX_PROPERTIES) - 1 : 0xFFFFFFFF;
+  }
+  Bus.begin();
+  buf[0] = 0x01; // POWER_UP
+  buf[1] = 0x12; // Crystal oscillator, transmit mode
+  buf[2] = 0x50; // Analog audio inputs
+  if (INT_Pin >= 0)
+  {
+    pinMode(INT_Pin, INPUT_PULLUP);
+    buf[1] |= 0xC0; // CTS interrupt on GPO2/INT
+  }
+  WriteBuffer(3);
+  buf[0] = 0x80;
+  buf[1] = (INT_Pin >= 0) ? 0x0a : 0x0e; // GPO2 is INT output
+  WriteBuffer(2);
+  type_Property Table[] =
+  {
+    {0x0001, (uint16_t)((INT_Pin >= 0) ? 0x0080 : 0x0000)}, // GPO_IEN: CTS interrupt
+    {0x0201, clk},          // REFCLK_FREQ
+    {0x2300, 0x0007},       // Enable ASQ Interrupts
+    {0x2C07, RDS_FIFO_SIZE} // TX_RDS_FIFO_SIZE 0=FIFO Disabled, 4, 7, 10–54
+  };
+  Set_Properties(Table, sizeof(Table) / sizeof(Table[0]));
+}
+
+uint8_t SI4713::Set_Properties(const type_Property *Table, uint8_t Count)
+{
+  uint8_t Sent = 0;
+  for (uint8_t i = 0; i < Count; i++)
+  {
+    uint16_t Property = Table[i].Property;
+    uint16_t Value = Table[i].Value;
+    if (Property == 0x2100) {component = Value;} // keep bits for RDS_Enable(), MPX_Enable() ...
+    if (Property == 0x2200) {acomp = Value;}
+    if (Property == 0x2C03) {misc = Value;}
+
+    int8_t d = Property_Index(Property);
+    if ((d >= 0) && bitRead(Known, d) && (Shadow[d] == Value)) {continue;} // chip has it (reset default or written before)
+    Set_Property(Property, Value); // queued, chip is paced by CTS in Poll()
+    Sent++;
+  }
+  return Sent;
+}
+
+void SI4713::Resync()
+{
+  uint32_t Properties = Known;
+  uint8_t PS = PS_Known;
+  uint16_t Frequency = Freq_Shadow;
+  uint16_t Power = Output_Shadow;
+
+  Known = 0; // everything is different now
+  PS_Known = 0;
+  Freq_Shadow = 0;
+  Output_Shadow = 0xFFFF;
+  if (Power != 0xFFFF) {Output(highByte(Power), lowByte(Power));}
+  if (Frequency != 0) {Freq(Frequency);}
+  for (uint8_t d = 0; d < TX_PROPERTIES; d++)
+  {
+    if (bitRead(Properties, d)) {Set_Property(pgm_read_word(&TX_Defaults[d].Property), Shadow[d]);}
+  }
+  for (uint8_t PSID = 0; PSID < TX_PS_SHADOW * 2; PSID++)
+  {
+    if (bitRead(PS, PSID)) {PS_Write(PSID, PS_Shadow[PSID]);}
+  }
+}
+
+int8_t SI4713::Property_Index(uint16_t Property)
+{
+  for (uint8_t d = 0; d < TX_PROPERTIES; d++)
+  {
+    if (pgm_read_word(&TX_Defaults[d].Property) == Property) {return d;}
+  }
+  return -1;
+}
+
+bool SI4713::ASQ(bool &overmod, int8_t &inlevel)
+{
+  overmod = false;
+  inlevel = 0;
+  buf[0] = 0x34;
+  buf[1] = 0x00;
+  WriteCommand(2);
+  uint8_t len = 5;
+  if (!ReadBuffer(len)) {return false;}
+  overmod = bitRead(resp[1], 2);
+  inlevel = resp[4];
+  buf[0] = 0x34;
+  buf[1] = 0x01;
+  WriteBuffer(2);
+  return true;
+}
+
+bool SI4713::Rev(uint8_t &pn, uint8_t &chiprev)
+{
+  pn = 0;
+  chiprev = 0;
+  buf[0] = 0x10;
+  WriteCommand(1);
+  uint8_t len = 9;
+  if (!ReadBuffer(len)) {return false;}
+  pn = resp[1];
+  chiprev = resp[8];
+  return true;
+}
+
+// ------------------  Paging LAB  ---------------------------------
+void SI4713::RDS_PS_MIX(uint16_t PS_MIX) //TX_RDS_PS_MIX 0=Only send RDS PS if RDS Group Buffer is empty; 3=defaul 50% time
+{
+ Set_Property(0x2c02, PS_MIX);
+}
+//=======================================================================================================
+
+void SI4713::RDS_1A_PIN(uint16_t rds_pi, byte Bo, byte TP, byte PTY, byte rpc, uint16_t slc, uint16_t pinc, byte Monitor )
+// Innput: PI, Bo, TP, PTY, RPC, SLC, PINC, Monitor
+// Monitor: 1-keep trace records of groups (trace.h), 0-no log
+{
+uint16_t Group[4]; // blocks A, B, C, D
+Block block_A, block_B, block_C, block_D; // create 2 bytes blocks for send
+
+RDS_1A_BUILD (Group, rds_pi, Bo, TP, PTY, rpc, slc, pinc);
+
+// Fill RDS Group
+block_A.raw = Group[0];
+block_B.raw = Group[1]; 
+block_C.raw = Group[2]; 
+block_D.raw = Group[3]; 
+
+RDS_SEND_BUFFER (block_A, block_B, block_C, block_D, Monitor); 
+}
+
+void SI4713::RDS_1A_BUILD(uint16_t *Group, uint16_t rds_pi, byte Bo, byte TP, byte PTY, byte rpc, uint16_t slc, uint16_t pinc)
+// Innput: PI, Bo, TP, PTY, RPC, SLC, PINC
+// Output: Group = blocks A, B, C, D
+{
+type_1A Sync; // create 1A group union
+
+Sync.refined.pinc = pinc; //  
+Sync.refined.slc = slc; //  
+Sync.refined.rpc = rpc; //  
+Sync.refined.pty = PTY; //set PTY as Jazz channel; Does not matter
+Sync.refined.TP = TP;  //set TP; Does not matter
+Sync.refined.Bo = Bo; // Must be 0 = Version A 
+Sync.refined.type = 1; //Must be 1
+Sync.refined.pid = rds_pi; // PI Programm identification
+
+// Fill RDS Group
+Group[0] = Sync.raw[3];
+Group[1] = Sync.raw[2]; 
+Group[2] = Sync.raw[1]; 
+Group[3] = Sync.raw[0]; 
+}
+//=====================================================================================================================================
+
+void SI4713::RDS_7A_PAGING (uint16_t rds_pid, byte Bo, byte TP, byte PTY, byte ABflag, byte Type, uint32_t Address, const char *M_Text, byte Monitor)
+// Input: PI, Bo, TP, PTY, Text A/B flag, Type, Message
+// Monitor: 1-keep trace records of groups (trace.h), 0-no log
+{
+type_7A_Page Page;
+uint16_t Group[4]; // blocks A, B, C, D
+
+RDS_7A_COMPILE (Page, Type, Address, M_Text);
+for (uint8_t i = 0; i < Page.Groups; i++)
+{
+  RDS_7A_GROUP (Group, Page, i, rds_pid, Bo, TP, PTY, ABflag);
+  RDS_SEND_GROUP (Group, Monitor, 0, (i == Page.Groups - 1) ? TRACE_LAST : 0);
+}
+}
+//=====================================================================================================================================
+
+void SI4713::RDS_7A_COMPILE (type_7A_Page &Page, byte Type, uint32_t Address, const char *M_Text)
+// Input: Type, Address, Message (longer than PAGE_TEXT_LEN is cut as in paging queue)
+// Output: blocks C and D of all groups in Page, blocks A and B are added when a group is sent (RDS_7A_GROUP)
+{
+uint8_t Len = strnlen(M_Text, PAGE_TEXT_LEN);
+Type = RDS_7A_FORMAT(Type, Len); // numeric message in fewest groups
+
+type_7A_adress tmp_CD; //union for address/data in C and D blocks
+
+// Address digits ggnnnn
+uint8_t Digit[6];
+uint32_t tmp_Address = Address;
+for (int8_t i = 5; i >= 0; i--)
+{
+  Digit[i] = tmp_Address % 10;
+  tmp_Address = tmp_Address / 10;
+}
+
+uint8_t Groups = RDS_7A_GROUPS(Type, Len); // groups in message
+
+for (uint8_t i = 0; i < Groups; i++)
+{
+if (i == 0) // address group
+{
+tmp_CD.refined.a_1 = Digit[0];
+tmp_CD.refined.a_2 = Digit[1];
+tmp_CD.refined.a_3 = Digit[2];
+tmp_CD.refined.a_4 = Digit[3];
+tmp_CD.refined.a_5 = Digit[4];
+tmp_CD.refined.a_6 = Digit[5];
+
+if (Type == TONE) // any data
+   {
+     tmp_CD.refined.d_1 = 8;
+     tmp_CD.refined.d_2 = 9;
+   }
+else if ((Type == ALPHA) || (Type == VARNUM) || (Type == FUNC)) // X1X2: message type, national; repeat flag and call counter are set when sent (RDS_7A_X1X2)
+   {
+     type_7A_X1X2 X1X2;
+     X1X2.raw = 0;
+     X1X2.refined.MessageType = (Type == ALPHA) ? 0 : (Type == VARNUM) ? 1 : 3;
+     tmp_CD.refined.d_1 = X1X2.raw >> 4;
+     tmp_CD.refined.d_2 = X1X2.raw & 0x0F;
+   }
+else // first 2 digits
+   {
+     tmp_CD.refined.d_1 = NumericDigit(M_Text, Len, 0);
+     tmp_CD.refined.d_2 = NumericDigit(M_Text, Len, 1);
+   }
+Page.Data[i][0] = tmp_CD.raw[1];
+Page.Data[i][1] = tmp_CD.raw[0];
+}
+else if ((Type == DIG10) || (Type == DIG18)) // 8 digits in each numeric group
+{
+uint8_t Pos = (i - 1) * 8 + 2; // first digit in group
+tmp_CD.refined.a_1 = NumericDigit(M_Text, Len, Pos);
+tmp_CD.refined.a_2 = NumericDigit(M_Text, Len, Pos + 1);
+tmp_CD.refined.a_3 = NumericDigit(M_Text, Len, Pos + 2);
+tmp_CD.refined.a_4 = NumericDigit(M_Text, Len, Pos + 3);
+tmp_CD.refined.a_5 = NumericDigit(M_Text, Len, Pos + 4);
+tmp_CD.refined.a_6 = NumericDigit(M_Text, Len, Pos + 5);
+tmp_CD.refined.d_1 = NumericDigit(M_Text, Len, Pos + 6);
+tmp_CD.refined.d_2 = NumericDigit(M_Text, Len, Pos + 7);
+Page.Data[i][0] = tmp_CD.raw[1];
+Page.Data[i][1] = tmp_CD.raw[0];
+}
+else if (Type != ALPHA) // 8 digits in each variable-length group
+{
+uint8_t Pos = (i - 1) * 8; // first digit in group
+uint8_t Nibble[8];
+for (uint8_t d = 0; d < 8; d++) {Nibble[d] = (Type == FUNC) ? FunctionDigit(M_Text, Len, Pos + d) : NumericDigit(M_Text, Len, Pos + d);}
+tmp_CD.refined.a_1 = Nibble[0];
+tmp_CD.refined.a_2 = Nibble[1];
+tmp_CD.refined.a_3 = Nibble[2];
+tmp_CD.refined.a_4 = Nibble[3];
+tmp_CD.refined.a_5 = Nibble[4];
+tmp_CD.refined.a_6 = Nibble[5];
+tmp_CD.refined.d_1 = Nibble[6];
+tmp_CD.refined.d_2 = Nibble[7];
+Page.Data[i][0] = tmp_CD.raw[1];
+Page.Data[i][1] = tmp_CD.raw[0];
+}
+else // 4 symbols in each alpha group
+{
+uint8_t Pos = (i - 1) * 4; // first symbol in group
+Block tmp; //for Block C and D data filling
+tmp.refined.HighByte = AlphaSymbol(M_Text, Len, Pos);
+tmp.refined.LowByte = AlphaSymbol(M_Text, Len, Pos + 1);
+Page.Data[i][0] = tmp.raw; // 1 and 2 symbol
+tmp.refined.HighByte = AlphaSymbol(M_Text, Len, Pos + 2);
+tmp.refined.LowByte = AlphaSymbol(M_Text, Len, Pos + 3);
+Page.Data[i][1] = tmp.raw; // 3 and 4 symbol
+}
+}
+
+Page.Type = Type;
+Page.Groups = Groups;
+}
+//=====================================================================================================================================
+
+void SI4713::RDS_7A_GROUP (uint16_t *Group, const type_7A_Page &Page, uint8_t i, uint16_t rds_pid, byte Bo, byte TP, byte PTY, byte ABflag)
+// Input: encoded Message, group number, PI, Bo, TP, PTY, Text A/B flag
+// Output: Group {A,B,C,D}, X1X2 of address group is 0 (RDS_7A_X1X2)
+{
+type_7A Message; // create 7A group union for Block A and B
+
+// fill Static fields 
+Message.refined.ABflag = ABflag; //see notes  
+Message.refined.pty = PTY; //set PTY as Jazz channel; Does not matter
+Message.refined.TP = TP;  //set TP; Does not matter
+Message.refined.Bo = Bo; // Must be 0 = Version A 
+Message.refined.type = 7; //Must be 7
+Message.refined.pid = rds_pid; // PI Programm identification
+Message.refined.address = Page.Data[i][0];
+Message.refined.data = Page.Data[i][1];
+
+uint8_t psac = 0; // Paging Segment Address Code of first group
+
+switch (Page.Type) {
+
+     case TONE: //Tone Message
+          psac = 0;
+          break;
+
+     case DIG10: //10 digits Numeric Message
+          psac = 2;
+          break;
+
+     case DIG18: //18 digits Numeric Message
+          psac = 4;
+          break;
+
+     case ALPHA: //Alpha Message
+     case VARNUM: //Variable-length numeric Message: as alpha, X1X2 byte tells the pager
+     case FUNC: //Variable-length function Message
+          psac = 8;
+          break;
+     }
+
+if ((i == 0) || (Page.Type == DIG10) || (Page.Type == DIG18)) // address group, numeric groups count from it
+   {
+     Message.refined.psac = psac + i;
+   }
+else if (i == (Page.Groups - 1)) //last packet
+   {
+     Message.refined.psac = 0xF;
+   } 
+else //psac 9..E, then again from 9 for each 24 symbols
+   {
+     Message.refined.psac = 9 + (i - 1) % 6;
+   }  
+
+// Fill RDS Group
+Group[0] = Message.raw[3];
+Group[1] = Message.raw[2]; 
+Group[2] = Message.raw[1]; 
+Group[3] = Message.raw[0]; 
+}
+//=====================================================================================================================================
+
+uint8_t SI4713::RDS_7A_GROUPS (byte Type, uint8_t Len)
+// Groups in message of Type with Len symbols
+{
+uint8_t Groups = 0;
+
+switch (Type) {
+
+     case TONE: //Tone Message: address group only
+          Groups = 1;
+          break;
+
+     case DIG10: //10 digits Numeric Message
+          Groups = 2;
+          break;
+
+     case DIG18: //18 digits Numeric Message
+          Groups = 3;
+          break;
+
+     case ALPHA: //Alpha Message: address group + 4 symbols in each group
+          Groups = 1 + (Len + 3) / 4;
+          if (Len == 0) {Groups = 2;} // send one empty block
+          if (Groups > PAGE_MAX_GROUPS) {Groups = PAGE_MAX_GROUPS;} // max 80 symbols
+          break;
+
+     case VARNUM: //Variable-length numeric/function Message: address group + 8 digits in each group
+     case FUNC:
+          Groups = 1 + (Len + 7) / 8;
+          if (Len == 0) {Groups = 2;} // send one empty block
+          if (Groups > PAGE_MAX_GROUPS) {Groups = PAGE_MAX_GROUPS;}
+          break;
+     }
+
+return Groups;
+}
+
+void SI4713::RDS_7A_X1X2 (uint16_t *Group, byte Type, uint8_t Call, bool Repeat)
+// X1X2 is last byte of block D in address group of alpha and variable-length messages, encoded message keeps it with 0 in both fields
+{
+if ((Type != ALPHA) && (Type != VARNUM) && (Type != FUNC)) {return;} // other formats have digits there
+
+type_7A_X1X2 X1X2;
+X1X2.raw = lowByte(Group[3]);
+X1X2.refined.CallCounter = Call;
+X1X2.refined.RepeatFlag = Repeat ? 1 : 0;
+Group[3] = (Group[3] & 0xFF00) | X1X2.raw;
+}
+
+byte SI4713::RDS_7A_FORMAT (byte Type, uint8_t Len)
+// Fixed formats carry 2 digits in address group, variable-length needs X1X2 there: 10 digits = 2 groups, 18 = 3, more = variable
+{
+if ((Type != DIG10) && (Type != DIG18) && (Type != VARNUM)) {return Type;}
+
+if (Len <= 10) {return DIG10;} // fixed format when groups are the same, every numeric pager knows it
+if (Len <= 18) {return (RDS_7A_GROUPS(VARNUM, Len) < RDS_7A_GROUPS(DIG18, Len)) ? VARNUM : DIG18;}
+return VARNUM; // fixed formats would cut the text
+}
+//=====================================================================================================================================
+
+uint8_t SI4713::NumericDigit (const char *Text, uint8_t Len, uint8_t Pos) 
+// Digit for numeric message, ':' (space) after end of text
+{
+if (Len == 0) {return NumericDigit(" ", 1, Pos);} // same as one space symbol
+if (Pos < Len) {return Text[Pos] & 0x0F;} 
+return ':' & 0x0F;
+}
+
+uint8_t SI4713::FunctionDigit (const char *Text, uint8_t Len, uint8_t Pos) 
+// Hex digit for function message, ':' (0xA) after end of text
+{
+if (Pos >= Len) {return ':' & 0x0F;}
+char Symbol = Text[Pos];
+if ((Symbol >= 'A') && (Symbol <= 'F')) {return Symbol - 'A' + 10;}
+if ((Symbol >= 'a') && (Symbol <= 'f')) {return Symbol - 'a' + 10;}
+return Symbol & 0x0F;
+}
+
+uint8_t SI4713::AlphaSymbol (const char *Text, uint8_t Len, uint8_t Pos) 
+// Symbol for alpha message, ' ' after end of text
+{
+if (Pos < Len) {return Text[Pos];}
+return ' ';
+}
+//======================================= END 7A================================================================
+
+
+void SI4713::RDS_4A_TIME (uint16_t rds_pid, byte Bo, byte TP, byte PTY, uint16_t Year, byte Month, byte Day, byte Hour, byte Minute, byte O_Sign, byte O_Hour, byte O_Minute, byte Monitor) 
+// Input: PI, Bo, TP, PTY, Year, Month, Day, Hour, Minute, Offset sign, Offset hour, Offset minute
+// Monitor: 1-keep trace records of groups (trace.h), 0-no log
+{
+uint16_t Group[4]; // blocks A, B, C, D
+Block block_A, block_B, block_C, block_D; // create 2 bytes block for send
+
+RDS_4A_BUILD (Group, rds_pid, Bo, TP, PTY, Year, Month, Day, Hour, Minute, O_Sign, O_Hour, O_Minute);
+
+// Fill RDS Group
+block_A.raw = Group[0];
+block_B.raw = Group[1]; 
+block_C.raw = Group[2]; 
+block_D.raw = Group[3]; 
+
+RDS_SEND_BUFFER (block_A, block_B, block_C, block_D, Monitor); 
+}
+
+void SI4713::RDS_4A_BUILD (uint16_t *Group, uint16_t rds_pid, byte Bo, byte TP, byte PTY, uint16_t Year, byte Month, byte Day, byte Hour, byte Minute, byte O_Sign, byte O_Hour, byte O_Minute) 
+// Input: PI, Bo, TP, PTY, Year, Month, Day, Hour, Minute, Offset sign, Offset hour, Offset minute
+// Output: Group = blocks A, B, C, D
+{
+long Current_MJD = ymd_to_mjd (Year, Month, Day); // Date as Modified Julian Date 60586=03/10/2024
+
+//Start Calculate offset
+int Offset = 0;
+if (O_Hour <= 15)
+{
+  Offset = O_Hour * 2; 
+}
+if (O_Minute == 30)
+{
+  Offset = Offset + 1; 
+}
+//End Calculate offset
+
+type_4A DateTime; // create 4A group union for Date and Time
+
+// fill DateTime Union 
+DateTime.refined.offset = Offset; //0x1C=14:00; //
+DateTime.refined.offset_sense = O_Sign; // Set offset sign bit
+DateTime.refined.hour_lo = Hour & 0x0F; // Set Time: hour
+DateTime.refined.hour_hi = Hour >> 4;
+DateTime.refined.minute = Minute; // Set Time: minutes
+DateTime.refined.mjd_lo = Current_MJD & 0x7FFF; // Set Date
+DateTime.refined.mjd_hi = Current_MJD >> 15;
+DateTime.refined.spr = 0; //Always 0; Does not matter, spare bits
+DateTime.refined.pty = PTY; //set PTY as Scientist channel; Does not matter
+DateTime.refined.TP = TP;  //set TP; Does not matter
+DateTime.refined.Bo = Bo; // Must be 0 = Version A 
+DateTime.refined.type = 4; //Must be 4
+DateTime.refined.pid = rds_pid; // PI Programm identification
+
+// Fill RDS Group
+Group[0] = DateTime.raw[3];
+Group[1] = DateTime.raw[2]; 
+Group[2] = DateTime.raw[1]; 
+Group[3] = DateTime.raw[0]; 
+}
+//=======================================================================================================
+
+// -----------------------------------  New functıon for senf 2A Group
+void SI4713::RDS_2A_RT (uint16_t rds_pid, byte Bo, byte TP, byte PTY, byte ABflag, const char *RT, byte Monitor)
+// Input: PI, Bo, TP, PTY, Text A/B flag, Radio Text
+// Monitor: 1-keep trace records of groups (trace.h), 0-no log
+{
+uint16_t Group[4]; // blocks A, B, C, D
+
+int RDSCounter = RDS_2A_BUILD (Group, rds_pid, Bo, TP, PTY, ABflag, RT, 0); //Total packets for 2A groups 
+
+for (int i=0; i<RDSCounter; i++)
+{
+RDS_2A_BUILD (Group, rds_pid, Bo, TP, PTY, ABflag, RT, i);
+
+RDS_SEND_GROUP (Group, Monitor, 0, (i == RDSCounter - 1) ? TRACE_LAST : 0); 
+}
+// End of cycle
+}
+
+uint8_t SI4713::RDS_2A_BUILD (uint16_t *Group, uint16_t rds_pid, byte Bo, byte TP, byte PTY, byte ABflag, const char *RT, uint8_t Segment)
+// Input: PI, Bo, TP, PTY, Text A/B flag, Radio Text, segment number (4 symbols in each segment)
+// Output: Group = blocks A, B, C, D; return total segments in text
+{
+type_2A RadioText; // create 2A group union for Radio Text
+
+uint8_t Len = strlen(RT);
+if (Len > 64) {Len = 64;} // max 16 segments
+
+// fill Radio Text Static fields 
+RadioText.refined.ABflag = ABflag; //toggles for new text; see comments in typedef type_2A
+RadioText.refined.pty = PTY; //set PTY as Jazz channel; Does not matter
+RadioText.refined.TP = TP;  //set TP; Does not matter
+RadioText.refined.Bo = Bo; // Must be 0 = Version A 
+RadioText.refined.type = 2; //Must be 2
+RadioText.refined.pid = rds_pid; // PI Programm identification
+RadioText.refined.counter = Segment; //Counter
+
+Block tmp; //for Block C and D data filling
+uint8_t Pos = Segment * 4;
+
+tmp.refined.HighByte = AlphaSymbol(RT, Len, Pos); // WORK !!!
+tmp.refined.LowByte = AlphaSymbol(RT, Len, Pos + 1); 
+RadioText.refined.text1 = tmp.raw; // 1 and 2 char 
+
+tmp.refined.HighByte = AlphaSymbol(RT, Len, Pos + 2); // WORK !!!
+tmp.refined.LowByte = AlphaSymbol(RT, Len, Pos + 3); 
+RadioText.refined.text2 = tmp.raw; // 3 and 4 char 
+
+// Fill RDS Group
+Group[0] = RadioText.raw[3];
+Group[1] = RadioText.raw[2]; 
+Group[2] = RadioText.raw[1]; 
+Group[3] = RadioText.raw[0]; 
+
+return (Len + 3) / 4;
+}
+//=====================================================================================================================================
+
+// --------------------------       Send RDS packet --------------------------------------------
+void SI4713::RDS_SEND_BUFFER (Block A, Block B, Block C, Block D, byte Monitor) 
+{
+uint16_t Blocks[4] = {A.raw, B.raw, C.raw, D.raw};
+RDS_SEND_GROUP(Blocks, Monitor);
+}
+//=======================================================================================================
+
+bool SI4713::RDS_SEND_GROUP (const uint16_t *Group, byte Monitor, uint8_t ID, uint8_t Flags) 
+// Input: blocks A, B, C, D; monitor keeps binary record, it is printed later (trace.h)
+// Output: false = group was not loaded to this chip (FIFO full or command queue full), see Errors
+{
+bool Loaded = RDS_LOAD_BUFFER(Group);
+if (Loaded) {Stats.Groups[Group[1] >> 12]++;} // once for each group, not for each simulcast chip
+for (SI4713 *Chip = Simulcast; Chip != 0; Chip = Chip->Simulcast) {Chip->RDS_LOAD_BUFFER(Group);} // same group in same slot on each chip
+
+    if (Monitor && Loaded) //Output log
+    {
+      Trace.Add(Group, ID, Flags | Trace_Flags);
+    }
+return Loaded;
+}
+//=======================================================================================================
+
+bool SI4713::RDS_LOAD_BUFFER (const uint16_t *Group) 
+// Input: blocks A, B, C, D (block A is PI property, chip doesn't take it from buffer)
+{
+unsigned long Start = millis();
+while (RDS_FIFO_USED() >= RDS_FIFO_SIZE) // FIFO is full, wait for air time
+    {
+      Poll();
+      if ((millis() - Start) > TX_CMD_TIMEOUT) // chip doesn't send groups or FIFO level is wrong
+      {
+        Failed(TX_ERR_FIFO);
+        return false;
+      }
+    }
+
+// Fill chip buffer for send RDS group
+Fifo.Queued++;
+buf[0] = 0x35; //Create buffer TX_RDS_BUFF
+buf[1] = 0x85; //Set FIFO, LDBUFF and INTACK 0x85 (INTACK clears FIFOMT, so it shows underflow since last group)
+buf[2] = highByte(Group[1]); //B
+buf[3] = lowByte(Group[1]);
+buf[4] = highByte(Group[2]); //C
+buf[5] = lowByte(Group[2]);
+buf[6] = highByte(Group[3]); //D
+buf[7] = lowByte(Group[3]);
+
+if (!WriteBuffer(8)) {Fifo.Queued--; return false;} // command queue stayed full
+if ((Group[1] >> 11) == 0x08) {Fifo.Watch = Fifo.Queued; Fifo.In_FIFO = false;} // 4A: its answer and later ones tell when it goes to air
+return true;
+}
+//=======================================================================================================
+
+// --------------------------       RDS FIFO state --------------------------------------------
+void SI4713::RDS_FIFO_STATUS ()
+{
+buf[0] = 0x35; //TX_RDS_BUFF without LDBUFF only returns FIFO state
+buf[1] = 0x00;
+buf[2] = 0x00;
+buf[3] = 0x00;
+buf[4] = 0x00;
+buf[5] = 0x00;
+buf[6] = 0x00;
+buf[7] = 0x00;
+WriteBuffer(8);
+}
+
+void SI4713::RDS_FIFO_UPDATE ()
+// resp: STATUS, FLAGS (RDSPSXMIT CBUFXMIT FIFOXMIT CBUFWRAP FIFOMT), CBAVAIL, CBUSED, FIFOAVAIL, FIFOUSED
+// FIFOUSED doesn't count the group on air: 4A has left FIFO when FIFOUSED is not more than groups loaded after it
+{
+bool Load = bitRead(CmdQueue[CmdHead].data[1], 2); // LDBUFF: command carried a group
+bool Load_4A = Load && (Fifo.Watch == 1); // answer of watched 4A
+
+RDS_BUFF_DONE(CmdQueue[CmdHead].data[1]);
+if (Load && (bitRead(resp[0], 6) == 1)) {Fifo.Overflows++;} // ERR: FIFO was full, group was not loaded
+if (bitRead(resp[1], 0) == 1) {Fifo.Underflows++;} // FIFO was empty since last INTACK
+if (Fifo.Clearing) {return;} // MTBUFF waits in queue, FIFO level is old
+
+Fifo.Avail = resp[4];
+Fifo.Used = resp[5];
+Fifo.Updated = millis();
+
+if (Load_4A) // 4A is in FIFO unless it was rejected
+   {
+     Fifo.In_FIFO = (bitRead(resp[0], 6) == 0);
+     Fifo.Behind = 0;
+     Fifo.Seen = Fifo.Updated;
+   }
+else if (Fifo.In_FIFO)
+   {
+     if (Load && (bitRead(resp[0], 6) == 0)) {Fifo.Behind++;}
+     if (Fifo.Used > Fifo.Behind) {Fifo.Seen = Fifo.Updated;} // still waiting
+     else
+        {
+          Fifo.In_FIFO = false;
+          Fifo.Left = Fifo.Seen + (Fifo.Updated - Fifo.Seen) / 2;
+          Fifo.Left_Ready = true;
+        }
+   }
+}
+
+uint8_t SI4713::RDS_FIFO_USED ()
+{
+unsigned long Aired = ((millis() - Fifo.Updated) * 1000UL) / RDS_GROUP_TIME_US; // groups sent to air since last answer
+uint8_t Used = 0;
+
+if (Aired < Fifo.Used) {Used = Fifo.Used - Aired;}
+return Used + Fifo.Queued - Fifo.Cleared;
+}
+
+void SI4713::RDS_BUFF_DONE (uint8_t Flags)
+{
+if (bitRead(Flags, 2)) // LDBUFF
+   {
+     Fifo.Queued--;
+     if (Fifo.Watch) {Fifo.Watch--;}
+     if (Fifo.Cleared) {Fifo.Cleared--;} // commands go in order: while MTBUFF waits, each done group was before it
+   }
+if (bitRead(Flags, 1) && Fifo.Clearing) {Fifo.Clearing--;} // MTBUFF
+}
+
+void SI4713::RDS_FIFO_CLEAR ()
+{
+buf[0] = 0x35; //TX_RDS_BUFF
+buf[1] = 0x82; //FIFO and MTBUFF: empty FIFO, group on air ends
+buf[2] = 0x00;
+buf[3] = 0x00;
+buf[4] = 0x00;
+buf[5] = 0x00;
+buf[6] = 0x00;
+buf[7] = 0x00;
+WriteBuffer(8);
+Fifo.Cleared = Fifo.Queued;
+Fifo.Clearing++;
+Fifo.Watch = 0; // 4A is written again (Reload) or not sent
+Fifo.In_FIFO = false;
+Fifo.Used = 0;
+Fifo.Updated = millis();
+for (SI4713 *Chip = Simulcast; Chip != 0; Chip = Chip->Simulcast) {Chip->RDS_FIFO_CLEAR();}
+}
@@ -0,0 +1,72 @@
+/*  Counters of RDS Encoder
+ *
+ *  Always on, a few instructions for each event. Times are kept in histograms with log2 buckets:
+ *  bucket 0 = 0, bucket n = 2^(n-1) .. 2^n - 1, last bucket takes all longer times. Buckets are 8 bit (RAM):
+ *  when one is full all of them are halved, so they keep the shape of the distribution, Count keeps the total.
+ *  Read with menu [14] (lines "name=value", histogram "name=count,max,b0,b1,...") or frame CMD_STATS,
+ *  reset with menu [15] or frame CMD_STATS_RESET.
+ */
+
+// -------------------------------------------------------- TYPE DEFINITIONS
+#define STATS_BUCKETS 16
+
+typedef struct
+{
+  uint32_t Count;                  // Events
+  uint32_t Max;                    // Longest time
+  uint8_t Bucket[STATS_BUCKETS];   // Events in each log2 bucket, all halved when one is full
+} type_Histogram;
+//=========================================== END TYPE DEFINITIONS =======================================
+
+class EncoderStats
+{
+  public:
+    uint32_t I2C_Commands;          // Chip commands done
+    uint32_t CTS_Spins;             // CTS reads without CTS
+    uint32_t Groups[16];            // Groups written to FIFO by group type (0A, 1A, 2A, 4A, 7A, ...), once for all simulcast chips
+    uint8_t Queue_Max;              // Longest paging queue
+    uint32_t Groups_Saved;          // 7A groups not sent because numeric message went in shorter format
+    uint32_t Repeats;               // Repeats of messages sent (paging.h)
+    uint16_t Repeats_Dropped;       // Waiting repeats replaced by new messages
+    uint16_t Preemptions;           // Messages interrupted by urgent message (paging.h)
+    uint16_t Groups_Reloaded;       // Groups written to FIFO again after it was emptied for urgent message (sequencer.h)
+    type_Histogram I2C_Time;        // Chip command from write to CTS, us
+    type_Histogram Page_Latency;    // Message from Submit() to air, ms
+    type_Histogram Urgent_Latency;  // Urgent message from Submit() to air, ms
+    type_Histogram Loop_Time;       // One loop(), us
+    type_Histogram Time_Offset;     // 4A on air after minute start, ms, measured from FIFO answers of the chip (clock.h)
+
+    EncoderStats() {Reset();}
+    void Reset();
+    static void Add(type_Histogram &Histogram, uint32_t Value); // Count one time
+};
+// =============================================== End Class ======================================
+
+EncoderStats Stats; // counters
+
+void EncoderStats::Reset()
+{
+memset(this, 0, sizeof(EncoderStats));
+}
+//=================================================================================
+
+void EncoderStats::Add(type_Histogram &Histogram, uint32_t Value)
+{
+uint8_t n = 0;
+uint32_t Rest = Value;
+
+while ((Rest != 0) && (n < STATS_BUCKETS - 1)) // log2 bucket
+{
+  Rest >>= 1;
+  n++;
+}
+
+if (Histogram.Bucket[n] == 0xFF) // keep shape, not counts
+   {
+     for (uint8_t i = 0; i < STATS_BUCKETS; i++) {Histogram.Bucket[i] >>= 1;}
+   }
+Histogram.Bucket[n]++;
+Histogram.Count++;
+if (Value > Histogram.Max) {Histogram.Max = Value;}
+}
+//=================================================================================
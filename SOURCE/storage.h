@@ -0,0 +1,87 @@
+/*  Config storage for RDS Encoder
+ *
+ *  Config (config.h) is kept in EEPROM as one fixed image: Version u8, Size u16, Config, CRC16 of all bytes before CRC.
+ *  Load() reads the image in one EEPROM.get() and takes it only when Version, Size and CRC are right, else Config keeps
+ *  its defaults. Save() writes only bytes which are different (EEPROM.update), so a changed frequency costs a few
+ *  cells of 100000 write cycles, not the whole image. Change CFG_VERSION when Config fields change.
+ *  Setters call Changed() and Run() saves only after CFG_SAVE_DELAY ms without a new change, so a burst of settings
+ *  (gateway frames, SET_7A_ADDRESS before each page, radio text updates) is one write or none while it goes on.
+ */
+
+#include <EEPROM.h>
+
+// -------------------------------------------------------- TYPE DEFINITIONS
+typedef struct
+{
+  uint8_t Version;  // CFG_VERSION
+  uint16_t Size;    // sizeof(Config)
+  Config Cfg;
+  uint16_t CRC;     // CRC16 of Version, Size and Cfg
+} type_Config_Image;
+//=========================================== END TYPE DEFINITIONS =======================================
+
+class ConfigStore
+{
+  public:
+    bool Load(Config &Cfg);         // Read Config from EEPROM; false = no valid image, Cfg is not changed
+    uint16_t Save(const Config &Cfg); // Write changed bytes of Config image, return number of written bytes
+    void Changed();                 // Config was changed, Run() saves it later
+    void Run(const Config &Cfg);    // Save after CFG_SAVE_DELAY ms without change, call it from loop()
+    bool Loaded = false;            // Config was read from EEPROM at boot
+
+  private:
+    bool Pending = false;           // Change not saved yet
+    unsigned long Change_Time = 0;  // millis() of last change
+};
+// =============================================== End Class ======================================
+
+ConfigStore Storage; // Config in EEPROM
+
+bool ConfigStore::Load(Config &Cfg)
+{
+type_Config_Image Image;
+
+EEPROM.get(CFG_EEPROM_ADDR, Image);
+Loaded = (Image.Version == CFG_VERSION) && (Image.Size == sizeof(Config)) &&
+         (CRC16((const uint8_t *)&Image, offsetof(type_Config_Image, CRC)) == Image.CRC);
+if (Loaded) {memcpy((void *)&Cfg, (const void *)&Image.Cfg, sizeof(Config));}
+return Loaded;
+}
+//=================================================================================
+
+uint16_t ConfigStore::Save(const Config &Cfg)
+{
+type_Config_Image Image;
+uint16_t Written = 0;
+
+memset((void *)&Image, 0, sizeof(Image)); // padding bytes are the same in each image
+Image.Version = CFG_VERSION;
+Image.Size = sizeof(Config);
+memcpy((void *)&Image.Cfg, (const void *)&Cfg, sizeof(Config));
+Image.CRC = CRC16((const uint8_t *)&Image, offsetof(type_Config_Image, CRC));
+
+const uint8_t *p = (const uint8_t *)&Image;
+for (uint16_t i = 0; i < sizeof(Image); i++) // only changed cells are written
+{
+  if (EEPROM.read(CFG_EEPROM_ADDR + i) == p[i]) {continue;}
+  EEPROM.update(CFG_EEPROM_ADDR + i, p[i]);
+  Written++;
+}
+return Written;
+}
+//=================================================================================
+
+void ConfigStore::Changed()
+{
+Pending = true;
+Change_Time = millis();
+}
+//=================================================================================
+
+void ConfigStore::Run(const Config &Cfg)
+{
+if (!Pending || ((millis() - Change_Time) < CFG_SAVE_DELAY)) {return;}
+Pending = false;
+Save(Cfg);
+}
+//=================================================================================
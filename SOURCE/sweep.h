@@ -0,0 +1,172 @@
+/*  Country sweep for pagers with unknown country code
+ *
+ *  In national mode pager takes messages only when country nibble of PI is the same as in its EEPROM.
+ *  Sweep encodes one message once and sends it again with each country code of the mask (1..F),
+ *  between passes only PI changes: chip property RDS_PI and block A of groups.
+ *
+ *  Block A of FIFO groups is not taken from buffer, chip sends PI property at air time. So PI is changed only when
+ *  FIFO is empty and last group is on air: sequencer doesn't write groups while Hold() is true (chip sends 0A then).
+ *  While sweep runs the paging queue waits, message which was started before the sweep is finished first.
+ *  Each pass waits for battery saving interval of the pager (paging.h): with RPC ON one pass takes one minute.
+ *  After last pass or Stop() (message is received) PI of Config goes back to the chip.
+ *  A/B flag and call counter come from the pager table of the paging queue (PagingQueue::NewMessage(), the same
+ *  comparison of type, length and CRC32 of text), so a new message is never sent as the last one; passes have no
+ *  repeat flag.
+ */
+
+// -------------------------------------------------------- TYPE DEFINITIONS
+#define SWEEP_IDLE  0 // no sweep
+#define SWEEP_DRAIN 1 // waiting for empty FIFO to change PI
+#define SWEEP_SEND  2 // pass is on air
+#define SWEEP_DONE  3 // PI of Config is back, result is not shown yet
+
+#define SWEEP_ALL 0xFFFE // countries 1..F
+//=========================================== END TYPE DEFINITIONS =======================================
+
+class CountrySweep
+{
+  public:
+    uint8_t Start(uint32_t Address, byte Type, const char *Text, uint16_t Countries, Config &Cfg, PagingQueue &Pages); // Start sweep, return passes (0 = sweep is running)
+    bool Stop();                                                    // Message is received: end sweep after group on air, false = no sweep
+    bool Hold(SI4713 &TX, Config &Cfg, bool Busy);                  // Sequencer must not write groups now (Busy = queue message is half sent)
+    bool NextGroup(uint16_t *Group, SI4713 &TX, Config &Cfg, uint32_t Slot_Time); // Next 7A group of pass, false = pager sleeps or PI is changing
+    uint16_t PI(uint16_t Cfg_PI) {return (State == SWEEP_IDLE) ? Cfg_PI : Air_PI;} // Block A for groups going to air
+    bool Active() {return (State == SWEEP_DRAIN) || (State == SWEEP_SEND);}
+    uint32_t Air_ms() {return (Air_Groups * RDS_GROUP_TIME_US) / 1000;} // Air time of sent 7A groups
+    uint32_t Time_ms() {return (Active() ? millis() : Finished) - Started;} // From Start() to PI of Config back
+
+    uint8_t State = SWEEP_IDLE;
+    uint8_t Country = 0;          // Country of last complete pass, 0 = none
+    uint8_t Passes = 0;           // Complete passes
+    uint8_t Groups = 0;           // Groups of message in each pass
+    uint8_t Group_Flags = 0;      // TRACE_LAST: last group was end of pass
+    bool Confirmed = false;       // Sweep was stopped by Stop()
+
+  private:
+    uint8_t NextCountry(uint8_t From); // Next country of mask after From, 0 = end
+
+    uint32_t Address = 0;
+    uint8_t ABflag = 0;
+    uint8_t Call = 0;             // Call counter of pager
+    uint16_t Countries = 0;       // Bit n = country n
+    uint8_t Next = 0;             // Country of next pass, 0 = PI of Config
+    uint16_t Air_PI = 0;          // PI on air now
+    type_7A_Page Encoded;         // Message of all passes
+    uint8_t Page_Group = 0;       // Next group of pass
+    uint32_t Air_Groups = 0;
+    unsigned long Started = 0;
+    unsigned long Finished = 0;
+    unsigned long Drained = 0;    // millis() when FIFO was seen empty
+    bool Empty = false;
+};
+// =============================================== End Class ======================================
+
+uint8_t CountrySweep::Start(uint32_t Address, byte Type, const char *Text, uint16_t Countries, Config &Cfg, PagingQueue &Pages)
+{
+if (Active()) {return 0;}
+
+Countries &= SWEEP_ALL; // country 0 is not used
+if (Countries == 0) {Countries = SWEEP_ALL;}
+
+this->Address = Address;
+this->Countries = Countries;
+SI4713::RDS_7A_COMPILE(Encoded, Type, Address, Text); // once for all passes, text is not kept
+Groups = Encoded.Groups;
+Pages.NewMessage(Address, Encoded.Type, Text, ABflag, Call); // same check as message of queue
+
+Air_PI = Cfg.cfg_pi.All;
+Next = NextCountry(0);
+Country = 0;
+Passes = 0;
+Air_Groups = 0;
+Confirmed = false;
+Empty = false;
+Started = millis();
+State = SWEEP_DRAIN;
+
+uint8_t Total = 0;
+for (uint8_t c = 1; c < 16; c++) {if (bitRead(Countries, c)) {Total++;}}
+return Total;
+}
+//=================================================================================
+
+bool CountrySweep::Stop()
+{
+if (!Active()) {return false;}
+
+Confirmed = true;
+Next = 0; // rest of pass is not sent
+Empty = false;
+State = SWEEP_DRAIN;
+return true;
+}
+//=================================================================================
+
+bool CountrySweep::Hold(SI4713 &TX, Config &Cfg, bool Busy)
+{
+if (State != SWEEP_DRAIN) {return false;}
+if (Busy) {return false;} // queue message goes with old PI to its end
+
+if (TX.RDS_FIFO_USED() > 0)
+   {
+     Empty = false;
+     return true;
+   }
+if (!Empty) // FIFO is empty, wait while last group is on air
+   {
+     Empty = true;
+     Drained = millis();
+   }
+if ((millis() - Drained) < RDS_GROUP_TIME_US / 1000 + 1) {return true;}
+
+if (Next == 0) // back to Config
+   {
+     Air_PI = Cfg.cfg_pi.All;
+     TX.RDS_PI(Air_PI);
+     Finished = millis();
+     State = SWEEP_DONE;
+     return false;
+   }
+
+type_pi tmp_PI;
+tmp_PI.All = Cfg.cfg_pi.All;
+tmp_PI.refined.pi_country = Next;
+Air_PI = tmp_PI.All;
+TX.RDS_PI(Air_PI);
+Page_Group = 0;
+State = SWEEP_SEND;
+return false;
+}
+//=================================================================================
+
+bool CountrySweep::NextGroup(uint16_t *Group, SI4713 &TX, Config &Cfg, uint32_t Slot_Time)
+{
+if (State != SWEEP_SEND) {return false;}
+
+if ((Page_Group == 0) && !PagingQueue::PagerAwake(Address, Cfg.cfg_1A_Rpc, Slot_Time, Groups)) {return false;}
+
+SI4713::RDS_7A_GROUP(Group, Encoded, Page_Group, Air_PI, Cfg.cfg_Bo, Cfg.cfg_TP, Cfg.cfg_PTY, ABflag); // block A of this pass
+if (Page_Group == 0) {SI4713::RDS_7A_X1X2(Group, Encoded.Type, Call, false);} // pager takes only one pass
+Page_Group++;
+Air_Groups++;
+Group_Flags = 0;
+
+if (Page_Group >= Groups) // end of pass
+   {
+     Group_Flags = TRACE_LAST;
+     Country = Next;
+     Passes++;
+     Next = NextCountry(Next);
+     Empty = false;
+     State = SWEEP_DRAIN;
+   }
+return true;
+}
+//=================================================================================
+
+uint8_t CountrySweep::NextCountry(uint8_t From)
+{
+for (uint8_t c = From + 1; c < 16; c++) {if (bitRead(Countries, c)) {return c;}}
+return 0;
+}
+//=================================================================================
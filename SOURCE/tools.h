@@ -1,49 +1,109 @@
-// http://www.leapsecond.com/tools/gdate.c
-// Convert year/month/day calendar date to Modified Julian Day (MJD).
-// - year is (4-digit calendar year), month is (1-12), day is (1-31)
-// - valid for Gregorian dates from 17-Nov-1858
-// - adapted (tvb) from sci.astro FAQ
-//
-static long ymd_to_mjd (int year, int month, int day)
-{
-    long Y = year, M = month, D = day;
-    long mjd =
-        367 * Y
-        - 7 * (Y + (M + 9) / 12) / 4
-        - 3 * ((Y + (M - 9) / 7) / 100 + 1) / 4
-        + 275 * M / 9
-        + D + 1721029 - 2400001;
-    return mjd;
-}
-// =================================================================================================
-
-// convert integer to HEX as string f.e. 0x15 -> "0F", with special length, f.e. Len = 4 "000F" 
-String Int2HEX (long Value, int Len) 
-// input integer data or adress, output Len symbols as hex
-{
-String Out = "";
-  Out = String(Value,HEX); 
-  Out.toUpperCase();
-
-  for (int i=0; Out.length() < Len; i++)
-  {
-    Out = "0"+ Out;
-  }
-  
-return Out;
-}
-// =============================================================================================
-
-// convert integer to String and add '0' in start up to len, f.e. 13,4 = "0013"
-String Int2STR (long Value, int Len) 
-{
-String Out = "";
-  Out = String(Value); 
-  
-  for (int i=0; Out.length() < Len; i++)
-  {
-    Out = "0"+ Out;
-  }
-  
-return Out;
-}
+// http://www.leapsecond.com/tools/gdate.c
+// Convert year/month/day calendar date to Modified Julian Day (MJD).
+// - year is (4-digit calendar year), month is (1-12), day is (1-31)
+// - valid for Gregorian dates from 17-Nov-1858
+// - adapted (tvb) from sci.astro FAQ
+//
+static long ymd_to_mjd (int year, int month, int day)
+{
+    long Y = year, M = month, D = day;
+    long mjd =
+        367 * Y
+        - 7 * (Y + (M + 9) / 12) / 4
+        - 3 * ((Y + (M - 9) / 7) / 100 + 1) / 4
+        + 275 * M / 9
+        + D + 1721029 - 2400001;
+    return mjd;
+}
+// =================================================================================================
+
+// Convert Modified Julian Day (MJD) to year/month/day calendar date, from the same gdate.c
+static void mjd_to_ymd (long mjd, int &year, int &month, int &day)
+{
+    long J, C, Y, M;
+
+    J = mjd + 2400001 + 68569;
+    C = 4 * J / 146097;
+    J = J - (146097 * C + 3) / 4;
+    Y = 4000 * (J + 1) / 1461001;
+    J = J - 1461 * Y / 4 + 31;
+    M = 80 * J / 2447;
+    day = J - 2447 * M / 80;
+    J = M / 11;
+    month = M + 2 - (12 * J);
+    year = 100 * (C - 49) + Y + J;
+}
+// =================================================================================================
+
+// convert integer to HEX and add '0' in start up to Len, f.e. 0x0F,4 = "000F"
+// Out must have Len+1 bytes; no heap, result is Out
+char *Int2HEX (char *Out, unsigned long Value, uint8_t Len) 
+{
+  Out[Len] = 0;
+  for (int8_t i = Len - 1; i >= 0; i--)
+  {
+    Out[i] = "0123456789ABCDEF"[Value & 0x0F];
+    Value >>= 4;
+  }
+return Out;
+}
+// =============================================================================================
+
+// convert integer to decimal and add '0' in start up to Len, f.e. 13,4 = "0013"
+// Out must have max(Len, 10)+1 bytes (all digits are kept); no heap, result is Out
+char *Int2STR (char *Out, unsigned long Value, uint8_t Len) 
+{
+char Tmp[10]; // digits in reverse order
+uint8_t n = 0;
+
+  do
+  {
+    Tmp[n++] = '0' + Value % 10;
+    Value /= 10;
+  } while (Value != 0);
+
+  uint8_t Pos = 0;
+  while (Pos + n < Len) {Out[Pos++] = '0';}
+  while (n > 0) {Out[Pos++] = Tmp[--n];}
+  Out[Pos] = 0;
+  
+return Out;
+}
+// =============================================================================================
+
+// CRC-16/CCITT (poly 0x1021, init 0xFFFF) of Len bytes
+uint16_t CRC16 (const void *Data, uint16_t Len)
+{
+const uint8_t *p = (const uint8_t *)Data;
+uint16_t CRC = 0xFFFF;
+
+  for (uint16_t i = 0; i < Len; i++)
+  {
+    CRC ^= (uint16_t)p[i] << 8;
+    for (uint8_t b = 0; b < 8; b++)
+    {
+      CRC = (CRC & 0x8000) ? (CRC << 1) ^ 0x1021 : (CRC << 1);
+    }
+  }
+
+return CRC;
+}
+// =============================================================================================
+
+// CRC-32 (IEEE, reflected poly 0xEDB88320) of Len bytes, message digest where CRC16 collides too easily
+uint32_t CRC32 (const void *Data, uint16_t Len)
+{
+const uint8_t *p = (const uint8_t *)Data;
+uint32_t CRC = 0xFFFFFFFFUL;
+
+  for (uint16_t i = 0; i < Len; i++)
+  {
+    CRC ^= p[i];
+    for (uint8_t b = 0; b < 8; b++)
+    {
+      CRC = (CRC & 1) ? (CRC >> 1) ^ 0xEDB88320UL : (CRC >> 1);
+    }
+  }
+
+return CRC ^ 0xFFFFFFFFUL;
+}
@@ -0,0 +1,100 @@
+/*  Monitor trace for RDS Encoder
+ *
+ *  With Monitor ON each group written to the chip is kept as binary record in RAM ring instead of printed line.
+ *  Records go to serial port only when Serial transmit buffer has place for whole frame (Drain() from loop()),
+ *  so monitor doesn't change timing of groups. With monitor ON the sequencer plans a slot only when the ring has place
+ *  for its largest burst (Reload() of urgent message: SEQ_PLAN + 1 records), so paging records are not dropped;
+ *  when ring is full anyway (test groups of menu) new records are dropped and counted.
+ *
+ *  Record is sent as frame of protocol.h: CMD = CMD_TRACE|0x80, STATUS = records dropped before this one (max 255),
+ *  DATA = Time u32 (millis), ID u8 (paging queue ID, 0 = not queued message), Flags u8, Blocks A B C D (u16 each).
+ *  With two transmitters in spread mode records of both chips are in one ring, TRACE_TX2 marks the second one.
+ *  HOST/tracedec prints records as monitor lines "Tx 7A: AAAA BBBB CCCC DDDD : ...".
+ */
+
+// -------------------------------------------------------- TYPE DEFINITIONS
+#define TRACE_LAST 0x01 // Flags: last group of message
+#define TRACE_TX2  0x02 // Flags: group of second transmitter (scheduler.h, TX_SPREAD)
+#define TRACE_RECORD_LEN 14 // bytes of record in frame
+
+typedef struct
+{
+  uint32_t Time;      // millis() when group was written
+  uint8_t ID;         // Paging queue ID of message
+  uint8_t Flags;      // TRACE_xxx
+  uint16_t Block[4];  // Blocks A, B, C, D
+} type_Trace;
+//=========================================== END TYPE DEFINITIONS =======================================
+
+class TraceRing
+{
+  public:
+    void Add(const uint16_t *Group, uint8_t ID, uint8_t Flags); // Keep record of group, drop it when ring is full
+    bool Drain();                  // Send records while Serial has place, never waits; true = records are left
+    void Flush();                  // Send all records, waits for Serial
+    uint8_t Count() {return Used;} // Records waiting
+    uint8_t Free() {return TRACE_SIZE - Used;} // Places for records
+    uint16_t Dropped = 0;          // Records dropped since start
+
+  private:
+    bool Send();                   // Send oldest record
+
+    type_Trace Ring[TRACE_SIZE];
+    uint8_t Head = 0;              // Oldest record
+    uint8_t Used = 0;
+    uint8_t Lost = 0;              // Dropped since last sent record
+};
+// =============================================== End Class ======================================
+
+TraceRing Trace; // monitor records
+
+void TraceRing::Add(const uint16_t *Group, uint8_t ID, uint8_t Flags)
+{
+if (Used >= TRACE_SIZE)
+   {
+     Dropped++;
+     if (Lost < 255) {Lost++;}
+     return;
+   }
+
+type_Trace &Record = Ring[(Head + Used) % TRACE_SIZE];
+Record.Time = millis();
+Record.ID = ID;
+Record.Flags = Flags;
+memcpy(Record.Block, Group, sizeof(Record.Block));
+Used++;
+}
+//=================================================================================
+
+bool TraceRing::Drain()
+{
+while ((Used > 0) && (Serial.availableForWrite() >= TRACE_RECORD_LEN + 6)) {Send();} // frame = record + 6 bytes
+return Used > 0;
+}
+//=================================================================================
+
+void TraceRing::Flush()
+{
+while (Used > 0) {Send();}
+}
+//=================================================================================
+
+bool TraceRing::Send()
+{
+if (Used == 0) {return false;}
+
+const type_Trace &Record = Ring[Head];
+uint8_t Data[TRACE_RECORD_LEN];
+
+Put32(Data, Record.Time);
+Data[4] = Record.ID;
+Data[5] = Record.Flags;
+for (uint8_t i = 0; i < 4; i++) {Put16(Data + 6 + i * 2, Record.Block[i]);}
+ControlPort::Reply(CMD_TRACE, Lost, Data, TRACE_RECORD_LEN);
+
+Lost = 0;
+Head = (Head + 1) % TRACE_SIZE;
+Used--;
+return true;
+}
+//=================================================================================